@@ -0,0 +1,137 @@
+// bench_fields.cpp
+// Разбор координат, времени и даты: QStringRef, общий путь NmeaField
+// (toDouble, mid, toInt) и декодеры фиксированного формата.
+// Запуск: bench_fields [число_полей]
+// По умолчанию — 1 000 000 наборов "широта, долгота, время, дата".
+#include "nmeafields.h"
+
+#include <QDate>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTime>
+#include <QVector>
+
+#include <cstdio>
+
+namespace {
+struct Sample {
+    QByteArray latitude;
+    QByteArray longitude;
+    QByteArray time;
+    QByteArray date;
+};
+
+QVector<Sample> makeSamples(int count)
+{
+    QVector<Sample> samples;
+    samples.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int second = i % 86400;
+        Sample sample;
+        sample.latitude = QByteArray::number(5624.91149 + (i % 100000) * 1e-5, 'f', 5);
+        sample.longitude = "0" + QByteArray::number(6153.42199 + (i % 70000) * 1e-5, 'f', 5);
+        sample.time = QTime(0, 0).addSecs(second).toString("hhmmss").toLatin1()
+                      + "." + QByteArray::number(i % 100).rightJustified(2, '0');
+        sample.date = QDate(2024, 1, 1).addDays(i % 366).toString("ddMMyy").toLatin1();
+        samples.append(sample);
+    }
+    return samples;
+}
+
+// Прежний путь: QStringRef, toDouble() и mid() с учетом локали
+double qtCoordinate(const QStringRef &ref)
+{
+    const double value = ref.toDouble();
+    const double degrees = static_cast<int>(value / 100);
+    return degrees + (value - degrees * 100) / 60.0;
+}
+
+double genericCoordinate(const NmeaField &field)
+{
+    const double value = field.toDouble();
+    const double degrees = static_cast<int>(value / 100);
+    return degrees + (value - degrees * 100) / 60.0;
+}
+
+template <typename Fn>
+void run(const char *name, int count, Fn &&fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const double checksum = fn();
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    std::printf("%-10s %8.1f ns/set  %10.0f sets/s  (checksum %.6f)\n",
+                name, seconds * 1e9 / count, count / seconds, checksum);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const int count = argc > 1 ? QString(argv[1]).toInt() : 1000000;
+    const QVector<Sample> samples = makeSamples(count);
+
+    QVector<QString> strings;
+    strings.reserve(count * 4);
+    for (const Sample &sample : samples) {
+        strings << QString::fromLatin1(sample.latitude) << QString::fromLatin1(sample.longitude)
+                << QString::fromLatin1(sample.time) << QString::fromLatin1(sample.date);
+    }
+
+    run("qstringref", count, [&]() {
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) {
+            const QString *s = strings.constData() + i * 4;
+            sum += qtCoordinate(QStringRef(&s[0])) + qtCoordinate(QStringRef(&s[1]));
+            const QStringRef time(&s[2]);
+            sum += QTime(time.mid(0, 2).toInt(), time.mid(2, 2).toInt(), time.mid(4, 2).toInt())
+                       .msecsSinceStartOfDay();
+            const QStringRef date(&s[3]);
+            sum += QDate(date.mid(4, 2).toInt() + 2000, date.mid(2, 2).toInt(), date.mid(0, 2).toInt()).day();
+        }
+        return sum;
+    });
+
+    run("generic", count, [&]() {
+        double sum = 0.0;
+        for (const Sample &sample : samples) {
+            sum += genericCoordinate({sample.latitude.constData(), sample.latitude.size()});
+            sum += genericCoordinate({sample.longitude.constData(), sample.longitude.size()});
+            const NmeaField time{sample.time.constData(), sample.time.size()};
+            sum += QTime(time.mid(0, 2).toInt(), time.mid(2, 2).toInt(), time.mid(4, 2).toInt())
+                       .msecsSinceStartOfDay();
+            const NmeaField date{sample.date.constData(), sample.date.size()};
+            sum += QDate(date.mid(4, 2).toInt() + 2000, date.mid(2, 2).toInt(), date.mid(0, 2).toInt()).day();
+        }
+        return sum;
+    });
+
+    run("fixed", count, [&]() {
+        double sum = 0.0;
+        for (const Sample &sample : samples) {
+            double latitude = 0.0;
+            double longitude = 0.0;
+            int32_t msecs = 0;
+            int day = 0, month = 0, year = 0;
+            NmeaField{sample.latitude.constData(), sample.latitude.size()}.toCoordinate('N', latitude);
+            NmeaField{sample.longitude.constData(), sample.longitude.size()}.toCoordinate('E', longitude);
+            NmeaField{sample.time.constData(), sample.time.size()}.toTimeMs(msecs);
+            NmeaField{sample.date.constData(), sample.date.size()}.toDate(day, month, year);
+            sum += latitude + longitude + msecs / 1000 * 1000 + QDate(year, month, day).day();
+        }
+        return sum;
+    });
+
+    run("fixed-e6", count, [&]() {
+        double sum = 0.0;
+        for (const Sample &sample : samples) {
+            int32_t latitude = 0;
+            int32_t longitude = 0;
+            NmeaField{sample.latitude.constData(), sample.latitude.size()}.toCoordinateE6('N', latitude);
+            NmeaField{sample.longitude.constData(), sample.longitude.size()}.toCoordinateE6('E', longitude);
+            sum += latitude + longitude;
+        }
+        return sum / 1e6;
+    });
+
+    return 0;
+}
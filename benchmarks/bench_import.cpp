@@ -0,0 +1,107 @@
+// bench_import.cpp
+// Скорость импорта лог-файла: разбор в пуле потоков и запись в БД.
+// Запуск: bench_import [размер_МБ] [каталог]
+// По умолчанию — 256 МБ синтетического лога (RMC, GGA, VTG) во временном каталоге.
+#include "databasemanager.h"
+#include "logimporter.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThreadPool>
+
+#include <cstdio>
+
+namespace {
+QByteArray withChecksum(const QByteArray &body)
+{
+    quint8 sum = 0;
+    for (char c : body) {
+        sum ^= static_cast<quint8>(c);
+    }
+    return "$" + body + "*" + QByteArray::number(sum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+bool writeLog(const QString &path, qint64 targetBytes)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QTime time(0, 0, 0);
+    qint64 written = 0;
+    for (int epoch = 0; written < targetBytes; ++epoch) {
+        // Эпоха каждые 100 мс, время в формате NMEA hhmmss.ss
+        const QByteArray hhmmss = time.addMSecs(epoch * 100).toString("hhmmss").toLatin1()
+                                  + "." + QByteArray::number((epoch % 10) * 10).rightJustified(2, '0');
+        const QByteArray lat = QByteArray::number(5624.91149 + (epoch % 1000) * 1e-5, 'f', 5);
+        const QByteArray lon = QByteArray::number(6153.42199 + (epoch % 700) * 1e-5, 'f', 5);
+
+        QByteArray block;
+        block += withChecksum("GNRMC," + hhmmss + ",A," + lat + ",N," + lon + ",E,0.120,,061224,,,A,V");
+        block += withChecksum("GNGGA," + hhmmss + "," + lat + ",N," + lon + ",E,1,12,0.78,271.4,M,-10.8,M,,");
+        block += withChecksum("GNVTG,,T,,M,0.120,N,0.222,K,A");
+        written += file.write(block);
+    }
+    return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const qint64 megabytes = argc > 1 ? QString(argv[1]).toLongLong() : 256;
+    const QString dir = argc > 2 ? QString(argv[2]) : QDir::tempPath();
+    const QString logPath = QDir(dir).filePath("cometa_bench_import.log");
+    const QString dbPath = QDir(dir).filePath("cometa_bench_import.db");
+
+    if (!writeLog(logPath, megabytes * 1024 * 1024)) {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(logPath));
+        return 1;
+    }
+    QFile::remove(dbPath);
+
+    double seconds = 0.0;
+    LogImporter::Stats stats;
+    {
+        DatabaseManager db(dbPath);
+        db.setStorageProfile(StorageProfile::FastIngest);
+        db.setBatchMode(true, 5000, 60000);
+        db.startBackgroundWriter(65536, DatabaseWriter::Block, QString());
+        db.insertNewFlight();
+
+        LogImporter importer(&db);
+        QElapsedTimer timer;
+        QObject::connect(&importer, &LogImporter::finished, &app, [&]() {
+            db.stopBackgroundWriter();
+            db.flushPendingData();
+            seconds = timer.nsecsElapsed() / 1e9;
+            stats = importer.stats();
+            app.quit();
+        });
+
+        timer.start();
+        if (!importer.start(logPath)) {
+            return 1;
+        }
+        app.exec();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+
+    std::printf("threads %d, %lld MB, %d lines in %.2f s: %.1f MB/s, %.0f lines/s, %d errors\n",
+                QThreadPool::globalInstance()->maxThreadCount(),
+                static_cast<long long>(stats.bytesTotal / (1024 * 1024)),
+                stats.lines, seconds,
+                stats.bytesTotal / (1024.0 * 1024.0) / seconds,
+                stats.lines / seconds, stats.errors);
+
+    QFile::remove(logPath);
+    QFile::remove(dbPath);
+    QFile::remove(dbPath + "-wal");
+    QFile::remove(dbPath + "-shm");
+    return 0;
+}
@@ -0,0 +1,235 @@
+// bench_parser.cpp
+// Пропускная способность ParserNMEA на синтетическом потоке (nmeacorpus.h):
+// предложения/с, байты/с и выделения памяти на предложение.
+// Запуск: bench_parser [предложений] [порча_%] [разрезы_%] [--seed N]
+//                      [--save файл] [--compare файл]
+// По умолчанию — 500 000 предложений смешанных типов, без порчи и разрезов.
+// --save записывает результаты, --compare сравнивает с записанными ранее:
+// так изменения парсера сравниваются с базовой линией.
+#include "nmeacorpus.h"
+#include "nmeaframer.h"
+#include "parsernmea.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QTextStream>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Счетчик выделений: глобальные operator new/delete этой программы
+namespace {
+std::atomic<quint64> g_allocations{0};
+}
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+struct Result {
+    QString name;
+    double sentencesPerSecond = 0.0;
+    double bytesPerSecond = 0.0;
+    double allocationsPerSentence = 0.0;
+    quint64 parsed = 0;
+    quint64 rejected = 0;
+};
+
+// Лучший из repeats прогонов: меньше влияние планировщика и прогрева кэшей
+template <typename Fn>
+Result run(const char *name, const NmeaCorpus &corpus, int repeats, Fn &&fn)
+{
+    ParserNMEA parser;
+    Result result;
+    result.name = QString::fromLatin1(name);
+
+    qint64 bestNs = 0;
+    quint64 allocations = 0;
+    for (int i = 0; i < repeats; ++i) {
+        parser.resetCounters();
+        const quint64 allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        QElapsedTimer timer;
+        timer.start();
+        fn(parser);
+        const qint64 ns = qMax<qint64>(timer.nsecsElapsed(), 1);
+        if (i == 0 || ns < bestNs) {
+            bestNs = ns;
+            allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+        }
+    }
+
+    const int sentences = corpus.lineCount();
+    result.sentencesPerSecond = sentences * 1e9 / bestNs;
+    result.bytesPerSecond = corpus.data.size() * 1e9 / bestNs;
+    result.allocationsPerSentence = static_cast<double>(allocations) / sentences;
+    result.parsed = parser.parsedCount();
+    result.rejected = parser.totalErrors();
+
+    std::printf("%-8s %8.1f ns/sentence  %10.0f sentences/s  %8.1f MB/s  %6.2f allocs/sentence"
+                "  (ok %llu, rejected %llu)\n",
+                name, bestNs / static_cast<double>(sentences), result.sentencesPerSecond,
+                result.bytesPerSecond / (1024 * 1024), result.allocationsPerSentence,
+                static_cast<unsigned long long>(result.parsed),
+                static_cast<unsigned long long>(result.rejected));
+    return result;
+}
+
+bool save(const QString &path, const QVector<Result> &results)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    for (const Result &result : results) {
+        out << result.name << ' ' << QString::number(result.sentencesPerSecond, 'f', 0)
+            << ' ' << QString::number(result.allocationsPerSentence, 'f', 3) << '\n';
+    }
+    return true;
+}
+
+void compare(const QString &path, const QVector<Result> &results)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", qPrintable(path));
+        return;
+    }
+
+    // Строка базовой линии: имя, предложения/с, выделения на предложение
+    QHash<QString, QPair<double, double>> baseline;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QStringList parts = in.readLine().split(' ', QString::SkipEmptyParts);
+        if (parts.size() == 3) {
+            baseline.insert(parts[0], qMakePair(parts[1].toDouble(), parts[2].toDouble()));
+        }
+    }
+
+    std::printf("\nagainst %s:\n", qPrintable(path));
+    for (const Result &result : results) {
+        const auto it = baseline.constFind(result.name);
+        if (it == baseline.constEnd() || it->first <= 0.0) {
+            std::printf("%-8s no baseline\n", qPrintable(result.name));
+            continue;
+        }
+        std::printf("%-8s %+7.1f%% sentences/s  %+6.2f allocs/sentence\n", qPrintable(result.name),
+                    (result.sentencesPerSecond / it->first - 1.0) * 100.0,
+                    result.allocationsPerSentence - it->second);
+    }
+}
+}
+
+int main(int argc, char *argv[])
+{
+    NmeaCorpusOptions options;
+    options.sentences = 500000;
+    QString savePath;
+    QString comparePath;
+
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--seed" && i + 1 < argc) {
+            options.seed = QString(argv[++i]).toUInt();
+        } else if (arg == "--save" && i + 1 < argc) {
+            savePath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--compare" && i + 1 < argc) {
+            comparePath = QString::fromLocal8Bit(argv[++i]);
+        } else if (positional == 0) {
+            options.sentences = qMax(1, arg.toInt());
+            ++positional;
+        } else if (positional == 1) {
+            options.corruptionRate = arg.toDouble() / 100.0;
+            ++positional;
+        } else {
+            options.splitRate = arg.toDouble() / 100.0;
+            ++positional;
+        }
+    }
+
+    const NmeaCorpus corpus = generateNmeaCorpus(options);
+    std::printf("corpus: %d sentences, %.1f MB, %d corrupted, %d reads, seed %u\n\n",
+                corpus.lineCount(), corpus.data.size() / (1024.0 * 1024.0), corpus.corrupted,
+                corpus.chunkOffsets.size(), options.seed);
+
+    const int repeats = 5;
+    QVector<Result> results;
+
+    // Строки уже разделены: parseData(const char *, int) без \r\n
+    results << run("bytes", corpus, repeats, [&](ParserNMEA &parser) {
+        const char *data = corpus.data.constData();
+        for (int i = 0; i < corpus.lineCount(); ++i) {
+            const int begin = corpus.lineOffsets[i];
+            parser.parseData(data + begin, corpus.lineOffsets[i + 1] - begin - 2);
+        }
+    });
+
+    // Прежний путь через QString, включая перекодировку строки
+    results << run("qstring", corpus, repeats, [&](ParserNMEA &parser) {
+        const char *data = corpus.data.constData();
+        for (int i = 0; i < corpus.lineCount(); ++i) {
+            const int begin = corpus.lineOffsets[i];
+            QString line = QString::fromLatin1(data + begin, corpus.lineOffsets[i + 1] - begin - 2);
+            parser.parseData(line);
+        }
+    });
+
+    // Поток кусками, как с порта: разметка NmeaFramer и parseFrame
+    results << run("framer", corpus, repeats, [&](ParserNMEA &parser) {
+        NmeaFramer framer;
+        auto handler = [&](const char *buffer, const NmeaFrame &frame) {
+            parser.parseFrame(buffer, frame);
+        };
+        int begin = 0;
+        for (int end : corpus.chunkOffsets) {
+            framer.feed(corpus.data.constData() + begin, end - begin, handler);
+            begin = end;
+        }
+        framer.flush(handler);
+    });
+
+    if (!savePath.isEmpty() && !save(savePath, results)) {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(savePath));
+        return 1;
+    }
+    if (!comparePath.isEmpty()) {
+        compare(comparePath, results);
+    }
+    return 0;
+}
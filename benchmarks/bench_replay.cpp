@@ -0,0 +1,125 @@
+// bench_replay.cpp
+// Нагрузка на живой конвейер приема без приемника: запись приема (.bin)
+// подается в IngestWorker источником воспроизведения в темпе записи,
+// умноженном на --speed (0 — максимальная скорость). --copies открывает
+// запись несколько раз сразу, как несколько приемников. Записи уходят
+// фоновому писателю БД во временном каталоге.
+// Печатает по источникам пропускную способность и задержку от чтения до
+// передачи записи потребителям, по писателю — глубину очереди.
+// Запуск: bench_replay запись.bin [--speed N] [--copies K] [каталог]
+#include "databasemanager.h"
+#include "ingestworker.h"
+#include "storageprofile.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <cstdio>
+
+namespace {
+void removeDatabaseFiles(const QString &path)
+{
+    QFile::remove(path);
+    QFile::remove(path + "-wal");
+    QFile::remove(path + "-shm");
+    QFile::remove(path + "-journal");
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser options;
+    options.setApplicationDescription("Replay a receive capture through the live ingest pipeline.");
+    options.addHelpOption();
+    options.addPositionalArgument("capture", "Receive capture (.bin)");
+    options.addPositionalArgument("dir", "Directory for the scratch database", "[dir]");
+    QCommandLineOption speedOption("speed", "Replay speed: 1 = as recorded, 0 = as fast as possible", "N", "1");
+    QCommandLineOption copiesOption("copies", "Replay the capture as K sources at once", "K", "1");
+    options.addOption(speedOption);
+    options.addOption(copiesOption);
+    options.process(app);
+
+    const QStringList args = options.positionalArguments();
+    if (args.isEmpty()) {
+        options.showHelp(1);
+    }
+    const QString capture = args.at(0);
+    const QString dir = args.size() > 1 ? args.at(1) : QDir::tempPath();
+    const double speed = options.value(speedOption).toDouble();
+    const int copies = qMax(1, options.value(copiesOption).toInt());
+
+    const QString path = QDir(dir).filePath("cometa_bench_replay.db");
+    const QString spillPath = QDir(dir).filePath("cometa_bench_replay.spill");
+    removeDatabaseFiles(path);
+
+    int exitCode = 0;
+    {
+        DatabaseManager db(path);
+        db.setStorageProfile(StorageProfile::FastIngest);
+        db.insertNewFlight();
+        db.startBackgroundWriter(8192, DatabaseWriter::Block, spillPath);
+
+        IngestWorker ingest;
+        ingest.setStorage(&db, nullptr);
+
+        int finished = 0;
+        QObject::connect(&ingest, &IngestWorker::replayFinished, &app, [&]() {
+            if (++finished == copies) {
+                app.quit();
+            }
+        });
+        QObject::connect(&ingest, &IngestWorker::errorOccurred, &app, [](const QString &error) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < copies; ++i) {
+            QString error;
+            if (ingest.openReplay(capture, speed, &error) == 0) {
+                std::fprintf(stderr, "%s\n", qPrintable(error));
+                exitCode = 1;
+                break;
+            }
+        }
+        if (exitCode == 0) {
+            app.exec();
+        }
+        const double seconds = timer.nsecsElapsed() / 1e9;
+
+        ingest.closeAll();
+        const DatabaseWriter::Stats writer = db.writerStats();
+        db.stopBackgroundWriter();
+
+        std::printf("%-20s %10s %12s %10s %14s %12s %12s\n",
+                    "source", "MB", "sentences", "invalid", "sentences/s", "avg lat, us", "max lat, us");
+        for (const IngestWorker::SourceStats &stats : ingest.sourceStats()) {
+            std::printf("%-20s %10.2f %12llu %10llu %14.0f %12.1f %12.1f\n",
+                        qPrintable(QString("[%1] %2").arg(stats.id).arg(stats.name)),
+                        stats.bytes / (1024.0 * 1024.0),
+                        static_cast<unsigned long long>(stats.sentences),
+                        static_cast<unsigned long long>(stats.invalid),
+                        stats.sentences / seconds,
+                        stats.avgLatencyUs,
+                        stats.maxLatencyUs);
+        }
+        std::printf("%.2f s, writer: %llu queued, %llu dropped, max queue depth %d, ingest dropped %llu\n",
+                    seconds,
+                    static_cast<unsigned long long>(writer.enqueued),
+                    static_cast<unsigned long long>(writer.dropped),
+                    writer.maxQueueDepth,
+                    static_cast<unsigned long long>(ingest.droppedRecords()));
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+    removeDatabaseFiles(path);
+    QFile::remove(spillPath);
+
+    return exitCode;
+}
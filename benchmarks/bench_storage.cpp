@@ -0,0 +1,127 @@
+// bench_storage.cpp
+// Пропускная способность вставки и чтения для каждого профиля хранения.
+// Запуск: bench_storage [число_записей] [каталог]
+// По умолчанию — 1 000 000 записей (RMC и GGA поровну) во временном каталоге.
+#include "databasemanager.h"
+#include "storageprofile.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlQuery>
+
+#include <cstdio>
+
+namespace {
+NavigationData makeRecord(int index, const QDateTime &start)
+{
+    NavigationData data{};
+    data.result = OK;
+    data.timestamp = start.addMSecs(index * 50LL);
+
+    const QTime time = data.timestamp.time();
+    const double latitude = 56.4 + (index % 10000) * 1e-6;
+    const double longitude = 61.9 + (index % 7000) * 1e-6;
+
+    if (index % 2 == 0) {
+        GNRMCData rmc{};
+        rmc.time = time;
+        rmc.date = data.timestamp.date();
+        rmc.isValid = true;
+        rmc.latitude = latitude;
+        rmc.longitude = longitude;
+        rmc.speed = 120.0;
+        rmc.course = 45.0;
+        data.type = MsgType::GNRMC;
+        data.payload = rmc;
+    } else {
+        GNGGAData gga{};
+        gga.time = time;
+        gga.latitude = latitude;
+        gga.longitude = longitude;
+        gga.satellitesCount = 14;
+        gga.altitude = 350.0f;
+        data.type = MsgType::GNGGA;
+        data.payload = gga;
+    }
+    return data;
+}
+
+void removeDatabaseFiles(const QString &path)
+{
+    QFile::remove(path);
+    QFile::remove(path + "-wal");
+    QFile::remove(path + "-shm");
+    QFile::remove(path + "-journal");
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int rows = argc > 1 ? QString(argv[1]).toInt() : 1000000;
+    const QString dir = argc > 2 ? QString(argv[2]) : QDir::tempPath();
+    const QDateTime start(QDate(2024, 12, 6), QTime(5, 27, 14), Qt::UTC);
+
+    std::printf("%-16s %12s %14s %12s %14s\n",
+                "profile", "insert, s", "insert rows/s", "query, s", "query rows/s");
+
+    for (StorageProfile profile : {StorageProfile::Safe,
+                                   StorageProfile::FastIngest,
+                                   StorageProfile::ReadOptimized}) {
+        const QString path = QDir(dir).filePath(
+            QString("cometa_bench_%1.db").arg(storageProfileName(profile)));
+        removeDatabaseFiles(path);
+
+        double insertSeconds = 0.0;
+        double querySeconds = 0.0;
+        int fetched = 0;
+        {
+            DatabaseManager db(path);
+            db.setStorageProfile(profile);
+            db.setBatchMode(true, 5000, 60000);
+            db.insertNewFlight();
+            const QString flight = db.getLastFlight();
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < rows; ++i) {
+                db.saveNavigationData(makeRecord(i, start));
+            }
+            db.flushPendingData();
+            insertSeconds = timer.nsecsElapsed() / 1e9;
+
+            // Типичная выборка отчета: весь трек полета с высотой
+            timer.restart();
+            QSqlQuery query;
+            query.setForwardOnly(true);
+            query.prepare("SELECT r.latitude, r.longitude, r.speed, g.altitude "
+                          "FROM navigation_data n "
+                          "JOIN gnrmc_data r ON r.navigation_data_id = n.id "
+                          "LEFT JOIN gngga_data g ON g.navigation_data_id = n.id "
+                          "WHERE n.flight_id = (SELECT id FROM flights WHERE flight_name = ?) "
+                          "ORDER BY n.timestamp");
+            query.addBindValue(flight);
+            if (query.exec()) {
+                while (query.next()) {
+                    ++fetched;
+                }
+            }
+            querySeconds = timer.nsecsElapsed() / 1e9;
+
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+
+        std::printf("%-16s %12.2f %14.0f %12.2f %14.0f\n",
+                    storageProfileName(profile),
+                    insertSeconds, rows / insertSeconds,
+                    querySeconds, fetched / querySeconds);
+
+        removeDatabaseFiles(path);
+    }
+
+    return 0;
+}
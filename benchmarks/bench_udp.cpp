@@ -0,0 +1,199 @@
+// bench_udp.cpp
+// Прием UDP на петлевом интерфейсе: одно предложение NMEA на датаграмму,
+// как у приемников с высокой частотой выдачи. Отправитель в отдельном
+// потоке шлет поток nmeacorpus.h на 127.0.0.1, получатель разбирает его
+// NmeaFramer двумя способами:
+//   qbytearray — прежний путь EthernetClient: QByteArray на датаграмму;
+//   batch      — DatagramBatch: recvmmsg в заранее выделенные слоты.
+// Запуск: bench_udp [датаграмм] [--seed N]
+// Потери показывают, успевает ли получатель за отправителем.
+#include "datagrambatch.h"
+#include "nmeacorpus.h"
+#include "nmeaframer.h"
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QString>
+#include <QUdpSocket>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// Счетчик выделений: глобальные operator new/delete этой программы
+namespace {
+std::atomic<quint64> g_allocations{0};
+}
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+struct Counters {
+    quint64 datagrams = 0;
+    quint64 frames = 0;
+    quint64 wakeups = 0;
+};
+
+// Отправитель без Qt: sendto на каждую строку корпуса
+void sendCorpus(const NmeaCorpus &corpus, quint16 port)
+{
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    target.sin_port = htons(port);
+
+    const char *data = corpus.data.constData();
+    for (int i = 0; i < corpus.lineCount(); ++i) {
+        const int begin = corpus.lineOffsets[i];
+        ::sendto(fd, data + begin, static_cast<size_t>(corpus.lineOffsets[i + 1] - begin), 0,
+                 reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+    }
+    ::close(fd);
+}
+
+template <typename Receive>
+void run(const char *name, const NmeaCorpus &corpus, Receive &&receive)
+{
+    QUdpSocket socket;
+    if (!socket.bind(QHostAddress::LocalHost, 0)) {
+        std::fprintf(stderr, "%s: bind failed: %s\n", name, qPrintable(socket.errorString()));
+        return;
+    }
+    socket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 8 * 1024 * 1024);
+
+    NmeaFramer framer;
+    Counters counters;
+    auto handler = [&](const char *, const NmeaFrame &) {
+        ++counters.frames;
+    };
+
+    std::atomic<bool> sent{false};
+    std::thread sender([&]() {
+        sendCorpus(corpus, socket.localPort());
+        sent.store(true, std::memory_order_release);
+    });
+
+    QElapsedTimer timer;
+    quint64 allocationsBefore = 0;
+    for (;;) {
+        // Отправитель закончил, и очередь сокета пуста
+        if (!socket.waitForReadyRead(200)) {
+            if (sent.load(std::memory_order_acquire)) {
+                break;
+            }
+            continue;
+        }
+        if (!timer.isValid()) {
+            timer.start();
+            allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        }
+        ++counters.wakeups;
+        receive(socket, framer, handler, counters);
+    }
+    const qint64 ns = qMax<qint64>(timer.isValid() ? timer.nsecsElapsed() : 1, 1);
+    const quint64 allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+    sender.join();
+
+    const double lost = 100.0 * (corpus.lineCount() - static_cast<double>(counters.datagrams)) / corpus.lineCount();
+    std::printf("%-10s %10.0f datagrams/s  %6.2f allocs/datagram  %6.1f datagrams/wakeup"
+                "  (received %llu, frames %llu, lost %.2f%%)\n",
+                name, counters.datagrams * 1e9 / ns,
+                counters.datagrams ? static_cast<double>(allocations) / counters.datagrams : 0.0,
+                counters.wakeups ? static_cast<double>(counters.datagrams) / counters.wakeups : 0.0,
+                static_cast<unsigned long long>(counters.datagrams),
+                static_cast<unsigned long long>(counters.frames), lost);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    NmeaCorpusOptions options;
+    options.sentences = 200000;
+
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--seed" && i + 1 < argc) {
+            options.seed = QString(argv[++i]).toUInt();
+        } else {
+            options.sentences = qMax(1, arg.toInt());
+        }
+    }
+
+    const NmeaCorpus corpus = generateNmeaCorpus(options);
+    std::printf("corpus: %d datagrams, %.1f MB, seed %u\n\n", corpus.lineCount(),
+                corpus.data.size() / (1024.0 * 1024.0), options.seed);
+
+    // Прежний путь: размер, QByteArray под каждую датаграмму, адрес отправителя
+    run("qbytearray", corpus, [](QUdpSocket &socket, NmeaFramer &framer, auto &handler, Counters &counters) {
+        while (socket.hasPendingDatagrams()) {
+            QByteArray datagram;
+            datagram.resize(int(socket.pendingDatagramSize()));
+            QHostAddress sender;
+            quint16 senderPort;
+            socket.readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+            ++counters.datagrams;
+            framer.feed(datagram.constData(), datagram.size(), handler);
+            framer.flush(handler);
+        }
+    });
+
+    if (!DatagramBatch::batchReceiveSupported()) {
+        std::printf("batch      recvmmsg is not available on this platform\n");
+        return 0;
+    }
+
+    // Пакетный путь: recvmmsg до опустошения очереди, слоты переиспользуются
+    DatagramBatch batch;
+    run("batch", corpus, [&batch](QUdpSocket &socket, NmeaFramer &framer, auto &handler, Counters &counters) {
+        int received;
+        do {
+            received = batch.receiveFrom(socket.socketDescriptor());
+            for (int i = 0; i < batch.size(); ++i) {
+                framer.feed(batch.data(i), batch.length(i), handler);
+                framer.flush(handler);
+            }
+            counters.datagrams += quint64(qMax(received, 0));
+        } while (received == batch.capacity());
+    });
+    return 0;
+}
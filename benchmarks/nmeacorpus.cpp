@@ -0,0 +1,168 @@
+// nmeacorpus.cpp
+#include "nmeacorpus.h"
+
+#include <cstdio>
+
+namespace {
+// xorshift32: детерминирован и не зависит от стандартной библиотеки
+class Random
+{
+public:
+    explicit Random(quint32 seed) : m_state(seed ? seed : 0x9E3779B9u) {}
+
+    quint32 next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+    int below(int bound) { return static_cast<int>(next() % static_cast<quint32>(bound)); }
+    bool chance(double rate) { return rate > 0.0 && (next() >> 8) < rate * (1u << 24); }
+
+private:
+    quint32 m_state;
+};
+
+struct Epoch {
+    char time[16];
+    char date[8];
+    char latitude[16];
+    char longitude[16];
+};
+
+void appendSentence(QByteArray &out, const char *body)
+{
+    quint8 sum = 0;
+    for (const char *p = body; *p; ++p) {
+        sum ^= static_cast<quint8>(*p);
+    }
+    char tail[8];
+    std::snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    out += '$';
+    out += body;
+    out += tail;
+}
+
+const char *const TALKERS[] = {"GN", "GP", "GL", "GA"};
+
+void appendGsv(QByteArray &out, const char *talker, int firstPrn, int satellites, Random &random)
+{
+    const int parts = (satellites + 3) / 4;
+    for (int part = 1; part <= parts; ++part) {
+        char body[128];
+        int length = std::snprintf(body, sizeof(body), "%sGSV,%d,%d,%02d", talker, parts, part, satellites);
+        for (int i = (part - 1) * 4; i < satellites && i < part * 4; ++i) {
+            length += std::snprintf(body + length, sizeof(body) - static_cast<size_t>(length),
+                                    ",%02d,%02d,%03d,%02d", firstPrn + i, 5 + random.below(85),
+                                    random.below(360), random.below(50));
+        }
+        appendSentence(out, body);
+    }
+}
+
+// Одна эпоха: RMC и GGA всегда, остальное — в зависимости от смеси
+void appendEpoch(QByteArray &out, const Epoch &e, bool mixed, Random &random)
+{
+    char body[128];
+    const char *talker = mixed ? TALKERS[random.below(2)] : "GN";
+
+    std::snprintf(body, sizeof(body), "%sRMC,%s,A,%s,N,%s,E,0.%03d,,%s,,,A,V",
+                  talker, e.time, e.latitude, e.longitude, random.below(1000), e.date);
+    appendSentence(out, body);
+    std::snprintf(body, sizeof(body), "%sGGA,%s,%s,N,%s,E,1,%02d,0.%02d,%d.%d,M,-10.8,M,,",
+                  talker, e.time, e.latitude, e.longitude, 6 + random.below(20),
+                  50 + random.below(50), 200 + random.below(100), random.below(10));
+    appendSentence(out, body);
+    appendSentence(out, "GNVTG,,T,,M,0.120,N,0.222,K,A");
+    if (!mixed) {
+        return;
+    }
+
+    appendSentence(out, "GNGSA,A,3,02,05,07,13,,,,,,,,,1.20,0.78,0.91,1");
+    appendGsv(out, "GP", 2, 5 + random.below(8), random);
+    appendGsv(out, "GL", 65, 3 + random.below(6), random);
+    std::snprintf(body, sizeof(body), "GNGST,%s,1.%d,0.8,0.5,45.0,0.6,0.7,1.1", e.time, random.below(10));
+    appendSentence(out, body);
+    std::snprintf(body, sizeof(body), "%sGLL,%s,N,%s,E,%s,A,A", TALKERS[random.below(4)],
+                  e.latitude, e.longitude, e.time);
+    appendSentence(out, body);
+    std::snprintf(body, sizeof(body), "GNZDA,%s,%.2s,%.2s,20%.2s,00,00", e.time, e.date, e.date + 2, e.date + 4);
+    appendSentence(out, body);
+    if (random.below(10) == 0) {
+        appendSentence(out, "GPTXT,01,01,02,ANTSTATUS=OK");
+    }
+}
+
+void corrupt(QByteArray &out, int begin, Random &random)
+{
+    // Последние два байта — \r\n
+    const int end = out.size() - 2;
+    const int star = out.lastIndexOf('*');
+    switch (random.below(4)) {
+    case 0: // Контрольная сумма
+        out[star + 1] = out[star + 1] == '0' ? '1' : '0';
+        break;
+    case 1: // Обрезанная строка: конец потерян вместе с '*'
+        out.remove(begin + (end - begin) / 2, end - begin - (end - begin) / 2);
+        break;
+    case 2: // Мусорный байт внутри полей
+        out[begin + 7 + random.below(star - begin - 7)] = static_cast<char>(0x80 | random.below(0x80));
+        break;
+    default: // Пропала '*'
+        out[star] = ',';
+        break;
+    }
+}
+}
+
+NmeaCorpus generateNmeaCorpus(const NmeaCorpusOptions &options)
+{
+    NmeaCorpus corpus;
+    Random random(options.seed);
+    corpus.data.reserve(options.sentences * 60);
+    corpus.lineOffsets.reserve(options.sentences + 1);
+
+    QByteArray block;
+    for (int epoch = 0; corpus.lineOffsets.size() < options.sentences; ++epoch) {
+        // Эпоха каждые 100 мс
+        const int tenths = epoch % 864000;
+        const int seconds = tenths / 10;
+        Epoch e;
+        std::snprintf(e.time, sizeof(e.time), "%02d%02d%02d.%d0",
+                      seconds / 3600, seconds / 60 % 60, seconds % 60, tenths % 10);
+        std::snprintf(e.date, sizeof(e.date), "%02d1224", 1 + epoch / 864000 % 28);
+        std::snprintf(e.latitude, sizeof(e.latitude), "56%02d.%05d", 10 + epoch / 100000 % 40, epoch % 100000);
+        std::snprintf(e.longitude, sizeof(e.longitude), "061%02d.%05d", 10 + epoch / 70000 % 40, epoch % 70000);
+
+        block.clear();
+        appendEpoch(block, e, options.mixed, random);
+
+        // Переносим блок по строкам, по пути портим часть из них
+        for (int pos = 0; pos < block.size() && corpus.lineOffsets.size() < options.sentences;) {
+            const int lineEnd = block.indexOf('\n', pos) + 1;
+            const int begin = corpus.data.size();
+            corpus.lineOffsets.append(begin);
+            corpus.data.append(block.constData() + pos, lineEnd - pos);
+            if (random.chance(options.corruptionRate)) {
+                corrupt(corpus.data, begin, random);
+                ++corpus.corrupted;
+            }
+            pos = lineEnd;
+        }
+    }
+    corpus.lineOffsets.append(corpus.data.size());
+
+    // Границы чтений: обычно по концу строки, с долей splitRate — внутри строки
+    for (int line = 1; line < corpus.lineOffsets.size(); ++line) {
+        const int begin = corpus.lineOffsets[line - 1];
+        const int end = corpus.lineOffsets[line];
+        if (random.chance(options.splitRate) && end - begin > 2) {
+            corpus.chunkOffsets.append(begin + 1 + random.below(end - begin - 2));
+        }
+        if (random.below(4) == 0 || line + 1 == corpus.lineOffsets.size()) {
+            corpus.chunkOffsets.append(end);
+        }
+    }
+    return corpus;
+}
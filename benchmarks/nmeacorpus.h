@@ -0,0 +1,35 @@
+// nmeacorpus.h
+#ifndef NMEACORPUS_H
+#define NMEACORPUS_H
+
+#include <QByteArray>
+#include <QVector>
+
+// Синтетический поток NMEA для бенчмарков. Один и тот же seed дает
+// один и тот же поток на любой платформе: генератор случайных чисел свой,
+// распределения стандартной библиотеки не используются.
+struct NmeaCorpusOptions {
+    quint32 seed = 1;
+    int sentences = 100000;
+    // Смесь RMC, GGA, GSA, GSV, VTG, ZDA, GST, GLL и TXT от GN/GP/GL/GA.
+    // false — только RMC, GGA и VTG, как в bench_import
+    bool mixed = true;
+    // Доля испорченных предложений: контрольная сумма, обрезка,
+    // мусорный байт, пропавшая '*'
+    double corruptionRate = 0.0;
+    // Доля границ чтения, разрезающих предложение (куски для NmeaFramer)
+    double splitRate = 0.0;
+};
+
+struct NmeaCorpus {
+    QByteArray data;            // Поток целиком, строки через \r\n
+    QVector<int> lineOffsets;   // Начало каждой строки, последний элемент — data.size()
+    QVector<int> chunkOffsets;  // Границы чтений, последний элемент — data.size()
+    int corrupted = 0;
+
+    int lineCount() const { return lineOffsets.size() - 1; }
+};
+
+NmeaCorpus generateNmeaCorpus(const NmeaCorpusOptions &options);
+
+#endif // NMEACORPUS_H
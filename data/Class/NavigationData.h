@@ -3,8 +3,12 @@
 
 #include <QTime>
 #include <QDate>
+#include <QDateTime>
 #include <QDataStream>
 #include <QMultiMap>
+#include <QVariantMap>
+
+#include <variant>
 
 enum ParseResult {
     ERROR = 0,
@@ -32,8 +36,6 @@ struct GNRMCData {
     CoordinateDefinition coordinateDefinition;
     bool statusNav; //Способ вычисления координат
     ParseResult result; //результат парсинга
-
-    friend QDataStream& operator>>(QDataStream& in, GNRMCData& data);
 };
 
 // Структура для данных GNGGA
@@ -66,8 +68,6 @@ struct GNGGAData {
     uint32_t countSecDGPS; //Количество секунд прошедших с получения последней DGPS поправки (SC104).
     int idDGPS; //ID базовой станции предоставляющей DGPS поправки (если включено DGPS).
     ParseResult result;
-
-    friend QDataStream& operator>>(QDataStream& in, GNGGAData& data);
 };
 
 enum TypeFormat {
@@ -91,8 +91,6 @@ struct GNGSAData {
     uint32_t VDOP; // Вертикальный геометрический фактор ухудшения точности *10
     TypeGNSS typeGNSS; //Номер навигационной системы
     ParseResult result; //Результат парсинга
-
-    friend QDataStream& operator>>(QDataStream& in, GNGSAData& data);
 };
 // Структура для данных GNZDA
 struct GNZDAData {
@@ -101,8 +99,6 @@ struct GNZDAData {
     uint32_t localOffset; // Локальный сдвиг
     ParseResult result; //Результат парсинга
 
-    friend QDataStream &operator>>(QDataStream &in, GNZDAData &data);
-
 };
 // Структура для данных GNDHV
 struct GNDHVData {
@@ -114,8 +110,6 @@ struct GNDHVData {
     double speed; // Общая скорость в м/с
     ParseResult result; // Результат парсинга
 
-    friend QDataStream &operator>>(QDataStream &in, GNDHVData &data);
-
 };
 // Структура для данных GNGST
 struct GNGSTData {
@@ -129,8 +123,6 @@ struct GNGSTData {
     double altitudeError; // Ошибка высоты в метрах
     ParseResult result; // Результат парсинга
 
-    friend QDataStream &operator>>(QDataStream &in, GNGSTData &data);
-
 };
 // Структура для данных GPTXT
 struct GPTXTData {
@@ -139,8 +131,6 @@ struct GPTXTData {
     int messageType; // Идентификатор типа сообщения
     QString message; // Текстовое сообщение
     ParseResult result; // Результат парсинга
-
-    friend QDataStream &operator>>(QDataStream &in, GPTXTData &data);
 };
 // Структура для данных GNGLL
 struct GNGLLData {
@@ -150,8 +140,6 @@ struct GNGLLData {
     bool isValid; // Достоверность полученных координат
     ParseResult result; // Результат парсинга
 
-    friend QDataStream &operator>>(QDataStream &in, GNGLLData &data);
-
 };
 // Структура для данных спутника
 struct SatelliteInfo {
@@ -159,19 +147,18 @@ struct SatelliteInfo {
     double elevation; // Угол возвышения
     double azimuth; // Азимут
     double snr; // Соотношение сигнал/шум
-
-    friend QDataStream& operator>>(QDataStream& in, SatelliteInfo& data);
 };
 
 // Структура для данных GLGSV
 struct GLGSVData {
+    static constexpr int MaxSatellitesPerMessage = 4; // По стандарту в одном GSV не более 4 спутников
+
     int totalMessages; // Общее количество сообщений
     int messageNumber; // Номер сообщения
     int satellitesCount; // Количество наблюдаемых спутников
-    QVector<SatelliteInfo> satelliteData; // ID спутника, угол возвышения, азимут, уровень сигнала
+    SatelliteInfo satelliteData[MaxSatellitesPerMessage]; // ID спутника, угол возвышения, азимут, уровень сигнала
+    int satelliteDataCount = 0; // Количество заполненных элементов satelliteData
     ParseResult result; // Результат парсинга
-
-    friend QDataStream& operator>>(QDataStream& in, GLGSVData& data);
 };
 // Структура для данных GNVTG
 struct GNVTGData {
@@ -181,8 +168,6 @@ struct GNVTGData {
     double speedKmh; // Скорость в км/ч
     bool isValid; // Достоверность данных
     ParseResult result; // Результат парсинга
-
-    friend QDataStream &operator>>(QDataStream &in, GNVTGData &data);
 };
 enum MsgType{
     GNRMC=0,
@@ -197,54 +182,126 @@ enum MsgType{
     GNVTG
 };
 
+// Имя типа сообщения для логов и интерфейса ("GNRMC", "GNGGA", ...)
+const char *msgTypeName(MsgType type);
+
+// Источник сообщения — первые две буквы адреса ($GPRMC, $GLGSV, ...).
+// MsgType описывает только тип предложения и не зависит от источника
+enum class Talker : quint8 {
+    Unknown = 0,
+    GP, // GPS
+    GL, // ГЛОНАСС
+    GA, // Galileo
+    GB, // BeiDou (также BD)
+    GN  // Совмещенное решение по нескольким системам
+};
+
+constexpr quint16 packTalker(char first, char second) {
+    return static_cast<quint16>((static_cast<quint8>(first) << 8) | static_cast<quint8>(second));
+}
+
+constexpr Talker talkerFromId(char first, char second) {
+    switch (packTalker(first, second)) {
+    case packTalker('G', 'P'): return Talker::GP;
+    case packTalker('G', 'L'): return Talker::GL;
+    case packTalker('G', 'A'): return Talker::GA;
+    case packTalker('G', 'B'):
+    case packTalker('B', 'D'): return Talker::GB;
+    case packTalker('G', 'N'): return Talker::GN;
+    default:                   return Talker::Unknown;
+    }
+}
+
+const char *talkerName(Talker talker);
+
+// Разобранное сообщение хранится как есть, без сериализации.
+// Индекс альтернативы соответствует MsgType + 1 (0 — нет данных).
+using NavigationPayload = std::variant<std::monostate,
+                                       GNRMCData,
+                                       GNGGAData,
+                                       GNGSAData,
+                                       GNZDAData,
+                                       GNDHVData,
+                                       GNGSTData,
+                                       GPTXTData,
+                                       GNGLLData,
+                                       GLGSVData,
+                                       GNVTGData>;
+
 // Основная структура для навигационных данных
 struct NavigationData {
     int id; //индифакационный номер
     QDateTime timestamp; //время парсинга
     ParseResult result; //результат парсинга
     MsgType type; // тип
+    Talker talker = Talker::Unknown; // источник (GP, GL, GA, GB, GN)
+    quint16 sourceId = 0; // приемник (IngestWorker), 0 — единственный поток или импорт
     int size; // размер строки
-    QByteArray data; // обобщенные данные
+    NavigationPayload payload; // данные разобранного сообщения
+
+    template <typename T>
+    const T *as() const { return std::get_if<T>(&payload); }
+};
 
-    struct DeserializedData {
-        GNRMCData gnrmc;
-        GNGGAData gngga;
-        GNZDAData gnzda;
-        QDateTime timestamp; //время парсинга
-        int id;
+// Навигационное решение одной эпохи: RMC, GGA, ZDA, VTG и GST с одинаковым
+// временем UTC, собранные EpochAssembler в одну запись (таблица navigation_fix)
+struct NavigationFix {
+    // Какие сообщения дали данные эпохе
+    enum Source {
+        FromRMC = 0x01,
+        FromGGA = 0x02,
+        FromZDA = 0x04,
+        FromVTG = 0x08,
+        FromGST = 0x10
     };
 
-    DeserializedData deserialize() const {
-        DeserializedData result;
-        QDataStream stream(data);
+    int id = 0;
+    QDateTime timestamp; // время приема первого сообщения эпохи
+    QDate date; // дата UTC
+    QTime time; // время UTC эпохи
+    bool isValid = false;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    float altitude = 0.0f;
+    double speed = 0.0;
+    double course = 0.0;
+    int satellitesCount = 0;
+    double hdop = 0.0;
+    double rms = 0.0; // СКО по GST, м
+    double latitudeError = 0.0;
+    double longitudeError = 0.0;
+    double altitudeError = 0.0;
+    int sources = 0; // набор флагов Source
 
-        stream >> result.id
-            >> result.timestamp
-            >> result.gnzda.date
-            >> result.gnzda.time
-            >> result.gnrmc.isValid
-            >> result.gngga.altitude
-            >> result.gnrmc.latitude
-            >> result.gnrmc.longitude
-            >> result.gnrmc.speed
-            >> result.gnrmc.course;
+    QDateTime utcDateTime() const { return QDateTime(date, time, Qt::UTC); }
+};
 
-        return result;
-    }
+// Спутник в обзоре неба эпохи. Поля целые: этой точности хватает для
+// анализа видимости и SNR, а запись занимает 8 байт и в памяти, и в BLOB
+struct SkySatellite {
+    quint16 prn = 0;
+    quint16 azimuth = 0;      // Азимут, градусы 0..359
+    quint8 elevation = 0;     // Угол возвышения, градусы 0..90
+    quint8 snr = 0;           // Сигнал/шум, дБГц; 0 — спутник не отслеживается
+    Talker talker = Talker::Unknown;
+    quint8 reserved = 0;
 };
 
-// Структура для данных карты
-struct NavigationDataMap {
-    int id;
-    QDateTime timestamp; //время парсинга
-    QDate date;
-    QTime time;
-    bool isValid;
-    double latitude;
-    double longitude;
-    float altitude;
-    double speed;
-    double course;
+// Видимые спутники всех систем за одну эпоху — объединение многочастных
+// GSV от всех источников (таблица sky_view). Емкость фиксирована, куча не
+// используется
+struct SkyView {
+    static constexpr int MaxSatellites = 128;
+    static constexpr int RecordSize = 8; // Байтов на спутник в BLOB
+
+    int fixId = 0; // Эпоха в navigation_fix
+    int count = 0;
+    SkySatellite satellites[MaxSatellites];
+
+    // Спутники подряд по RecordSize байтов, little-endian
+    QByteArray toBlob() const;
+    // false — длина BLOB не кратна записи или спутников больше MaxSatellites
+    bool fromBlob(const QByteArray &blob);
 };
 
 struct NavigationDataTable {
@@ -253,22 +310,4 @@ struct NavigationDataTable {
     QVariantMap customData ; // Для хранения произвольных данных из разных таблиц
 };
 
-// Объявления операторов ввода
-QDataStream &operator>>(QDataStream &in, GNRMCData::CoordinateDefinition &coordDef);
-QDataStream &operator>>(QDataStream &in, GNRMCData &data);
-QDataStream &operator>>(QDataStream &in, GNGGAData::AltitudeUnits &altUnit);
-QDataStream &operator>>(QDataStream &in, ParseResult &result);
-QDataStream &operator>>(QDataStream &in, GNGGAData &data);
-QDataStream &operator>>(QDataStream &in, TypeGNSS &gnss);
-QDataStream &operator>>(QDataStream &in, TypeFormat &format);
-QDataStream &operator>>(QDataStream &in, GNGSAData &data);
-QDataStream &operator>>(QDataStream &in, GNZDAData &data);
-QDataStream &operator>>(QDataStream &in, GNDHVData &data);
-QDataStream &operator>>(QDataStream &in, GNGSTData &data);
-QDataStream &operator>>(QDataStream &in, GPTXTData &data);
-QDataStream &operator>>(QDataStream &in, GNGLLData &data);
-QDataStream &operator>>(QDataStream &in, SatelliteInfo &data);
-QDataStream &operator>>(QDataStream &in, GLGSVData &data);
-QDataStream &operator>>(QDataStream &in, GNVTGData &data);
-
 #endif // NAVIGATIONDATA_H
@@ -0,0 +1,101 @@
+// captureformat.cpp
+#include "captureformat.h"
+
+#include <cstring>
+
+namespace {
+const char CAPTURE_MAGIC[6] = {'C', 'M', 'T', 'C', 'A', 'P'};
+
+int putVarint(char *out, uint64_t value)
+{
+    int size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<char>(value);
+    return size;
+}
+
+// 0 — значение не уместилось в size, -1 — длиннее maxBytes
+int getVarint(const char *data, int size, int maxBytes, uint64_t &value)
+{
+    value = 0;
+    for (int i = 0; i < maxBytes; ++i) {
+        if (i >= size) {
+            return 0;
+        }
+        const uint8_t byte = static_cast<uint8_t>(data[i]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+}
+
+void writeCaptureFileHeader(char *out, int64_t startMsecsSinceEpoch)
+{
+    std::memcpy(out, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    out[6] = static_cast<char>(CaptureFormatVersion);
+    out[7] = 0;
+    const uint64_t start = static_cast<uint64_t>(startMsecsSinceEpoch);
+    for (int i = 0; i < 8; ++i) {
+        out[8 + i] = static_cast<char>((start >> (8 * i)) & 0xFF);
+    }
+}
+
+bool readCaptureFileHeader(const char *data, int size, int64_t *startMsecsSinceEpoch)
+{
+    if (size < CaptureFileHeaderSize || std::memcmp(data, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0
+        || static_cast<uint8_t>(data[6]) != CaptureFormatVersion) {
+        return false;
+    }
+    if (startMsecsSinceEpoch) {
+        uint64_t start = 0;
+        for (int i = 0; i < 8; ++i) {
+            start |= static_cast<uint64_t>(static_cast<uint8_t>(data[8 + i])) << (8 * i);
+        }
+        *startMsecsSinceEpoch = static_cast<int64_t>(start);
+    }
+    return true;
+}
+
+int encodeCaptureChunkHeader(char *out, const CaptureChunkHeader &header)
+{
+    int size = putVarint(out, header.deltaUs);
+    size += putVarint(out + size, (static_cast<uint64_t>(header.sourceId) << 1) | (header.endOfMessage ? 1 : 0));
+    size += putVarint(out + size, header.length);
+    return size;
+}
+
+int decodeCaptureChunkHeader(const char *data, int size, CaptureChunkHeader &header)
+{
+    uint64_t delta = 0;
+    uint64_t source = 0;
+    uint64_t length = 0;
+
+    const int deltaSize = getVarint(data, size, 10, delta);
+    if (deltaSize <= 0) {
+        return deltaSize;
+    }
+    const int sourceSize = getVarint(data + deltaSize, size - deltaSize, 3, source);
+    if (sourceSize <= 0) {
+        return sourceSize;
+    }
+    const int used = deltaSize + sourceSize;
+    const int lengthSize = getVarint(data + used, size - used, 5, length);
+    if (lengthSize <= 0) {
+        return lengthSize;
+    }
+    if ((source >> 1) > 0xFFFF || length > CaptureChunkMaxLength) {
+        return -1;
+    }
+
+    header.deltaUs = delta;
+    header.sourceId = static_cast<uint16_t>(source >> 1);
+    header.endOfMessage = (source & 1) != 0;
+    header.length = static_cast<uint32_t>(length);
+    return used + lengthSize;
+}
@@ -0,0 +1,40 @@
+// captureformat.h
+#ifndef CAPTUREFORMAT_H
+#define CAPTUREFORMAT_H
+
+#include <cstdint>
+
+// Запись приема с метками времени (.bin).
+// Заголовок файла, CaptureFileHeaderSize байт: сигнатура "CMTCAP", версия,
+// резервный байт, время начала записи в мс от эпохи Unix (int64, little-endian).
+// Дальше порции — то, что принято одним чтением порта или одной датаграммой:
+//   приращение времени приема в мкс от предыдущей порции  (LEB128)
+//   (id источника << 1) | признак конца датаграммы         (LEB128)
+//   длина                                                  (LEB128)
+//   байты порции
+// Для потока NMEA заголовок порции занимает 3–6 байт.
+// Файл без сигнатуры — прежняя запись без меток, сплошной поток байтов.
+
+constexpr int CaptureFileHeaderSize = 16;
+constexpr uint8_t CaptureFormatVersion = 1;
+constexpr int CaptureChunkHeaderMaxSize = 10 + 3 + 5;
+// Больше не бывает ни датаграмм, ни чтений порта — признак порчи файла
+constexpr uint32_t CaptureChunkMaxLength = 16 * 1024 * 1024;
+
+struct CaptureChunkHeader {
+    uint64_t deltaUs = 0;
+    uint16_t sourceId = 0;
+    bool endOfMessage = false; // Порция — целая датаграмма
+    uint32_t length = 0;
+};
+
+void writeCaptureFileHeader(char *out, int64_t startMsecsSinceEpoch);
+// false — у файла нет заголовка записи с метками (или он другой версии)
+bool readCaptureFileHeader(const char *data, int size, int64_t *startMsecsSinceEpoch = nullptr);
+
+// Возвращает размер заголовка, не больше CaptureChunkHeaderMaxSize
+int encodeCaptureChunkHeader(char *out, const CaptureChunkHeader &header);
+// Возвращает размер заголовка; 0 — заголовок не уместился в size; -1 — файл испорчен
+int decodeCaptureChunkHeader(const char *data, int size, CaptureChunkHeader &header);
+
+#endif // CAPTUREFORMAT_H
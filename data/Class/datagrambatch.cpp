@@ -0,0 +1,97 @@
+// datagrambatch.cpp
+#include "datagrambatch.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__linux__)
+struct DatagramBatch::SystemHeaders {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+};
+#else
+struct DatagramBatch::SystemHeaders {
+};
+#endif
+
+DatagramBatch::DatagramBatch(int slots, int slotSize)
+    : m_slotSize(std::max(1, slotSize)),
+    m_buffer(static_cast<size_t>(std::max(1, slots)) * m_slotSize),
+    m_lengths(std::max(1, slots), 0),
+    m_truncated(std::max(1, slots), 0),
+    m_headers(new SystemHeaders)
+{
+#if defined(__linux__)
+    // Заголовки recvmmsg указывают на слоты и заполняются один раз
+    const int count = capacity();
+    m_headers->messages.resize(count);
+    m_headers->vectors.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_headers->vectors[i].iov_base = slot(i);
+        m_headers->vectors[i].iov_len = static_cast<size_t>(m_slotSize);
+        mmsghdr &message = m_headers->messages[i];
+        message = mmsghdr();
+        message.msg_hdr.msg_iov = &m_headers->vectors[i];
+        message.msg_hdr.msg_iovlen = 1;
+    }
+#endif
+}
+
+DatagramBatch::~DatagramBatch() = default;
+
+void DatagramBatch::setLength(int index, int length, bool truncated)
+{
+    m_lengths[index] = length;
+    m_truncated[index] = truncated ? 1 : 0;
+}
+
+bool DatagramBatch::batchReceiveSupported()
+{
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+int DatagramBatch::receiveFrom(intptr_t socketDescriptor, int firstSlot)
+{
+    m_count = std::min(std::max(0, firstSlot), capacity());
+#if defined(__linux__)
+    const int available = capacity() - m_count;
+    if (available == 0) {
+        return 0;
+    }
+
+    mmsghdr *messages = m_headers->messages.data() + m_count;
+    for (int i = 0; i < available; ++i) {
+        // Ядро перезаписывает флаги и длину; адрес отправителя не нужен
+        messages[i].msg_hdr.msg_flags = 0;
+        messages[i].msg_len = 0;
+    }
+
+    int received;
+    do {
+        received = recvmmsg(static_cast<int>(socketDescriptor), messages,
+                            static_cast<unsigned int>(available), MSG_DONTWAIT, nullptr);
+    } while (received < 0 && errno == EINTR);
+
+    if (received < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    for (int i = 0; i < received; ++i) {
+        setLength(m_count + i, static_cast<int>(messages[i].msg_len),
+                  (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0);
+    }
+    m_count += received;
+    return received;
+#else
+    (void)socketDescriptor;
+    return -1;
+#endif
+}
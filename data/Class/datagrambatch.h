@@ -0,0 +1,60 @@
+// datagrambatch.h
+#ifndef DATAGRAMBATCH_H
+#define DATAGRAMBATCH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Пакет датаграмм в заранее выделенных слотах фиксированного размера.
+// Слоты переиспользуются от пакета к пакету, поэтому прием не выделяет
+// память на датаграмму. На Linux receiveFrom() забирает до capacity()
+// датаграмм одним вызовом recvmmsg; на других системах слоты заполняет
+// вызывающий через slot()/setLength().
+class DatagramBatch
+{
+public:
+    // 64 датаграммы за вызов; слот больше MTU Ethernet с запасом
+    static constexpr int DefaultSlots = 64;
+    static constexpr int DefaultSlotSize = 4096;
+
+    explicit DatagramBatch(int slots = DefaultSlots, int slotSize = DefaultSlotSize);
+    ~DatagramBatch();
+
+    DatagramBatch(const DatagramBatch &) = delete;
+    DatagramBatch &operator=(const DatagramBatch &) = delete;
+
+    int capacity() const { return static_cast<int>(m_lengths.size()); }
+    int slotSize() const { return m_slotSize; }
+
+    // Датаграммы текущего пакета; данные действительны до следующего приема
+    int size() const { return m_count; }
+    const char *data(int index) const { return m_buffer.data() + static_cast<size_t>(index) * m_slotSize; }
+    int length(int index) const { return m_lengths[index]; }
+    // Датаграмма длиннее слота, хвост потерян
+    bool truncated(int index) const { return m_truncated[index] != 0; }
+
+    // Заполнение без recvmmsg
+    char *slot(int index) { return m_buffer.data() + static_cast<size_t>(index) * m_slotSize; }
+    void setLength(int index, int length, bool truncated = false);
+    void setSize(int count) { m_count = count; }
+    void clear() { m_count = 0; }
+
+    // Один неблокирующий recvmmsg в слоты начиная с firstSlot; первые
+    // firstSlot датаграмм пакета сохраняются. Возвращает число принятых
+    // датаграмм (0 — очередь сокета пуста) или -1 при ошибке или без поддержки
+    int receiveFrom(intptr_t socketDescriptor, int firstSlot = 0);
+    static bool batchReceiveSupported();
+
+private:
+    struct SystemHeaders; // mmsghdr/iovec, только на Linux
+
+    int m_slotSize;
+    int m_count = 0;
+    std::vector<char> m_buffer;
+    std::vector<int> m_lengths;
+    std::vector<unsigned char> m_truncated;
+    std::unique_ptr<SystemHeaders> m_headers;
+};
+
+#endif // DATAGRAMBATCH_H
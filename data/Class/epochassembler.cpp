@@ -0,0 +1,136 @@
+// epochassembler.cpp
+#include "epochassembler.h"
+
+namespace {
+// Время UTC сообщения или невалидное время, если его в сообщении нет
+QTime epochTime(const NavigationData &data)
+{
+    switch (data.type) {
+    case MsgType::GNRMC: return std::get<GNRMCData>(data.payload).time;
+    case MsgType::GNGGA: return std::get<GNGGAData>(data.payload).time;
+    case MsgType::GNZDA: return std::get<GNZDAData>(data.payload).time;
+    case MsgType::GNGST: return std::get<GNGSTData>(data.payload).time;
+    default:             return QTime();
+    }
+}
+}
+
+bool EpochAssembler::add(const NavigationData &data, NavigationFix &completed)
+{
+    if (data.result != OK) {
+        return false;
+    }
+
+    const QTime time = epochTime(data);
+    bool closed = false;
+
+    if (time.isValid() && (!m_open || time != m_current.time)) {
+        if (m_open) {
+            finish(completed);
+            closed = true;
+        }
+        m_current = NavigationFix();
+        m_current.time = time;
+        m_current.timestamp = data.timestamp;
+        m_open = true;
+    }
+
+    if (m_open) {
+        merge(data);
+    }
+    return closed;
+}
+
+bool EpochAssembler::flush(NavigationFix &completed)
+{
+    if (!m_open) {
+        return false;
+    }
+    finish(completed);
+    return true;
+}
+
+void EpochAssembler::reset()
+{
+    m_current = NavigationFix();
+    m_open = false;
+    m_lastDate = QDate();
+    m_sky.reset();
+    m_completedSky.count = 0;
+}
+
+void EpochAssembler::finish(NavigationFix &completed)
+{
+    if (m_current.date.isValid()) {
+        m_lastDate = m_current.date;
+    } else {
+        m_current.date = m_lastDate;
+    }
+    completed = m_current;
+    m_sky.take(m_completedSky);
+    m_open = false;
+}
+
+void EpochAssembler::merge(const NavigationData &data)
+{
+    switch (data.type) {
+    case MsgType::GNRMC: {
+        const GNRMCData &rmc = std::get<GNRMCData>(data.payload);
+        // RMC — основной источник координат, скорости и достоверности
+        m_current.isValid = rmc.isValid;
+        m_current.latitude = rmc.latitude;
+        m_current.longitude = rmc.longitude;
+        m_current.speed = rmc.speed;
+        m_current.course = rmc.course;
+        if (rmc.date.isValid()) {
+            m_current.date = rmc.date;
+        }
+        m_current.sources |= NavigationFix::FromRMC;
+        break;
+    }
+    case MsgType::GNGGA: {
+        const GNGGAData &gga = std::get<GNGGAData>(data.payload);
+        m_current.altitude = gga.altitude;
+        m_current.satellitesCount = gga.satellitesCount;
+        m_current.hdop = gga.HDOP / 10.0;
+        if (!(m_current.sources & NavigationFix::FromRMC)) {
+            m_current.latitude = gga.latitude;
+            m_current.longitude = gga.longitude;
+            m_current.isValid = gga.coordDef != GNGGAData::COORDINATE_UNDEFINE;
+        }
+        m_current.sources |= NavigationFix::FromGGA;
+        break;
+    }
+    case MsgType::GNZDA: {
+        const GNZDAData &zda = std::get<GNZDAData>(data.payload);
+        if (zda.date.isValid()) {
+            m_current.date = zda.date;
+        }
+        m_current.sources |= NavigationFix::FromZDA;
+        break;
+    }
+    case MsgType::GNVTG: {
+        const GNVTGData &vtg = std::get<GNVTGData>(data.payload);
+        if (!(m_current.sources & NavigationFix::FromRMC)) {
+            m_current.speed = vtg.speedKnots;
+            m_current.course = vtg.trueCourse;
+        }
+        m_current.sources |= NavigationFix::FromVTG;
+        break;
+    }
+    case MsgType::GNGST: {
+        const GNGSTData &gst = std::get<GNGSTData>(data.payload);
+        m_current.rms = gst.rms;
+        m_current.latitudeError = gst.latitudeError;
+        m_current.longitudeError = gst.longitudeError;
+        m_current.altitudeError = gst.altitudeError;
+        m_current.sources |= NavigationFix::FromGST;
+        break;
+    }
+    case MsgType::GLGSV:
+        m_sky.add(data);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,39 @@
+// epochassembler.h
+#ifndef EPOCHASSEMBLER_H
+#define EPOCHASSEMBLER_H
+
+#include "NavigationData.h"
+#include "skyviewassembler.h"
+
+// Сборка сообщений одной навигационной эпохи в NavigationFix.
+// Эпоха определяется временем UTC из RMC/GGA/ZDA/GST: сообщение с новым
+// временем закрывает текущую эпоху. Сообщения без времени (VTG) относятся
+// к открытой эпохе. Части GSV собираются в обзор неба эпохи.
+class EpochAssembler {
+public:
+    // Добавляет сообщение. Возвращает true, если оно закрыло предыдущую
+    // эпоху — тогда готовая запись лежит в completed
+    bool add(const NavigationData &data, NavigationFix &completed);
+
+    // Закрывает текущую эпоху (конец файла, смена полета)
+    bool flush(NavigationFix &completed);
+
+    void reset();
+    bool hasPending() const { return m_open; }
+
+    // Обзор неба эпохи, закрытой последним add()/flush(), вернувшим true
+    const SkyView &completedSkyView() const { return m_completedSky; }
+    const SkyViewAssembler::Stats &skyStats() const { return m_sky.stats(); }
+
+private:
+    void finish(NavigationFix &completed);
+    void merge(const NavigationData &data);
+
+    NavigationFix m_current;
+    bool m_open = false;
+    QDate m_lastDate; // Дата последней эпохи — для эпох без RMC и ZDA
+    SkyViewAssembler m_sky;
+    SkyView m_completedSky;
+};
+
+#endif // EPOCHASSEMBLER_H
@@ -1,68 +1,80 @@
 #include "ethernetclient.h"
 #include <QDebug>
-#include <QCoreApplication>
 
 EthernetClient::EthernetClient(const QString &host, quint16 port, QObject *parent)
-    : QObject(parent), socket(new UdpSocket(this)), host(host), port(port) {
-
-    // Привязка сокета к конкретному хосту и порту
-    QHostAddress address = QHostAddress::Any;
-    if (!socket->bind(address, port)) {
-        qDebug() << "Ошибка привязки сокета:" << socket->errorString();
-        emit errorOccurred("Не удалось привязать сокет к адресу " + host + " и порту " + QString::number(port) + ": " + socket->errorString());
-    } else {
-        qDebug() << "Сокет успешно привязан к адресу" << host << "и порту" << port;
-    }
+    : QObject(parent), socket(new UdpSocket(this)), host(host), port(port), m_address(host) {
 
     connect(socket, &UdpSocket::readyRead, this, &EthernetClient::onReadyRead);
-
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    connect(socket, &QAbstractSocket::errorOccurred, this, &EthernetClient::handleError);
+#else
+    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+            this, &EthernetClient::handleError);
+#endif
+
+    // Повтор CONNECT, пока устройство не ответило
     retryTimer = new QTimer(this);
     connect(retryTimer, &QTimer::timeout, this, &EthernetClient::retryConnection);
+
+    // Проверка тишины и отправка PING, пока связь есть
+    keepaliveTimer = new QTimer(this);
+    connect(keepaliveTimer, &QTimer::timeout, this, &EthernetClient::onKeepalive);
+
+    m_clock.start();
+}
+
+void EthernetClient::setTimeouts(int handshakeTimeoutMs, int keepaliveIntervalMs,
+                                 int degradedAfterMs, int lostAfterMs) {
+    m_handshakeTimeoutMs = qMax(10, handshakeTimeoutMs);
+    m_keepaliveIntervalMs = qMax(10, keepaliveIntervalMs);
+    m_degradedAfterMs = qMax(m_keepaliveIntervalMs, degradedAfterMs);
+    m_lostAfterMs = qMax(m_degradedAfterMs, lostAfterMs);
+}
+
+QString EthernetClient::stateName(State state) {
+    switch (state) {
+    case Disconnected: return "disconnected";
+    case Connecting:   return "connecting";
+    case Connected:    return "connected";
+    case Degraded:     return "degraded";
+    case Lost:         return "lost";
+    }
+    return "unknown";
 }
 
 bool EthernetClient::connectToServer() {
-    // Отправляем команду подключения к устройству
-    QByteArray connectCommand = "CONNECT";
-    QHostAddress address(host);
-    socket->writeDatagram(connectCommand, address, port);
-
-    // Ожидаем ответа от устройства
-    QTimer timer;
-    timer.setSingleShot(true);
-    timer.start(1000); // 1 секунда ожидания
-
-    while (timer.isActive()) {
-        if (socket->hasPendingDatagrams()) {
-            QByteArray response;
-            response.resize(int(socket->pendingDatagramSize()));
-            QHostAddress sender;
-            quint16 senderPort;
-
-            socket->readDatagram(response.data(), response.size(), &sender, &senderPort);
-            if (response == "CONNECTED") {
-                return true; // Устройство подключено
-            }
-        }
-        QCoreApplication::processEvents(); // Обрабатываем события, чтобы не блокировать интерфейс
+    // Привязка сокета к порту приема
+    if (socket->state() != QAbstractSocket::BoundState && !socket->bind(QHostAddress::Any, port)) {
+        emit errorOccurred("Не удалось привязать сокет к адресу " + host + " и порту " + QString::number(port) + ": " + socket->errorString());
+        return false;
     }
 
-    return false; // Устройство не подключено
+    // Ответ на CONNECT придет в onReadyRead; без ответа команда повторяется
+    m_lastSeenMs = m_clock.elapsed();
+    setState(Connecting);
+    sendControl("CONNECT");
+    retryTimer->start(m_handshakeTimeoutMs);
+    return true;
 }
 
 void EthernetClient::disconnectFromServer() {
+    retryTimer->stop();
+    keepaliveTimer->stop();
+    m_requestSentNs = -1;
+
     if (socket->isOpen()) {
         socket->close(); // Закрываем сокет
         qDebug() << "Соединение с сервером закрыто.";
     } else {
         qDebug() << "Сервер уже отключен.";
     }
+    setState(Disconnected);
 }
 
 void EthernetClient::sendData(const QByteArray &data) {
-    if (pingDevice()) {
-        QHostAddress address(host);
-        socket->writeDatagram(data, address, port);
-        qDebug() << "Data sent:" << data;
+    // Доступность устройства известна по keepalive, перед отправкой не проверяется
+    if (m_state == Connected || m_state == Degraded) {
+        socket->writeDatagram(data, m_address, port);
     } else {
         emit errorOccurred("Устройство недоступно.");
     }
@@ -70,55 +82,138 @@ void EthernetClient::sendData(const QByteArray &data) {
 
 void EthernetClient::onReadyRead() {
     while (socket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(int(socket->pendingDatagramSize()));
-        QHostAddress sender;
-        quint16 senderPort;
-
-        socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
-        emit dataReceived(datagram);
-        qDebug() << "Data received:" << datagram; // Отладочное сообщение
+        // Первая датаграмма читается через QUdpSocket — это снова включает
+        // уведомления сокета; остальные забираются пакетом в те же слоты
+        m_batch.clear();
+        const qint64 first = socket->readDatagram(m_batch.slot(0), m_batch.slotSize());
+        if (first < 0) {
+            break;
+        }
+        m_batch.setLength(0, int(first), first >= m_batch.slotSize());
+        m_batch.setSize(1);
+
+        bool drained;
+#ifdef Q_OS_LINUX
+        const int received = m_batch.receiveFrom(socket->socketDescriptor(), 1);
+        drained = received >= 0 && m_batch.size() < m_batch.capacity();
+#else
+        while (m_batch.size() < m_batch.capacity() && socket->hasPendingDatagrams()) {
+            const int index = m_batch.size();
+            const qint64 size = socket->readDatagram(m_batch.slot(index), m_batch.slotSize());
+            if (size < 0) {
+                break;
+            }
+            m_batch.setLength(index, int(size), size >= m_batch.slotSize());
+            m_batch.setSize(index + 1);
+        }
+        drained = m_batch.size() < m_batch.capacity();
+#endif
+        dispatchBatch();
+        if (drained) {
+            break;
+        }
     }
 }
 
+void EthernetClient::dispatchBatch() {
+    m_lastSeenMs = m_clock.elapsed();
+    ++m_receiveStats.batches;
+    m_receiveStats.datagrams += quint64(m_batch.size());
+
+    bool hasData = false;
+    for (int i = 0; i < m_batch.size(); ++i) {
+        if (m_batch.truncated(i)) {
+            ++m_receiveStats.truncated;
+        }
+        const QByteArray datagram = QByteArray::fromRawData(m_batch.data(i), m_batch.length(i));
+        if (handleControl(datagram)) {
+            m_batch.setLength(i, 0);
+        } else {
+            hasData = true;
+        }
+    }
+    if (!hasData) {
+        return;
+    }
+
+    // Данные пришли — устройство на связи, даже если keepalive потерялся
+    if (m_state == Degraded || m_state == Lost) {
+        retryTimer->stop();
+        keepaliveTimer->start(m_keepaliveIntervalMs);
+        setState(Connected);
+    }
+    emit datagramsReceived(m_batch);
+}
+
+bool EthernetClient::handleControl(const QByteArray &datagram) {
+    if (datagram == "CONNECTED") {
+        measureRoundTrip();
+        retryTimer->stop();
+        keepaliveTimer->start(m_keepaliveIntervalMs);
+        setState(Connected);
+        return true;
+    }
+    if (datagram == "PING") {
+        measureRoundTrip();
+        if (m_state == Degraded) {
+            setState(Connected);
+        }
+        return true;
+    }
+    return false;
+}
+
 void EthernetClient::handleError(QAbstractSocket::SocketError socketError) {
+    Q_UNUSED(socketError);
     emit errorOccurred("Socket error: " + socket->errorString());
     qDebug() << "Socket error:" << socket->errorString();
 }
 
 void EthernetClient::retryConnection() {
-    if (!connectToServer()) {
-        qDebug() << "Retrying connection...";
+    if (m_state == Connecting) {
+        emit errorOccurred(QString("Устройство не ответило на CONNECT за %1 мс").arg(m_handshakeTimeoutMs));
+        setState(Lost);
     }
+    qDebug() << "Retrying connection...";
+    sendControl("CONNECT");
 }
 
-bool EthernetClient::pingDevice() {
-    QByteArray pingData = "PING"; // Специальный пакет для пинга
-    QHostAddress address(host);
-
-    // Отправляем пинг
-    socket->writeDatagram(pingData, address, port);
-
-    // Устанавливаем таймер ожидания
-    QTimer timer;
-    timer.setSingleShot(true);
-    timer.start(1000); // 1 секунда ожидания
-
-    // Ожидаем ответа
-    while (timer.isActive()) {
-        if (socket->hasPendingDatagrams()) {
-            QByteArray response;
-            response.resize(int(socket->pendingDatagramSize()));
-            QHostAddress sender;
-            quint16 senderPort;
-
-            socket->readDatagram(response.data(), response.size(), &sender, &senderPort);
-            if (response == pingData) {
-                return true; // Устройство доступно
-            }
-        }
-        QCoreApplication::processEvents(); // Обрабатываем события, чтобы не блокировать интерфейс
+void EthernetClient::onKeepalive() {
+    const qint64 silenceMs = m_clock.elapsed() - m_lastSeenMs;
+
+    if (silenceMs > m_lostAfterMs) {
+        // Связь потеряна: keepalive прекращается, начинается переподключение
+        keepaliveTimer->stop();
+        setState(Lost);
+        sendControl("CONNECT");
+        retryTimer->start(m_handshakeTimeoutMs);
+        return;
     }
+    if (silenceMs > m_degradedAfterMs && m_state == Connected) {
+        setState(Degraded);
+    }
+    sendControl("PING");
+}
 
-    return false; // Устройство недоступно
+void EthernetClient::setState(State state) {
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    emit stateChanged(state);
+}
+
+void EthernetClient::sendControl(const QByteArray &command) {
+    // Задержка считается от последнего запроса: ответ на потерянный не придет
+    m_requestSentNs = m_clock.nsecsElapsed();
+    socket->writeDatagram(command, m_address, port);
+}
+
+void EthernetClient::measureRoundTrip() {
+    if (m_requestSentNs < 0) {
+        return;
+    }
+    m_lastRoundTripUs = (m_clock.nsecsElapsed() - m_requestSentNs) / 1000;
+    m_requestSentNs = -1;
+    emit roundTripMeasured(m_lastRoundTripUs);
 }
@@ -1,37 +1,102 @@
 #ifndef ETHERNETCLIENT_H
 #define ETHERNETCLIENT_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QUdpSocket>
 #include <QTimer>
 
+#include "datagrambatch.h"
 #include "udpsocket.h"
 
+// Связь с устройством по UDP без ожидания в цикле событий.
+// connectToServer() отправляет CONNECT и сразу возвращается; состояние
+// меняется по приходу датаграмм и по таймерам:
+//   Connecting -> Connected    ответ CONNECTED;
+//   Connected  -> Degraded     тишина дольше degradedAfterMs;
+//   Degraded   -> Lost         тишина дольше lostAfterMs, начинается переподключение;
+//   Degraded   -> Connected    любая датаграмма от устройства.
+// Пока связь есть, раз в keepaliveIntervalMs отправляется PING; эхо и ответ
+// на CONNECT дают время круговой задержки.
+// Датаграммы принимаются пакетами в слоты DatagramBatch (на Linux — через
+// recvmmsg) и отдаются одним сигналом на пакет.
 class EthernetClient : public QObject {
     Q_OBJECT
 
 public:
+    enum State {
+        Disconnected,
+        Connecting,
+        Connected,
+        Degraded,
+        Lost
+    };
+    Q_ENUM(State)
+
+    struct ReceiveStats {
+        quint64 datagrams = 0;
+        quint64 batches = 0;
+        quint64 truncated = 0; // Длиннее слота пакета
+    };
+
     explicit EthernetClient(const QString &host, quint16 port, QObject *parent = nullptr);
+
+    void setTimeouts(int handshakeTimeoutMs, int keepaliveIntervalMs,
+                     int degradedAfterMs, int lostAfterMs);
+
+    // false, если не удалось привязать сокет; иначе ждите stateChanged
     bool connectToServer();
     void disconnectFromServer();
     void sendData(const QByteArray &data);
 
+    State state() const { return m_state; }
+    // Последняя круговая задержка CONNECT/PING, мкс; -1 — еще не измерена
+    qint64 lastRoundTripUs() const { return m_lastRoundTripUs; }
+    const ReceiveStats &receiveStats() const { return m_receiveStats; }
+
+    static QString stateName(State state);
+
 signals:
-    void dataReceived(const QByteArray &data);
+    // Пакет действителен только на время вызова: подключаться только
+    // напрямую, из потока клиента. Служебные датаграммы имеют длину 0
+    void datagramsReceived(const DatagramBatch &batch);
     void errorOccurred(const QString &error);
+    void stateChanged(EthernetClient::State state);
+    void roundTripMeasured(qint64 microseconds);
 
 private slots:
     void onReadyRead();
     void handleError(QAbstractSocket::SocketError socketError);
     void retryConnection();
+    void onKeepalive();
 
 private:
     UdpSocket *socket;
     QString host;
     quint16 port;
     QTimer *retryTimer;
+    QTimer *keepaliveTimer;
+
+    void setState(State state);
+    void sendControl(const QByteArray &command);
+    // true — датаграмма служебная и в поток данных не попадает
+    bool handleControl(const QByteArray &datagram);
+    void dispatchBatch();
+    void measureRoundTrip();
+
+    State m_state = Disconnected;
+    QHostAddress m_address;
+    QElapsedTimer m_clock;
+    qint64 m_lastSeenMs = 0;
+    qint64 m_requestSentNs = -1; // Время отправки CONNECT/PING без ответа
+    qint64 m_lastRoundTripUs = -1;
+    DatagramBatch m_batch;
+    ReceiveStats m_receiveStats;
 
-    bool pingDevice();
+    int m_handshakeTimeoutMs = 1000;
+    int m_keepaliveIntervalMs = 1000;
+    int m_degradedAfterMs = 3000;
+    int m_lostAfterMs = 10000;
 };
 
 #endif // ETHERNETCLIENT_H
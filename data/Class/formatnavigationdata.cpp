@@ -3,14 +3,6 @@
 NavigationDataFormatter::NavigationDataFormatter(QObject *parent)
     : QObject(parent)
 {
-    // Инициализация кэша форматирования
-    m_typeNames = {
-        {MsgType::GNRMC, "GNRMC"}, {MsgType::GNGGA, "GNGGA"},
-        {MsgType::GNGSA, "GNGSA"},     {MsgType::GNZDA, "GNZDA"},
-        {MsgType::GNDHV, "GNDHV"}, {MsgType::GNGST, "GNGST"},
-        {MsgType::GPTXT, "GPTXT"}, {MsgType::GNGLL, "GNGLL"},
-        {MsgType::GLGSV, "GLGSV"}, {MsgType::GNVTG, "GNVTG"}
-    };
 }
 
 QString NavigationDataFormatter::formatNavigationData(const NavigationData &navData) {
@@ -27,68 +19,28 @@ QString NavigationDataFormatter::formatNavigationData(const NavigationData &navD
 }
 
 QString NavigationDataFormatter::formatNavDataByType(const NavigationData &navData) {
-    // Используем switch с возвратом строки для оптимизации
+    // Данные уже лежат в типизированном виде — десериализация не нужна
     switch (navData.type) {
-    case MsgType::GNRMC: {
-        GNRMCData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNRMCData(data);
-    }
-    case MsgType::GNGGA: {
-        GNGGAData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNGGAData(data);
-    }
-    case MsgType::GNGSA: {
-        GNGSAData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGSAData(data);
-    }
-    case MsgType::GNZDA: {
-        GNZDAData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNZDAData(data);
-    }
-    case MsgType::GNDHV: {
-        GNDHVData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNDHVData(data);
-    }
-    case MsgType::GNGST: {
-        GNGSTData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNGSTData(data);
-    }
-    case MsgType::GPTXT: {
-        GPTXTData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGPTXTData(data);
-    }
-    case MsgType::GNGLL: {
-        GNGLLData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNGLLData(data);
-    }
-    case MsgType::GLGSV: {
-        GLGSVData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGLGSVData(data);
-    }
-    case MsgType::GNVTG: {
-        GNVTGData data;
-        QDataStream stream(navData.data);
-        stream >> data; // Используем оператор десериализации
-        return formatGNVTGData(data);
-    }
+    case MsgType::GNRMC:
+        return formatGNRMCData(std::get<GNRMCData>(navData.payload));
+    case MsgType::GNGGA:
+        return formatGNGGAData(std::get<GNGGAData>(navData.payload));
+    case MsgType::GNGSA:
+        return formatGSAData(std::get<GNGSAData>(navData.payload));
+    case MsgType::GNZDA:
+        return formatGNZDAData(std::get<GNZDAData>(navData.payload));
+    case MsgType::GNDHV:
+        return formatGNDHVData(std::get<GNDHVData>(navData.payload));
+    case MsgType::GNGST:
+        return formatGNGSTData(std::get<GNGSTData>(navData.payload));
+    case MsgType::GPTXT:
+        return formatGPTXTData(std::get<GPTXTData>(navData.payload));
+    case MsgType::GNGLL:
+        return formatGNGLLData(std::get<GNGLLData>(navData.payload));
+    case MsgType::GLGSV:
+        return formatGLGSVData(std::get<GLGSVData>(navData.payload));
+    case MsgType::GNVTG:
+        return formatGNVTGData(std::get<GNVTGData>(navData.payload));
     default:
         return QString("Unknown Message Type: %1\n").arg(static_cast<int>(navData.type));
     }
@@ -237,7 +189,8 @@ QString NavigationDataFormatter::formatGNVTGData(const GNVTGData &data) {
 
 QString NavigationDataFormatter::formatGLGSVData(const GLGSVData &data) {
     QStringList satellites;
-    for (const SatelliteInfo &sat : data.satelliteData) {
+    for (int i = 0; i < data.satelliteDataCount; ++i) {
+        const SatelliteInfo &sat = data.satelliteData[i];
         satellites.append(QString("  PRN: %1  Elev: %2°  Azim: %3°  SNR: %4 dBHz")
                               .arg(sat.prn)
                               .arg(sat.elevation, 0, 'f', 1)
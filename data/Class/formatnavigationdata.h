@@ -31,8 +31,6 @@ private:
 
     QString formatCoordinate(double value, bool isLatitude);
     QString gnssTypeToString(TypeGNSS type);
-
-    QHash<MsgType, QString> m_typeNames; // Кэширование имен типов сообщений
 };
 
 #endif // NAVIGATIONDATAFORMATTER_H
@@ -1,23 +1,31 @@
 // logger.cpp
 #include "logger.h"
 #include <QDateTime>
-#include <QTextStream>
 #include <QDir>
 #include <QDebug>
-#include <QTextEdit>
 
-Logger::Logger(const QString &filePath, QObject *parent)
-    : QObject(parent)
+Logger::Logger(const QString &filePath, QObject *parent, int queueCapacity)
+    : QObject(parent),
+    m_queue(static_cast<size_t>(qMax(2, queueCapacity)))
 {
     QDir().mkpath(QDir::currentPath() + "/logs");
     m_logFile.setFileName(filePath);
     if (!m_logFile.open(QIODevice::Append | QIODevice::Text)) {
         qCritical("Cannot open log file: %s", qUtf8Printable(filePath)); // Исправленный формат
     }
+
+    m_thread.setObjectName("Logger");
+    m_context.moveToThread(&m_thread);
+    m_thread.start();
 }
 
 Logger::~Logger()
 {
+    // Дописываем очередь до закрытия файла
+    QMetaObject::invokeMethod(&m_context, [this]() { drainQueue(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+
     if (m_logFile.isOpen()) {
         m_logFile.close();
     }
@@ -25,27 +33,79 @@ Logger::~Logger()
 
 void Logger::log(Logger::LogLevel level, const QString &message)
 {
-    //QMutexLocker locker(&m_mutex);
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    // Пишут несколько потоков: прием, импорт и фоновая запись в БД
     const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    const QString levelStr = logLevelToString(level);
-    const QString formatted = QString("[%1] [%2] %3")
-                                  .arg(timestamp)
-                                  .arg(levelStr)
-                                  .arg(message);
+    QString formatted = QString("[%1] [%2] %3")
+                            .arg(timestamp)
+                            .arg(logLevelToString(level))
+                            .arg(message);
+
+    if (!m_queue.tryPush(std::move(formatted))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    scheduleDrain();
+}
+
+void Logger::scheduleDrain()
+{
+    // Одно ожидающее пробуждение на любое число сообщений
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(&m_context, [this]() { drainQueue(); }, Qt::QueuedConnection);
+    }
+}
+
+void Logger::drainQueue()
+{
+    m_drainScheduled.store(false, std::memory_order_release);
 
-    // Запись в файл
-    writeToFile(formatted);
+    QByteArray batch;
+    QString formatted;
+    while (m_queue.tryPop(formatted)) {
+        batch += formatted.toUtf8();
+        batch += '\n';
 
-    // Отправка в GUI
-    emit logMessage(formatted);
+        // Отправка в GUI
+        emit logMessage(formatted);
 
-    // Дублирование в консоль для отладки
-    qDebug().noquote() << formatted; // Явное указание формата вывода
+        // Дублирование в консоль для отладки
+        qDebug().noquote() << formatted;
+    }
+
+    const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        const QString warning = QString("[%1] [WARNING] Очередь журнала переполнена, потеряно сообщений: %2")
+                                    .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                                    .arg(dropped - m_reportedDropped);
+        m_reportedDropped = dropped;
+        batch += warning.toUtf8();
+        batch += '\n';
+        emit logMessage(warning);
+    }
+
+    // Одна запись в файл на пачку сообщений
+    if (!batch.isEmpty() && m_logFile.isOpen()) {
+        m_logFile.write(batch);
+        m_logFile.flush();
+    }
 }
 
-void Logger::setDisplayWidget(QTextEdit *widget)
+void Logger::flush()
 {
-    m_displayWidget = widget;
+    QMetaObject::invokeMethod(&m_context, [this]() { drainQueue(); }, Qt::BlockingQueuedConnection);
+}
+
+Logger::LogLevel Logger::levelFromString(const QString &name)
+{
+    const QString level = name.toLower();
+    if (level == "debug") return Debug;
+    if (level == "warning") return Warning;
+    if (level == "error") return Error;
+    if (level == "critical") return Critical;
+    return Info;
 }
 
 QString Logger::logLevelToString(LogLevel level)
@@ -59,12 +119,3 @@ QString Logger::logLevelToString(LogLevel level)
     default:       return "UNKNOWN";
     }
 }
-
-void Logger::writeToFile(const QString &message)
-{
-    if (m_logFile.isOpen()) {
-        QTextStream stream(&m_logFile);
-        stream << message << "\n";
-        stream.flush();
-    }
-}
@@ -2,12 +2,32 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include "boundedqueue.h"
+
 #include <QObject>
 #include <QString>
 #include <QFile>
-#include <QMutex>
-#include <QTextEdit>
+#include <QThread>
+
+#include <atomic>
+
+// Уровни ниже COMETA_LOG_MIN_LEVEL отсекаются при компиляции
+// (0 — Debug, 1 — Info, 2 — Warning, 3 — Error, 4 — Critical)
+#ifndef COMETA_LOG_MIN_LEVEL
+#define COMETA_LOG_MIN_LEVEL 0
+#endif
 
+// Текст сообщения вычисляется, только если уровень включен
+#define COMETA_LOG(logger, level, message) \
+    do { \
+        if ((logger) && (logger)->isEnabled(level)) { \
+            (logger)->log((level), (message)); \
+        } \
+    } while (0)
+
+// Асинхронный журнал: log() форматирует запись и кладет ее в кольцевую
+// очередь, файл пишет отдельный поток пачками. При переполнении очереди
+// запись отбрасывается и учитывается в droppedCount().
 class Logger : public QObject
 {
     Q_OBJECT
@@ -22,21 +42,42 @@ public:
     };
     Q_ENUM(LogLevel)
 
-    explicit Logger(const QString &filePath, QObject *parent = nullptr);
+    explicit Logger(const QString &filePath, QObject *parent = nullptr, int queueCapacity = 8192);
     ~Logger();
 
     Q_INVOKABLE void log(LogLevel level, const QString &message);
-    void setDisplayWidget(QTextEdit *widget);
+
+    bool isEnabled(LogLevel level) const {
+        return level >= COMETA_LOG_MIN_LEVEL
+               && level >= m_minLevel.load(std::memory_order_relaxed);
+    }
+    void setMinLevel(LogLevel level) { m_minLevel.store(level, std::memory_order_relaxed); }
+    LogLevel minLevel() const { return m_minLevel.load(std::memory_order_relaxed); }
+    static LogLevel levelFromString(const QString &name);
+
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    // Дожидается записи всего, что уже в очереди
+    void flush();
 
 signals:
     void logMessage(const QString &formattedMessage);
 
 private:
     QFile m_logFile;
-    QTextEdit *m_displayWidget = nullptr;
-    QMutex m_mutex;
     QString logLevelToString(LogLevel level);
-    void writeToFile(const QString &message);
+
+    // Выполняется только в потоке записи
+    void drainQueue();
+    void scheduleDrain();
+
+    BoundedQueue<QString> m_queue;
+    QThread m_thread;
+    QObject m_context; // Живет в потоке записи, через него вызываются методы потока
+
+    std::atomic<LogLevel> m_minLevel{Debug};
+    std::atomic<bool> m_drainScheduled{false};
+    std::atomic<quint64> m_dropped{0};
+    quint64 m_reportedDropped = 0; // Сколько потерь уже записано в файл
 };
 
 #endif // LOGGER_H
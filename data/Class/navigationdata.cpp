@@ -1,107 +1,65 @@
 #include "NavigationData.h"
 
-QDataStream &operator>>(QDataStream &in, GNRMCData::CoordinateDefinition &coordDef) {
-    int value;
-    in >> value;
-    coordDef = static_cast<GNRMCData::CoordinateDefinition>(value);
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNRMCData &data) {
-    in >> data.time >> data.isValid >> data.latitude >> data.longitude >> data.speed >> data.course >> data.date;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNGGAData::AltitudeUnits &altUnit) {
-    int value;
-    in >> value;
-    altUnit = static_cast<GNGGAData::AltitudeUnits>(value);
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, ParseResult &result) {
-    int value;
-    in >> value;
-    result = static_cast<ParseResult>(value);
-    return in;
-}
-
-QDataStream& operator>>(QDataStream& in, GNGGAData& data) {
-    int coordDef, altUnit, diffUnit;
-    in >> data.time >> data.latitude >> data.longitude >> coordDef
-        >> data.satellitesCount >> data.HDOP >> data.altitude >> altUnit
-        >> data.diffElipsoidSeaLevel >> diffUnit >> data.countSecDGPS >> data.idDGPS >> data.result;
-    data.coordDef = static_cast<GNGGAData::CoordinateDefinition>(coordDef);
-    data.altUnit = static_cast<GNGGAData::AltitudeUnits>(altUnit);
-    data.diffElipsUnit = static_cast<GNGGAData::AltitudeUnits>(diffUnit);
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, TypeGNSS &gnss) {
-    int value;
-    in >> value;
-    gnss = static_cast<TypeGNSS>(value);
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, TypeFormat &format) {
-    int value;
-    in >> value;
-    format = static_cast<TypeFormat>(value);
-    return in;
-}
-
-QDataStream& operator>>(QDataStream& in, GNGSAData& data) {
-    int format, gnss;
-    in >> data.isAuto >> format;
-    for (int &id : data.satellitesUsedId) in >> id;
-    in >> data.PDOP >> data.HDOP >> data.VDOP >> gnss >> data.result;
-
-    data.typeFormat = static_cast<TypeFormat>(format);
-    data.typeGNSS = static_cast<TypeGNSS>(gnss);
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNZDAData &data) {
-    in >> data.time >> data.date >> data.localOffset;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNDHVData &data) {
-    in >> data.time >> data.speed3D >> data.speedECEF_X >> data.speedECEF_Y >> data.speedECEF_Z >> data.speed;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNGSTData &data) {
-    in >> data.time >> data.rms;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GPTXTData &data) {
-    in >> data.messageCount >> data.messageNumber >> data.messageType >> data.message;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNGLLData &data) {
-    in >> data.latitude >> data.longitude >> data.time >> data.isValid;
-    return in;
-}
-
-QDataStream& operator>>(QDataStream& in, SatelliteInfo& data) {
-    return in >> data.prn >> data.elevation >> data.azimuth >> data.snr;
-}
-
-QDataStream& operator>>(QDataStream& in, GLGSVData& data) {
-    in >> data.totalMessages >> data.messageNumber >> data.satellitesCount;
-    int count;
-    in >> count;
-    data.satelliteData.resize(count);
-    for (auto& sat : data.satelliteData) in >> sat;
-    in >> data.result;
-    return in;
-}
-
-QDataStream &operator>>(QDataStream &in, GNVTGData &data) {
-    in >> data.trueCourse >> data.magneticCourse >> data.speedKnots >> data.speedKmh >> data.isValid;
-    return in;
+const char *msgTypeName(MsgType type) {
+    switch (type) {
+    case GNRMC: return "GNRMC";
+    case GNGGA: return "GNGGA";
+    case GNGSA: return "GNGSA";
+    case GNZDA: return "GNZDA";
+    case GNDHV: return "GNDHV";
+    case GNGST: return "GNGST";
+    case GPTXT: return "GPTXT";
+    case GNGLL: return "GNGLL";
+    case GLGSV: return "GLGSV";
+    case GNVTG: return "GNVTG";
+    default:    return "UNKNOWN";
+    }
+}
+
+const char *talkerName(Talker talker) {
+    switch (talker) {
+    case Talker::GP: return "GP";
+    case Talker::GL: return "GL";
+    case Talker::GA: return "GA";
+    case Talker::GB: return "GB";
+    case Talker::GN: return "GN";
+    default:         return "--";
+    }
+}
+
+QByteArray SkyView::toBlob() const {
+    QByteArray blob(count * RecordSize, Qt::Uninitialized);
+    char *out = blob.data();
+    for (int i = 0; i < count; ++i, out += RecordSize) {
+        const SkySatellite &sat = satellites[i];
+        out[0] = static_cast<char>(sat.prn & 0xFF);
+        out[1] = static_cast<char>(sat.prn >> 8);
+        out[2] = static_cast<char>(sat.azimuth & 0xFF);
+        out[3] = static_cast<char>(sat.azimuth >> 8);
+        out[4] = static_cast<char>(sat.elevation);
+        out[5] = static_cast<char>(sat.snr);
+        out[6] = static_cast<char>(sat.talker);
+        out[7] = 0;
+    }
+    return blob;
+}
+
+bool SkyView::fromBlob(const QByteArray &blob) {
+    count = 0;
+    if (blob.size() % RecordSize != 0 || blob.size() / RecordSize > MaxSatellites) {
+        return false;
+    }
+
+    const uchar *in = reinterpret_cast<const uchar *>(blob.constData());
+    count = blob.size() / RecordSize;
+    for (int i = 0; i < count; ++i, in += RecordSize) {
+        SkySatellite &sat = satellites[i];
+        sat.prn = static_cast<quint16>(in[0] | (in[1] << 8));
+        sat.azimuth = static_cast<quint16>(in[2] | (in[3] << 8));
+        sat.elevation = in[4];
+        sat.snr = in[5];
+        sat.talker = in[6] <= static_cast<uchar>(Talker::GN) ? static_cast<Talker>(in[6]) : Talker::Unknown;
+        sat.reserved = 0;
+    }
+    return true;
 }
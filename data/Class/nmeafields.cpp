@@ -0,0 +1,293 @@
+// nmeafields.cpp
+#include "nmeafields.h"
+
+#include <cstring>
+
+namespace {
+// Точные степени десяти: деление целой мантиссы на них дает
+// корректно округленный результат, совпадающий с QString::toDouble()
+constexpr double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+constexpr int MAX_EXACT_POW10 = 22;
+constexpr int MAX_MANTISSA_DIGITS = 18;
+
+int digitValue(char c, int base)
+{
+    int value;
+    if (c >= '0' && c <= '9') {
+        value = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        value = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        value = c - 'a' + 10;
+    } else {
+        return -1;
+    }
+    return value < base ? value : -1;
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+int twoDigits(const char *p)
+{
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// Разбор ddmm.mmmmm: целая часть как число, дробная как мантисса и число цифр
+bool splitCoordinate(const char *data, int size, uint64_t &integer, uint64_t &fraction, int &fractionDigits)
+{
+    constexpr int MAX_FRACTION_DIGITS = 9;
+
+    int i = 0;
+    integer = 0;
+    for (; i < size && isDigit(data[i]); ++i) {
+        integer = integer * 10 + static_cast<uint64_t>(data[i] - '0');
+    }
+    // Минуты — две последние цифры целой части, градусов от одной до трех
+    if (i < 3 || i > 5) {
+        return false;
+    }
+
+    fraction = 0;
+    fractionDigits = 0;
+    if (i < size) {
+        if (data[i] != '.') {
+            return false;
+        }
+        for (++i; i < size; ++i) {
+            if (!isDigit(data[i]) || fractionDigits == MAX_FRACTION_DIGITS) {
+                return false;
+            }
+            fraction = fraction * 10 + static_cast<uint64_t>(data[i] - '0');
+            ++fractionDigits;
+        }
+    }
+    return integer % 100 < 60;
+}
+}
+
+bool NmeaField::equals(const char *text) const
+{
+    const size_t len = std::strlen(text);
+    return static_cast<size_t>(size) == len && std::memcmp(data, text, len) == 0;
+}
+
+NmeaField NmeaField::mid(int pos, int len) const
+{
+    NmeaField result;
+    if (pos < 0 || pos >= size) {
+        return result;
+    }
+    result.data = data + pos;
+    result.size = (len < 0 || pos + len > size) ? size - pos : len;
+    return result;
+}
+
+double NmeaField::toDouble(bool *ok) const
+{
+    int i = 0;
+    bool negative = false;
+    if (i < size && (data[i] == '-' || data[i] == '+')) {
+        negative = (data[i] == '-');
+        ++i;
+    }
+
+    uint64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int fractionDigits = 0;
+    int droppedDigits = 0;
+    bool seenDigit = false;
+    bool seenPoint = false;
+
+    for (; i < size; ++i) {
+        const char c = data[i];
+        if (c == '.' && !seenPoint) {
+            seenPoint = true;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            if (ok) *ok = false;
+            return 0.0;
+        }
+        seenDigit = true;
+        if (mantissaDigits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+            if (mantissa != 0) ++mantissaDigits;
+            if (seenPoint) ++fractionDigits;
+        } else if (!seenPoint) {
+            ++droppedDigits; // Целая часть длиннее мантиссы — учитываем порядок
+        }
+    }
+
+    if (!seenDigit) {
+        if (ok) *ok = false;
+        return 0.0;
+    }
+
+    double value = static_cast<double>(mantissa);
+    const int exponent = droppedDigits - fractionDigits;
+    if (exponent < 0) {
+        value = (-exponent <= MAX_EXACT_POW10)
+                    ? value / POW10[-exponent]
+                    : static_cast<double>(static_cast<long double>(mantissa) / POW10[MAX_EXACT_POW10]
+                                          / POW10[-exponent - MAX_EXACT_POW10]);
+    } else if (exponent > 0) {
+        value *= POW10[exponent <= MAX_EXACT_POW10 ? exponent : MAX_EXACT_POW10];
+    }
+
+    if (ok) *ok = true;
+    return negative ? -value : value;
+}
+
+int NmeaField::toInt(bool *ok, int base) const
+{
+    int i = 0;
+    bool negative = false;
+    if (i < size && (data[i] == '-' || data[i] == '+')) {
+        negative = (data[i] == '-');
+        ++i;
+    }
+
+    if (i >= size) {
+        if (ok) *ok = false;
+        return 0;
+    }
+
+    int64_t value = 0;
+    for (; i < size; ++i) {
+        const int digit = digitValue(data[i], base);
+        if (digit < 0) {
+            if (ok) *ok = false;
+            return 0;
+        }
+        value = value * base + digit;
+        if (value > INT32_MAX) {
+            if (ok) *ok = false;
+            return 0;
+        }
+    }
+
+    if (ok) *ok = true;
+    return static_cast<int>(negative ? -value : value);
+}
+
+bool NmeaFields::tokenize(const char *begin, const char *end)
+{
+    m_count = 0;
+    const char *start = begin;
+    for (const char *p = begin; p < end; ++p) {
+        if (*p == ',') {
+            if (m_count == MaxFields) return false;
+            m_fields[m_count].data = start;
+            m_fields[m_count].size = static_cast<int>(p - start);
+            ++m_count;
+            start = p + 1;
+        }
+    }
+    if (m_count == MaxFields) return false;
+    m_fields[m_count].data = start;
+    m_fields[m_count].size = static_cast<int>(end - start);
+    ++m_count;
+    return true;
+}
+
+bool NmeaField::toCoordinate(char hemisphere, double &degrees) const
+{
+    uint64_t integer;
+    uint64_t fraction;
+    int fractionDigits;
+    if (!splitCoordinate(data, size, integer, fraction, fractionDigits)) {
+        return false;
+    }
+
+    // Те же операции, что и у прежнего пути toDouble(): число собирается
+    // из точной целой мантиссы (не больше 14 цифр), затем делится на 100 и 60
+    const uint64_t scale = static_cast<uint64_t>(POW10[fractionDigits]);
+    const double value = static_cast<double>(integer * scale + fraction) / POW10[fractionDigits];
+    const double whole = static_cast<int>(value / 100);
+    const double minutes = value - whole * 100;
+    degrees = whole + minutes / 60.0;
+
+    if (hemisphere == 'S' || hemisphere == 'W') {
+        degrees = -degrees;
+    }
+    return true;
+}
+
+bool NmeaField::toCoordinateE6(char hemisphere, int32_t &microdegrees) const
+{
+    uint64_t integer;
+    uint64_t fraction;
+    int fractionDigits;
+    if (!splitCoordinate(data, size, integer, fraction, fractionDigits)) {
+        return false;
+    }
+
+    // Минуты в единицах 10^-fractionDigits, перевод в микроградусы целочисленно
+    const uint64_t scale = static_cast<uint64_t>(POW10[fractionDigits]);
+    const uint64_t minutes = (integer % 100) * scale + fraction;
+    const uint64_t divisor = 60 * scale;
+    const uint64_t micro = (integer / 100) * 1000000 + (minutes * 1000000 + divisor / 2) / divisor;
+
+    microdegrees = static_cast<int32_t>(micro);
+    if (hemisphere == 'S' || hemisphere == 'W') {
+        microdegrees = -microdegrees;
+    }
+    return true;
+}
+
+bool NmeaField::toTimeMs(int32_t &msecs) const
+{
+    if (size < 6 || !isDigit(data[0]) || !isDigit(data[1]) || !isDigit(data[2])
+        || !isDigit(data[3]) || !isDigit(data[4]) || !isDigit(data[5])) {
+        return false;
+    }
+
+    const int hours = twoDigits(data);
+    const int minutes = twoDigits(data + 2);
+    const int seconds = twoDigits(data + 4);
+    if (hours > 23 || minutes > 59 || seconds > 59) {
+        return false;
+    }
+
+    // Доли секунды: учитываются первые три цифры, остальные отбрасываются
+    int millis = 0;
+    if (size > 6) {
+        if (data[6] != '.') {
+            return false;
+        }
+        int scale = 100;
+        for (int i = 7; i < size; ++i) {
+            if (!isDigit(data[i])) {
+                return false;
+            }
+            millis += (data[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    msecs = ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+    return true;
+}
+
+bool NmeaField::toDate(int &day, int &month, int &year) const
+{
+    if (size != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; ++i) {
+        if (!isDigit(data[i])) {
+            return false;
+        }
+    }
+
+    day = twoDigits(data);
+    month = twoDigits(data + 2);
+    year = 2000 + twoDigits(data + 4);
+    return day >= 1 && day <= 31 && month >= 1 && month <= 12;
+}
@@ -0,0 +1,60 @@
+// nmeafields.h
+#ifndef NMEAFIELDS_H
+#define NMEAFIELDS_H
+
+#include <cstdint>
+
+// Поле NMEA-сообщения. Не владеет данными: указывает прямо в буфер приема,
+// поэтому разбор строки не требует ни копирования, ни выделения памяти.
+struct NmeaField {
+    const char *data = nullptr;
+    int size = 0;
+
+    bool isEmpty() const { return size == 0; }
+    int length() const { return size; }
+    char at(int i) const { return data[i]; }
+
+    // Сравнение с одиночным символом ('A', 'N', 'M' и т.п.)
+    bool operator==(char c) const { return size == 1 && data[0] == c; }
+    bool operator!=(char c) const { return !(*this == c); }
+    bool equals(const char *text) const;
+
+    NmeaField mid(int pos, int len = -1) const;
+
+    // Преобразования не зависят от локали: NMEA всегда использует '.'
+    double toDouble(bool *ok = nullptr) const;
+    int toInt(bool *ok = nullptr, int base = 10) const;
+
+    // Поля фиксированного формата: разбор по позициям цифр, без mid() и toInt().
+    // Координата ddmm.mmmmm или dddmm.mmmmm; знак задает полушарие 'S'/'W'.
+    // Результат в градусах совпадает с прежним разбором через toDouble() бит в бит.
+    bool toCoordinate(char hemisphere, double &degrees) const;
+    // Та же координата в целых микроградусах (округление к ближайшему)
+    bool toCoordinateE6(char hemisphere, int32_t &microdegrees) const;
+    // Время hhmmss[.sss] в миллисекундах от начала суток
+    bool toTimeMs(int32_t &msecs) const;
+    // Дата ddmmyy; год возвращается полностью (20yy)
+    bool toDate(int &day, int &month, int &year) const;
+};
+
+// Набор полей одного сообщения фиксированной емкости (без кучи).
+class NmeaFields {
+public:
+    // 82 символа максимум по стандарту — полей заведомо меньше
+    static constexpr int MaxFields = 48;
+
+    // Разбивает диапазон [begin, end) по запятым. Возвращает false,
+    // если полей больше, чем MaxFields.
+    bool tokenize(const char *begin, const char *end);
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    const NmeaField &first() const { return m_fields[0]; }
+    const NmeaField &operator[](int i) const { return m_fields[i]; }
+
+private:
+    NmeaField m_fields[MaxFields];
+    int m_count = 0;
+};
+
+#endif // NMEAFIELDS_H
@@ -0,0 +1,76 @@
+// nmeaframer.cpp
+#include "nmeaframer.h"
+
+#include <cstring>
+
+void NmeaFramer::reset()
+{
+    m_carrySize = 0;
+    m_frames.clear();
+    m_stats = Stats();
+}
+
+int NmeaFramer::completeCarry(const char *data, int size)
+{
+    const int room = CarryCapacity - m_carrySize;
+    const int searched = size < room ? size : room;
+    const char *newline = static_cast<const char *>(std::memchr(data, '\n', static_cast<size_t>(searched)));
+
+    if (newline) {
+        const int taken = static_cast<int>(newline - data) + 1;
+        std::memcpy(m_carry + m_carrySize, data, static_cast<size_t>(taken));
+        m_carrySize += taken;
+        return taken;
+    }
+
+    if (size < room) {
+        // Строка все еще не закончилась
+        std::memcpy(m_carry + m_carrySize, data, static_cast<size_t>(size));
+        m_carrySize += size;
+        return -1;
+    }
+
+    // Конца строки нет в пределах хвоста: это не предложение.
+    // Остаток строки в новом куске отбросит разметка — до следующего '$'.
+    m_stats.bytesDiscarded += static_cast<uint64_t>(m_carrySize);
+    ++m_stats.overflows;
+    m_carrySize = 0;
+    return 0;
+}
+
+void NmeaFramer::keepTail(const char *tail, int size)
+{
+    // Незавершенное предложение начинается с последнего '$' хвоста
+    int start = size - 1;
+    while (start >= 0 && tail[start] != '$') {
+        --start;
+    }
+
+    if (start < 0) {
+        m_stats.bytesDiscarded += static_cast<uint64_t>(countGarbage(tail, tail + size));
+        return;
+    }
+
+    m_stats.bytesDiscarded += static_cast<uint64_t>(countGarbage(tail, tail + start));
+    const int length = size - start;
+    if (length > CarryCapacity) {
+        m_stats.bytesDiscarded += static_cast<uint64_t>(length);
+        ++m_stats.overflows;
+        return;
+    }
+
+    std::memcpy(m_carry, tail + start, static_cast<size_t>(length));
+    m_carrySize = length;
+}
+
+int NmeaFramer::countGarbage(const char *begin, const char *end)
+{
+    // Переводы строк между предложениями мусором не считаются
+    int count = 0;
+    for (const char *p = begin; p < end; ++p) {
+        if (*p != '\r' && *p != '\n') {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,111 @@
+// nmeaframer.h
+#ifndef NMEAFRAMER_H
+#define NMEAFRAMER_H
+
+#include "nmeaframing.h"
+
+#include <cstdint>
+#include <vector>
+
+// Потоковая разметка NMEA: принимает куски произвольной длины (чтения
+// порта, датаграммы, блоки файла) и отдает целые предложения.
+// Предложения внутри куска передаются обработчику без копирования.
+// Копируется только предложение, разрезанное границей куска: его начало
+// ждет продолжения в хвосте фиксированного размера. Если продолжение не
+// укладывается в хвост, хвост сбрасывается и разметка возобновляется со
+// следующего '$' — ресинхронизация не длиннее CarryCapacity байтов.
+class NmeaFramer
+{
+public:
+    // 82 символа предложения, \r\n и запас
+    static constexpr int CarryCapacity = 128;
+
+    struct Stats {
+        uint64_t bytesReceived = 0;
+        uint64_t bytesDiscarded = 0; // Мусор вне предложений и сброшенные хвосты
+        uint64_t frames = 0;         // Выданные предложения, включая некорректные
+        uint64_t stitchedFrames = 0; // Собраны из двух кусков
+        uint64_t overflows = 0;      // Хвост не уместился в CarryCapacity
+    };
+
+    // handler(const char *buffer, const NmeaFrame &frame) — буфер действителен
+    // только на время вызова
+    template <typename Handler>
+    void feed(const char *data, int size, Handler &&handler);
+
+    // Конец потока: незавершенная строка отдается как последняя
+    template <typename Handler>
+    void flush(Handler &&handler);
+
+    void reset();
+
+    const Stats &stats() const { return m_stats; }
+    int pendingBytes() const { return m_carrySize; }
+
+private:
+    template <typename Handler>
+    int scan(const char *data, int size, bool atEnd, Handler &handler);
+
+    // Возвращает число байтов, взятых из data для завершения хвоста,
+    // или -1, если весь кусок ушел в хвост
+    int completeCarry(const char *data, int size);
+    void keepTail(const char *tail, int size);
+    static int countGarbage(const char *begin, const char *end);
+
+    char m_carry[CarryCapacity];
+    int m_carrySize = 0;
+    std::vector<NmeaFrame> m_frames; // Разметка текущего куска, память переиспользуется
+    Stats m_stats;
+};
+
+template <typename Handler>
+void NmeaFramer::feed(const char *data, int size, Handler &&handler)
+{
+    m_stats.bytesReceived += static_cast<uint64_t>(size);
+
+    int pos = 0;
+    if (m_carrySize > 0) {
+        pos = completeCarry(data, size);
+        if (pos < 0) {
+            return;
+        }
+        if (m_carrySize > 0) {
+            // Хвост дополнен до конца строки
+            const uint64_t before = m_stats.frames;
+            scan(m_carry, m_carrySize, false, handler);
+            m_stats.stitchedFrames += m_stats.frames - before;
+            m_carrySize = 0;
+        }
+    }
+
+    const int consumed = scan(data + pos, size - pos, false, handler);
+    keepTail(data + pos + consumed, size - pos - consumed);
+}
+
+template <typename Handler>
+void NmeaFramer::flush(Handler &&handler)
+{
+    if (m_carrySize > 0) {
+        scan(m_carry, m_carrySize, true, handler);
+        m_carrySize = 0;
+    }
+}
+
+template <typename Handler>
+int NmeaFramer::scan(const char *data, int size, bool atEnd, Handler &handler)
+{
+    m_frames.clear();
+    const int consumed = scanNmeaFrames(data, size, m_frames, atEnd);
+
+    int cursor = 0;
+    for (const NmeaFrame &frame : m_frames) {
+        m_stats.bytesDiscarded += static_cast<uint64_t>(countGarbage(data + cursor, data + frame.offset));
+        handler(data, frame);
+        cursor = frame.offset + frame.length;
+    }
+    m_stats.bytesDiscarded += static_cast<uint64_t>(countGarbage(data + cursor, data + consumed));
+    m_stats.frames += m_frames.size();
+    return consumed;
+}
+
+#endif // NMEAFRAMER_H
@@ -0,0 +1,208 @@
+// nmeaframing.cpp
+#include "nmeaframing.h"
+
+#include <cstring>
+
+#if !defined(COMETA_FRAMING_SCALAR)
+#  if defined(__AVX2__)
+#    define COMETA_FRAMING_AVX2
+#    include <immintrin.h>
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define COMETA_FRAMING_SSE2
+#    include <emmintrin.h>
+#  endif
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+namespace {
+constexpr int MAX_LINE_LENGTH = 82;
+
+inline int lowestBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Состояние разметки между блоками
+struct Scanner {
+    const char *data;
+    std::vector<NmeaFrame> &frames;
+    int start = -1; // Последний '$' текущей строки
+    int star = -1;  // Первый '*' после него
+    int consumed = 0;
+
+    void emit(int lineEnd)
+    {
+        int end = lineEnd;
+        while (end > start && (data[end - 1] == '\r' || data[end - 1] == ' ')) {
+            --end;
+        }
+
+        NmeaFrame frame;
+        frame.offset = start;
+        frame.length = end - start;
+        if (star >= 0 && star == end - 3 && frame.length <= MAX_LINE_LENGTH) {
+            const int high = hexValue(data[star + 1]);
+            const int low = hexValue(data[star + 2]);
+            frame.valid = high >= 0 && low >= 0
+                          && nmeaChecksum(data + start + 1, data + star) == ((high << 4) | low);
+        }
+        frames.push_back(frame);
+    }
+
+    void structural(int pos)
+    {
+        switch (data[pos]) {
+        case '$':
+            // Новый '$' внутри строки — предыдущее начало было мусором
+            start = pos;
+            star = -1;
+            break;
+        case '*':
+            if (start >= 0 && star < 0) {
+                star = pos;
+            }
+            break;
+        default: // '\n'
+            if (start >= 0) {
+                emit(pos);
+                start = -1;
+            }
+            consumed = pos + 1;
+            break;
+        }
+    }
+
+    void scalar(int from, int to)
+    {
+        for (int pos = from; pos < to; ++pos) {
+            const char c = data[pos];
+            if (c == '$' || c == '*' || c == '\n') {
+                structural(pos);
+            }
+        }
+    }
+};
+}
+
+int scanNmeaFrames(const char *data, int size, std::vector<NmeaFrame> &frames, bool atEnd)
+{
+    Scanner scanner{data, frames};
+    int pos = 0;
+
+#if defined(COMETA_FRAMING_AVX2)
+    const __m256i dollar = _mm256_set1_epi8('$');
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; size - pos >= 32; pos += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+        const __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, dollar),
+                                                             _mm256_cmpeq_epi8(block, star)),
+                                             _mm256_cmpeq_epi8(block, newline));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        while (mask) {
+            scanner.structural(pos + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+#if defined(COMETA_FRAMING_AVX2) || defined(COMETA_FRAMING_SSE2)
+    const __m128i dollar16 = _mm_set1_epi8('$');
+    const __m128i star16 = _mm_set1_epi8('*');
+    const __m128i newline16 = _mm_set1_epi8('\n');
+    for (; size - pos >= 16; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, dollar16),
+                                                       _mm_cmpeq_epi8(block, star16)),
+                                          _mm_cmpeq_epi8(block, newline16));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        while (mask) {
+            scanner.structural(pos + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    scanner.scalar(pos, size);
+
+    if (atEnd) {
+        if (scanner.start >= 0) {
+            scanner.emit(size);
+        }
+        scanner.consumed = size;
+    }
+    return scanner.consumed;
+}
+
+uint8_t nmeaChecksum(const char *begin, const char *end)
+{
+    const char *p = begin;
+    uint8_t sum = 0;
+
+#if defined(COMETA_FRAMING_AVX2) || defined(COMETA_FRAMING_SSE2)
+    __m128i acc = _mm_setzero_si128();
+#  if defined(COMETA_FRAMING_AVX2)
+    if (end - p >= 32) {
+        __m256i acc256 = _mm256_setzero_si256();
+        for (; end - p >= 32; p += 32) {
+            acc256 = _mm256_xor_si256(acc256, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        }
+        acc = _mm_xor_si128(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+    }
+#  endif
+    for (; end - p >= 16; p += 16) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+    // Свертка 16 байтов в один
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+    sum = static_cast<uint8_t>(_mm_cvtsi128_si32(acc));
+#else
+    // Без SIMD — по восемь байтов за шаг
+    uint64_t word = 0;
+    for (; end - p >= 8; p += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, sizeof(chunk));
+        word ^= chunk;
+    }
+    word ^= word >> 32;
+    word ^= word >> 16;
+    word ^= word >> 8;
+    sum = static_cast<uint8_t>(word);
+#endif
+
+    for (; p < end; ++p) {
+        sum ^= static_cast<uint8_t>(*p);
+    }
+    return sum;
+}
+
+const char *nmeaFramingKernel()
+{
+#if defined(COMETA_FRAMING_AVX2)
+    return "avx2";
+#elif defined(COMETA_FRAMING_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
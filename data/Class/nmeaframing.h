@@ -0,0 +1,29 @@
+// nmeaframing.h
+#ifndef NMEAFRAMING_H
+#define NMEAFRAMING_H
+
+#include <cstdint>
+#include <vector>
+
+// Границы предложения в буфере приема. Строка не копируется:
+// парсер получает буфер и дескриптор.
+struct NmeaFrame {
+    int offset = 0;     // Позиция '$'
+    int length = 0;     // От '$' до конца контрольной суммы, без \r\n
+    bool valid = false; // Строка заканчивается на "*hh", сумма совпала, длина не больше 82
+};
+
+// Разметка буфера за один проход: поиск '$', '*' и '\n' блоками по 16
+// (SSE2) или 32 (AVX2) байта, контрольная сумма XOR по словам.
+// Предложение — от последнего '$' до конца строки; строки без '$' пропускаются.
+// Возвращает число байтов до конца последней полной строки. Хвост без '\n'
+// остается вызывающему, при atEnd он считается последней строкой.
+int scanNmeaFrames(const char *data, int size, std::vector<NmeaFrame> &frames, bool atEnd = false);
+
+// XOR байтов [begin, end)
+uint8_t nmeaChecksum(const char *begin, const char *end);
+
+// Реализация, выбранная при сборке: "avx2", "sse2" или "scalar"
+const char *nmeaFramingKernel();
+
+#endif // NMEAFRAMING_H
@@ -3,30 +3,41 @@
 #include <QDateTime>
 #include <QDebug>
 #include <cmath>
+#include <cstring>
 
 // Константы для валидации
 namespace {
 constexpr int MAX_LINE_LENGTH = 82;
-constexpr int BUFFER_SIZE = 1024;
 constexpr double KNOTS_TO_KMH = 1.852;
+
+// Три буквы типа предложения в одном числе — ключ для switch
+constexpr quint32 packSentence(char a, char b, char c) {
+    return (static_cast<quint32>(static_cast<quint8>(a)) << 16)
+           | (static_cast<quint32>(static_cast<quint8>(b)) << 8)
+           | static_cast<quint8>(c);
+}
+}
+
+const char *parseErrorName(ParseError error)
+{
+    switch (error) {
+    case ParseError::None:            return "none";
+    case ParseError::BadStart:        return "bad start";
+    case ParseError::NoChecksum:      return "no checksum";
+    case ParseError::TooLong:         return "too long";
+    case ParseError::BadChecksum:     return "bad checksum";
+    case ParseError::TooManyFields:   return "too many fields";
+    case ParseError::UnknownTalker:   return "unknown talker";
+    case ParseError::UnknownSentence: return "unknown sentence";
+    case ParseError::MissingFields:   return "missing fields";
+    case ParseError::BadField:        return "bad field";
+    case ParseError::OutOfRange:      return "out of range";
+    default:                          return "unknown";
+    }
 }
 
 ParserNMEA::ParserNMEA(QObject *parent) : QObject(parent)
 {
-    inCompleteLine.reserve(BUFFER_SIZE);
-    m_buffer.reserve(BUFFER_SIZE);
-    m_parsers = {
-        {"GNRMC", &ParserNMEA::parseGNRMC},
-        {"GNGGA", &ParserNMEA::parseGNGGA},
-        {"GNGSA", &ParserNMEA::parseGNGSA},
-        {"GNZDA", &ParserNMEA::parseGNZDA},
-        {"GNDHV", &ParserNMEA::parseGNDHV},
-        {"GNGST", &ParserNMEA::parseGNGST},
-        {"GPTXT", &ParserNMEA::parseGPTXT},
-        {"GNGLL", &ParserNMEA::parseGNGLL},
-        {"GLGSV", &ParserNMEA::parseGLGSV},
-        {"GNVTG", &ParserNMEA::parseGNVTG}
-    };
 }
 
 void ParserNMEA::setLogger(Logger* logger){
@@ -34,1178 +45,846 @@ void ParserNMEA::setLogger(Logger* logger){
 }
 
 NavigationData ParserNMEA::parseData(QString &line)
+{
+    // Совместимость со старым интерфейсом: одна целая строка.
+    // Склейкой разрезанных строк занимается NmeaFramer.
+    const QByteArray bytes = line.toLatin1();
+    return parseData(bytes.constData(), bytes.size());
+}
+
+NavigationData ParserNMEA::parseData(const QByteArray &line)
+{
+    return parseData(line.constData(), line.size());
+}
+
+NavigationData ParserNMEA::parseData(const char *line, int length)
 {
     NavigationData result;
     result.result = ParseResult::ERROR;
     result.timestamp = QDateTime::currentDateTime();
 
-    try {
-        const int starPos = line.indexOf('*');
-        if (starPos == -1 || starPos + 3 > line.length()) {
-            logError("PARSE", QString("Checksum marker not found: %1").arg(line));
-        }
-
-        if(!isValidString(line)){
-            inCompleteLine += line;
-            if (starPos == -1 || starPos + 3 > line.length()) {
-                logError("PARSE", QString("Checksum marker not found: %1").arg(line));
-            }
-            if(!isValidString(inCompleteLine)){
-                logError("PARSE", QString("String no type: %1").arg(line));
-                return result;
-            }
-            line = inCompleteLine;
-        }
+    m_line = line;
+    m_lineLength = length;
+    m_sentence = nullptr;
 
-        // Разделение на части
-        QVector<QStringRef> parts;
-        parts.reserve(20);
+    const ParseError frameError = validateFrame(line, length);
+    if (frameError != ParseError::None) {
+        reject(frameError);
+        return result;
+    }
 
-        int start = 1;
-        const int endPos = starPos;
-        const int lineLength = line.length();
+    parseSentence(line, static_cast<const char *>(std::memchr(line, '*', length)), result);
+    return result;
+}
 
-        for (int i = start; i < endPos && i < lineLength; ++i) {
-            if (line[i] == ',') {
-                parts.append(QStringRef(&line, start, i - start));
-                start = i + 1;
-            }
-        }
-        parts.append(QStringRef(&line, start, endPos - start));
+NavigationData ParserNMEA::parseFrame(const char *buffer, const NmeaFrame &frame)
+{
+    const char *line = buffer + frame.offset;
+    if (!frame.valid) {
+        // Редкий случай: полная проверка определит причину отказа
+        return parseData(line, frame.length);
+    }
 
-        if (parts.isEmpty()) {
-            throw std::invalid_argument("No message parts");
-        }
+    NavigationData result;
+    result.result = ParseResult::ERROR;
+    result.timestamp = QDateTime::currentDateTime();
 
-        // Определение типа сообщения
-        const QString msgType = parts.first().toString();
-        const auto parser = m_parsers.constFind(msgType);
+    m_line = line;
+    m_lineLength = frame.length;
+    m_sentence = nullptr;
 
-        if (parser == m_parsers.constEnd()) {
-            throw std::invalid_argument(QString("Unsupported message type: %1").arg(msgType).toStdString());
-        }
+    // У корректного кадра контрольная сумма — последние три символа
+    parseSentence(line, line + frame.length - 3, result);
+    return result;
+}
 
-        // Вызов обработчика
-        parser.value()(this, parts, result);
-        result.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed message");
+void ParserNMEA::parseSentence(const char *line, const char *starPos, NavigationData &result)
+{
+    // Разделение на части прямо в исходном буфере
+    NmeaFields parts;
+    if (!parts.tokenize(line + 1, starPos)) {
+        reject(ParseError::TooManyFields);
+        return;
+    }
 
-    } catch (const std::exception &e) {
-        logError("PARSE", QString("Error: %1. Data: %2").arg(e.what(), line.left(50)));
-        m_buffer = line;
+    // Адрес: две буквы источника и три буквы типа предложения
+    const NmeaField &typeField = parts.first();
+    const Talker talker = typeField.size == 5
+                              ? talkerFromId(typeField.data[0], typeField.data[1])
+                              : Talker::Unknown;
+    if (talker == Talker::Unknown) {
+        reject(ParseError::UnknownTalker, "Address");
+        return;
+    }
+    result.talker = talker;
+
+    // Вызов обработчика: switch по упакованному коду предложения
+    const char *sentence = typeField.data + 2;
+    bool parsed = false;
+    switch (packSentence(sentence[0], sentence[1], sentence[2])) {
+    case packSentence('R', 'M', 'C'): parsed = parseGNRMC(parts, result); break;
+    case packSentence('G', 'G', 'A'): parsed = parseGNGGA(parts, result); break;
+    case packSentence('G', 'S', 'A'): parsed = parseGNGSA(parts, result); break;
+    case packSentence('Z', 'D', 'A'): parsed = parseGNZDA(parts, result); break;
+    case packSentence('D', 'H', 'V'): parsed = parseGNDHV(parts, result); break;
+    case packSentence('G', 'S', 'T'): parsed = parseGNGST(parts, result); break;
+    case packSentence('T', 'X', 'T'): parsed = parseGPTXT(parts, result); break;
+    case packSentence('G', 'L', 'L'): parsed = parseGNGLL(parts, result); break;
+    case packSentence('G', 'S', 'V'): parsed = parseGLGSV(parts, result); break;
+    case packSentence('V', 'T', 'G'): parsed = parseGNVTG(parts, result); break;
+    default:
+        reject(ParseError::UnknownSentence, "Address");
+        break;
+    }
+    if (!parsed) {
+        // Обработчик заполняет данные только при успехе
+        return;
     }
 
-    return result;
+    result.result = ParseResult::OK;
+    ++m_parsed;
+    // На каждое сообщение — только отладочный уровень, обычно отключенный
+    COMETA_LOG(m_logger, Logger::Debug, QStringLiteral("[PARSE] Successfully parsed message"));
 }
 
-bool ParserNMEA::isValidString(QString &line)
+ParseError ParserNMEA::validateFrame(const char *line, int length) const
 {
-    const int starPos = line.indexOf('*');
-
-    // Проверки
-    if (line.length() < 7 || line[0] != '$') {
-        logError("PARSE","Invalid message start");
-        return false;
+    if (length < 7 || line[0] != '$') {
+        return ParseError::BadStart;
     }
-    if (starPos == -1 || starPos + 3 > line.length()) {
-        logError("PARSE","Checksum marker not found");
-        return false;
+    const char *starPos = static_cast<const char *>(std::memchr(line, '*', length));
+    if (!starPos || (starPos - line) + 3 > length) {
+        return ParseError::NoChecksum;
     }
-    if (line.length() > MAX_LINE_LENGTH) {
-        logError("PARSE","Message too long");
-        return false;
+    if (length > MAX_LINE_LENGTH) {
+        return ParseError::TooLong;
     }
-    if (!validateChecksum(line)) {
-        logError("PARSE","Checksum validation failed");
-        return false;
+    if (!validateChecksum(line, length)) {
+        return ParseError::BadChecksum;
     }
-    return true;
+    return ParseError::None;
 }
 
 // Вспомогательные методы
-bool ParserNMEA::validateChecksum(const QString &line) const
+bool ParserNMEA::validateChecksum(const char *line, int length) const
 {
-    const int starPos = line.indexOf('*');
-    if (starPos < 1 || starPos + 2 >= line.length()) return false;
-
-    uint8_t calculated = 0;
-    const QChar* data = line.constData() + 1; // Пропускаем $
+    const char *starPos = static_cast<const char *>(std::memchr(line, '*', length));
+    if (!starPos || starPos == line || (starPos - line) + 2 >= length) return false;
 
-    for (int i = 1; i < starPos; ++i) {
-        calculated ^= data[i-1].toLatin1();
-    }
+    const uint8_t calculated = nmeaChecksum(line + 1, starPos); // Пропускаем $
 
     bool ok;
-    const uint8_t expected = line.midRef(starPos+1, 2).toInt(&ok, 16);
+    const NmeaField expectedField{starPos + 1, 2};
+    const uint8_t expected = expectedField.toInt(&ok, 16);
 
-    if (!ok) {
-        logError("CHECKSUM", "Invalid checksum format");
-        return false;
-    }
-
-    return calculated == expected;
+    return ok && calculated == expected;
 }
 
-void ParserNMEA::parseGNRMC(const QVector<QStringRef> &parts, NavigationData &data) {
+bool ParserNMEA::parseGNRMC(const NmeaFields &parts, NavigationData &data) {
+    m_sentence = "GNRMC";
     if (parts.size() < 12) {
-        logError("GNRMC", "Insufficient parts");
-        return;
+        return reject(ParseError::MissingFields);
     }
 
     GNRMCData rmc;
-    const QString msgType = "GNRMC";
-
-    try {
-        rmc.time = parseTime(parts[1], msgType);
-        rmc.isValid = (parts[2] == "A");
-        rmc.latitude = parseCoordinate(parts[3], parts[4], msgType);
-        rmc.longitude = parseCoordinate(parts[5], parts[6], msgType);
-        rmc.speed = validateRange(parts[7].toDouble(), 0.0, 102.3, "Speed", msgType);
-        rmc.course = validateRange(parts[8].toDouble(), 0.0, 360.0, "Course", msgType);
-        rmc.date = parseDate(parts[9], msgType);
-
-        // Обработка магнитного отклонения (части 10 и 11)
-        if (parts.size() > 10 && !parts[10].isEmpty()) {
-            rmc.magnDeviation = parts[10].toDouble();
-        } else {
-            rmc.magnDeviation = 0.0;
-        }
-
-        // Обработка определения координат (часть 11)
-        if (parts.size() > 11) {
-            int coordDef = parts[11].toInt();
-            if (coordDef < 0 || coordDef > GNRMCData::COORDINATE_INVALID) {
-                coordDef = GNRMCData::COORDINATE_INVALID;
-            }
-            rmc.coordinateDefinition = static_cast<GNRMCData::CoordinateDefinition>(coordDef);
-        } else {
-            rmc.coordinateDefinition = GNRMCData::COORDINATE_INVALID;
+    rmc.time = parseTime(parts[1]);
+    rmc.isValid = (parts[2] == 'A');
+    rmc.latitude = parseCoordinate(parts[3], parts[4], "Latitude");
+    rmc.longitude = parseCoordinate(parts[5], parts[6], "Longitude");
+    rmc.speed = validateRange(parts[7].toDouble(), 0.0, 102.3, "Speed");
+    rmc.course = validateRange(parts[8].toDouble(), 0.0, 360.0, "Course");
+    rmc.date = parseDate(parts[9]);
+
+    // Обработка магнитного отклонения (части 10 и 11)
+    if (parts.size() > 10 && !parts[10].isEmpty()) {
+        rmc.magnDeviation = parts[10].toDouble();
+    } else {
+        rmc.magnDeviation = 0.0;
+    }
+
+    // Обработка определения координат (часть 11)
+    if (parts.size() > 11) {
+        int coordDef = parts[11].toInt();
+        if (coordDef < 0 || coordDef > GNRMCData::COORDINATE_INVALID) {
+            coordDef = GNRMCData::COORDINATE_INVALID;
         }
+        rmc.coordinateDefinition = static_cast<GNRMCData::CoordinateDefinition>(coordDef);
+    } else {
+        rmc.coordinateDefinition = GNRMCData::COORDINATE_INVALID;
+    }
 
-        // Обработка статуса навигации (часть 12)
-        rmc.statusNav = (parts.size() > 12) ? (parts[12] == "A") : false;
+    // Обработка статуса навигации (часть 12)
+    rmc.statusNav = (parts.size() > 12) ? (parts[12] == 'A') : false;
 
-        rmc.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed RMC message");
-    } catch (const std::exception& e) {
-        rmc.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
-    }
+    rmc.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed RMC message"));
 
     data.type = MsgType::GNRMC;
-    data.data = serialize(rmc);
+    data.payload = rmc;
+    return true;
 }
 
 // Парсинг сообщения GNGGA
-void ParserNMEA::parseGNGGA(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNGGA(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNGGA";
     if (parts.size() < 15) {
-        throw std::invalid_argument("GNGGA requires at least 15 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNGGAData gga;
-    const QString msgType = "GNGGA";
 
-    try {
-        // 1. Время UTC
-        gga.time = parseTime(parts[1], msgType);
+    // 1. Время UTC
+    gga.time = parseTime(parts[1]);
 
-        // 2. Широта
-        gga.latitude = parseCoordinate(parts[2], parts[3], msgType);
+    // 2. Широта
+    gga.latitude = parseCoordinate(parts[2], parts[3], "Latitude");
 
-        // 3. Долгота
-        gga.longitude = parseCoordinate(parts[4], parts[5], msgType);
+    // 3. Долгота
+    gga.longitude = parseCoordinate(parts[4], parts[5], "Longitude");
 
-        // 4. Качество фиксации (преобразуем в CoordinateDefinition)
-        int fixQuality = parseInt(parts[6], "FixQuality", msgType);
-        if (fixQuality < 0 || fixQuality > 8) {
-            throw std::out_of_range("Invalid fix quality value");
-        }
-        gga.coordDef = static_cast<GNGGAData::CoordinateDefinition>(fixQuality);
-
-        // 5. Количество спутников
-        gga.satellitesCount = validateRange(
-            parseInt(parts[7], "Satellites", msgType), 0, 99, "Satellites", msgType
-            );
-
-        // 6. HDOP
-        gga.HDOP = static_cast<uint32_t>(
-            validateRange(parseDouble(parts[8], "HDOP", msgType), 0.0, 99.9, "HDOP", msgType) * 10
-            );
-
-        // 7. Высота и единицы измерения
-        if (!parts[9].isEmpty()) {
-            gga.altitude = parseDouble(parts[9], "Altitude", msgType);
-        } else {
-            gga.altitude = 0.0f;
-            logWarning(msgType, "Altitude field is empty, using default 0.0");
-        }
-        // Добавить проверку на inf/nan
-        if (std::isinf(gga.altitude) || std::isnan(gga.altitude)) {
-            gga.altitude = 0.0f;
-            logWarning(msgType, "Invalid altitude value, reset to 0.0");
-        }
-        gga.altUnit = (parts[10].toString() == "M") ?
-                          GNGGAData::METER : GNGGAData::FOOT;
-        qDebug()<<gga.altitude;
-        // 8. Разница геоида
-        gga.diffElipsoidSeaLevel = parseDouble(parts[11], "GeoidSep", msgType);
-        gga.diffElipsUnit = (parts[12].toString() == "M") ?
-                                GNGGAData::METER : GNGGAData::FOOT;
-
-        // 9. Время с последнего DGPS обновления
-        if (!parts[13].isEmpty()) {
-            gga.countSecDGPS = static_cast<uint32_t>(
-                parseDouble(parts[13], "DGPSAge", msgType) * 10
-                );
-        }
+    // 4. Качество фиксации (преобразуем в CoordinateDefinition)
+    int fixQuality = parseInt(parts[6], "FixQuality");
+    if (fixQuality < 0 || fixQuality > 8) {
+        return reject(ParseError::OutOfRange, "FixQuality");
+    }
+    gga.coordDef = static_cast<GNGGAData::CoordinateDefinition>(fixQuality);
 
-        // 10. ID станции DGPS
-        if (!parts[14].isEmpty()) {
-            gga.idDGPS = parseInt(parts[14], "DGPSId", msgType);
-        }
+    // 5. Количество спутников
+    gga.satellitesCount = validateRange(parseInt(parts[7], "Satellites"), 0, 99, "Satellites");
+
+    // 6. HDOP
+    gga.HDOP = static_cast<uint32_t>(
+        validateRange(parseDouble(parts[8], "HDOP"), 0.0, 99.9, "HDOP") * 10
+        );
 
-        gga.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed GGA message");
+    // 7. Высота и единицы измерения
+    if (!parts[9].isEmpty()) {
+        gga.altitude = parseDouble(parts[9], "Altitude");
+    } else {
+        gga.altitude = 0.0f;
+        repair("Altitude");
     }
-    catch (const std::exception& e) {
-        gga.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+    // Добавить проверку на inf/nan
+    if (std::isinf(gga.altitude) || std::isnan(gga.altitude)) {
+        gga.altitude = 0.0f;
+        repair("Altitude");
     }
+    gga.altUnit = (parts[10] == 'M') ?
+                      GNGGAData::METER : GNGGAData::FOOT;
+
+    // 8. Разница геоида
+    gga.diffElipsoidSeaLevel = parseDouble(parts[11], "GeoidSep");
+    gga.diffElipsUnit = (parts[12] == 'M') ?
+                            GNGGAData::METER : GNGGAData::FOOT;
+
+    // 9. Время с последнего DGPS обновления
+    if (!parts[13].isEmpty()) {
+        gga.countSecDGPS = static_cast<uint32_t>(parseDouble(parts[13], "DGPSAge") * 10);
+    }
+
+    // 10. ID станции DGPS
+    if (!parts[14].isEmpty()) {
+        gga.idDGPS = parseInt(parts[14], "DGPSId");
+    }
+
+    gga.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed GGA message"));
 
     data.type = MsgType::GNGGA;
-    data.data = serialize(gga);
+    data.payload = gga;
+    return true;
 }
 
 // Парсинг сообщения GNGSA
-void ParserNMEA::parseGNGSA(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNGSA(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNGSA";
     if (parts.size() < 18) {
-        throw std::invalid_argument("GNGSA requires at least 18 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNGSAData gsa;
-    const QString msgType = "GNGSA";
 
-    try {
-        // 1. Режим автоматического выбора
-        gsa.isAuto = (parts[1].toString() == "A");
+    // 1. Режим автоматического выбора
+    gsa.isAuto = (parts[1] == 'A');
 
-        // 2. Тип фиксации
-        int fixType = parseInt(parts[2], "FixType", msgType);
-        if (fixType < 0 || fixType > 3) {
-            throw std::out_of_range("Invalid fix type value");
-        }
-        gsa.typeFormat = static_cast<TypeFormat>(fixType);
+    // 2. Тип фиксации
+    int fixType = parseInt(parts[2], "FixType");
+    if (fixType < 0 || fixType > 3) {
+        return reject(ParseError::OutOfRange, "FixType");
+    }
+    gsa.typeFormat = static_cast<TypeFormat>(fixType);
 
-        // 3. Список используемых спутников
-        for (int i = 0; i < 12; ++i) {
-            QStringRef prn = parts[3 + i];
-            gsa.satellitesUsedId[i] = prn.isEmpty() ? 0 : prn.toInt();
-        }
+    // 3. Список используемых спутников
+    for (int i = 0; i < 12; ++i) {
+        const NmeaField &prn = parts[3 + i];
+        gsa.satellitesUsedId[i] = prn.isEmpty() ? 0 : prn.toInt();
+    }
 
-        // 4. Показатели точности
-        gsa.PDOP = static_cast<uint32_t>(
-            validateRange(parseDouble(parts[15], "PDOP", msgType), 0.0, 99.9, "PDOP", msgType) * 10
-            );
-        gsa.HDOP = static_cast<uint32_t>(
-            validateRange(parseDouble(parts[16], "HDOP", msgType), 0.0, 99.9, "HDOP", msgType) * 10
-            );
-        gsa.VDOP = static_cast<uint32_t>(
-            validateRange(parseDouble(parts[17], "VDOP", msgType), 0.0, 99.9, "VDOP", msgType) * 10
-            );
-
-        // 5. Тип навигационной системы (опциональное поле)
-        if (parts.size() > 18 && !parts[18].isEmpty()) {
-            int gnssType = parseInt(parts[18], "GNSS", msgType);
-            // В методе parseGNGSA:
-            if (gnssType < 0 || gnssType > 4) { // Добавить поддержку значения 4
-                logWarning(msgType, "Unknown GNSS type, using GPS");
-                gnssType = GNSS_GPS;
-            }
-            gsa.typeGNSS = static_cast<TypeGNSS>(gnssType);
-        }
+    // 4. Показатели точности
+    gsa.PDOP = static_cast<uint32_t>(
+        validateRange(parseDouble(parts[15], "PDOP"), 0.0, 99.9, "PDOP") * 10
+        );
+    gsa.HDOP = static_cast<uint32_t>(
+        validateRange(parseDouble(parts[16], "HDOP"), 0.0, 99.9, "HDOP") * 10
+        );
+    gsa.VDOP = static_cast<uint32_t>(
+        validateRange(parseDouble(parts[17], "VDOP"), 0.0, 99.9, "VDOP") * 10
+        );
 
-        gsa.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed GSA message");
-    }
-    catch (const std::exception& e) {
-        gsa.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+    // 5. Тип навигационной системы (опциональное поле)
+    if (parts.size() > 18 && !parts[18].isEmpty()) {
+        int gnssType = parseInt(parts[18], "GNSS");
+        if (gnssType < 0 || gnssType > 4) {
+            // Неизвестная система — считаем GPS
+            repair("GNSS");
+            gnssType = GNSS_GPS;
+        }
+        gsa.typeGNSS = static_cast<TypeGNSS>(gnssType);
     }
 
+    gsa.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed GSA message"));
+
     data.type = MsgType::GNGSA;
-    data.data = serialize(gsa);
+    data.payload = gsa;
+    return true;
 }
 
 // Парсинг сообщения GNZDA
-void ParserNMEA::parseGNZDA(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNZDA(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNZDA";
     if (parts.size() < 7) {
-        throw std::invalid_argument("GNZDA requires at least 7 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNZDAData zda;
-    const QString msgType = "GNZDA";
 
-    try {
-        // 1. Парсинг времени
-        zda.time = parseTime(parts[1], msgType);
+    // 1. Парсинг времени
+    zda.time = parseTime(parts[1]);
 
-        // 2. Парсинг даты
-        zda.date = parseDate(parts[2], parts[3], parts[4], msgType);
+    // 2. Парсинг даты
+    zda.date = parseDate(parts[2], parts[3], parts[4]);
 
-        // 3. Локальный временной сдвиг
-        int hours = 0;
-        int minutes = 0;
+    // 3. Локальный временной сдвиг
+    int hours = 0;
+    int minutes = 0;
 
-        if (!parts[5].isEmpty()) {
-            hours = parseInt(parts[5], "LocalHours", msgType);
-        }
+    if (!parts[5].isEmpty()) {
+        hours = parseInt(parts[5], "LocalHours");
+    }
 
-        if (!parts[6].isEmpty()) {
-            minutes = parseInt(parts[6], "LocalMinutes", msgType);
-        }
+    if (!parts[6].isEmpty()) {
+        minutes = parseInt(parts[6], "LocalMinutes");
+    }
 
-        // Проверка корректности значений
-        hours = qBound(-23, hours, 23);
-        minutes = qBound(0, minutes, 59);
+    // Проверка корректности значений
+    hours = qBound(-23, hours, 23);
+    minutes = qBound(0, minutes, 59);
 
-        // Сохраняем как количество минут смещения
-        zda.localOffset = static_cast<uint32_t>((hours * 60) + minutes);
-        //qDebug() << zda.time << zda.date << zda.localOffset;
+    // Сохраняем как количество минут смещения
+    zda.localOffset = static_cast<uint32_t>((hours * 60) + minutes);
 
-        zda.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed ZDA message");
-    }
-    catch (const std::exception& e) {
-        zda.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
-    }
+    zda.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed ZDA message"));
 
     data.type = MsgType::GNZDA;
-    data.data = serialize(zda);
+    data.payload = zda;
+    return true;
 }
 
 // Парсинг сообщения GNDHV
-void ParserNMEA::parseGNDHV(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNDHV(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNDHV";
     if (parts.size() < 7) {
-        throw std::invalid_argument("GNDHV requires at least 7 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNDHVData dhv;
-    const QString msgType = "GNDHV";
-
-    try {
-        // 1. Парсинг времени
-        dhv.time = parseTime(parts[1], msgType);
-
-        // 2. Скорость 3D
-        dhv.speed3D = validateRange(
-            parseDouble(parts[2], "Speed3D", msgType), 0.0, 9999.9, "Speed3D", msgType
-            );
-
-        // 3. Скорости по осям ECEF
-        dhv.speedECEF_X = parseDouble(parts[3], "SpeedX", msgType);
-        dhv.speedECEF_Y = parseDouble(parts[4], "SpeedY", msgType);
-        dhv.speedECEF_Z = parseDouble(parts[5], "SpeedZ", msgType);
-
-        // 4. Общая скорость
-        dhv.speed = validateRange(
-            parseDouble(parts[6], "Speed", msgType), 0.0, 9999.9, "Speed", msgType
-            );
-
-        // 5. Проверка согласованности данных
-        if (std::abs(dhv.speed3D - std::hypot(dhv.speedECEF_X, dhv.speedECEF_Y, dhv.speedECEF_Z)) > 0.1) {
-            logWarning(msgType, "3D speed mismatch with ECEF components");
-        }
 
-        dhv.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed DHV message");
-    }
-    catch (const std::exception& e) {
-        dhv.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+    // 1. Парсинг времени
+    dhv.time = parseTime(parts[1]);
+
+    // 2. Скорость 3D
+    dhv.speed3D = validateRange(parseDouble(parts[2], "Speed3D"), 0.0, 9999.9, "Speed3D");
+
+    // 3. Скорости по осям ECEF
+    dhv.speedECEF_X = parseDouble(parts[3], "SpeedX");
+    dhv.speedECEF_Y = parseDouble(parts[4], "SpeedY");
+    dhv.speedECEF_Z = parseDouble(parts[5], "SpeedZ");
+
+    // 4. Общая скорость
+    dhv.speed = validateRange(parseDouble(parts[6], "Speed"), 0.0, 9999.9, "Speed");
+
+    // 5. Проверка согласованности данных
+    if (std::abs(dhv.speed3D - std::hypot(dhv.speedECEF_X, dhv.speedECEF_Y, dhv.speedECEF_Z)) > 0.1) {
+        logDebug(m_sentence, QStringLiteral("3D speed mismatch with ECEF components"));
     }
 
+    dhv.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed DHV message"));
+
     data.type = MsgType::GNDHV;
-    data.data = serialize(dhv);
+    data.payload = dhv;
+    return true;
 }
 
 // Парсинг сообщения GNGST
-void ParserNMEA::parseGNGST(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNGST(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNGST";
     if (parts.size() < 9) {
-        throw std::invalid_argument("GNGST requires at least 9 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNGSTData gst;
-    const QString msgType = "GNGST";
-
-    try {
-        // 1. Парсинг времени
-        gst.time = parseTime(parts[1], msgType);
-
-        // 2. RMS стандартной девиации
-        gst.rms = validateNonNegative(
-            parseDouble(parts[2], "RMS", msgType), "RMS", msgType
-            );
-
-        // 3. Ошибки эллипса
-        gst.semiMajorError = validateNonNegative(
-            parseDouble(parts[3], "SemiMajor", msgType), "SemiMajor", msgType
-            );
-        gst.semiMinorError = validateNonNegative(
-            parseDouble(parts[4], "SemiMinor", msgType), "SemiMinor", msgType
-            );
-        gst.semiMajorOrientation = validateAngle(
-            parseDouble(parts[5], "Orientation", msgType), "Orientation", msgType
-            );
-
-        // 4. Ошибки координат
-        gst.latitudeError = validateNonNegative(
-            parseDouble(parts[6], "LatError", msgType), "LatError", msgType
-            );
-        gst.longitudeError = validateNonNegative(
-            parseDouble(parts[7], "LonError", msgType), "LonError", msgType
-            );
-        gst.altitudeError = validateNonNegative(
-            parseDouble(parts[8], "AltError", msgType), "AltError", msgType
-            );
-
-        // 5. Дополнительная проверка согласованности
-        if (gst.semiMajorError < gst.semiMinorError) {
-            logWarning(msgType, "Major axis smaller than minor axis - possible data corruption");
-        }
 
-        gst.result = ParseResult::OK;
-        logInfo(msgType, "Successfully parsed GST message");
+    // 1. Парсинг времени
+    gst.time = parseTime(parts[1]);
+
+    // 2. RMS стандартной девиации
+    gst.rms = parseDouble(parts[2], "RMS");
+
+    // 3. Ошибки эллипса
+    gst.semiMajorError = parseDouble(parts[3], "SemiMajor");
+    gst.semiMinorError = parseDouble(parts[4], "SemiMinor");
+    gst.semiMajorOrientation = parseDouble(parts[5], "Orientation");
+
+    // 4. Ошибки координат
+    gst.latitudeError = parseDouble(parts[6], "LatError");
+    gst.longitudeError = parseDouble(parts[7], "LonError");
+    gst.altitudeError = parseDouble(parts[8], "AltError");
+
+    if (!validateNonNegative(gst.rms, "RMS")
+        || !validateNonNegative(gst.semiMajorError, "SemiMajor")
+        || !validateNonNegative(gst.semiMinorError, "SemiMinor")
+        || !validateAngle(gst.semiMajorOrientation, "Orientation")
+        || !validateNonNegative(gst.latitudeError, "LatError")
+        || !validateNonNegative(gst.longitudeError, "LonError")
+        || !validateNonNegative(gst.altitudeError, "AltError")) {
+        return false;
     }
-    catch (const std::exception& e) {
-        gst.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+
+    // 5. Дополнительная проверка согласованности
+    if (gst.semiMajorError < gst.semiMinorError) {
+        logDebug(m_sentence, QStringLiteral("Major axis smaller than minor axis - possible data corruption"));
     }
 
+    gst.result = ParseResult::OK;
+    logDebug(m_sentence, QStringLiteral("Successfully parsed GST message"));
+
     data.type = MsgType::GNGST;
-    data.data = serialize(gst);
+    data.payload = gst;
+    return true;
 }
 
-// В файл parsernmea.cpp добавить:
-
 // Парсинг сообщения GPTXT
-void ParserNMEA::parseGPTXT(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGPTXT(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GPTXT";
     if (parts.size() < 5) {
-        throw std::invalid_argument("GPTXT requires at least 5 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GPTXTData txt;
-    const QString msgType = "GPTXT";
 
-    try {
-        // 1. Количество сообщений
-        txt.messageCount = parseInt(parts[1], "TotalMsgs", msgType);
+    // 1. Количество сообщений
+    txt.messageCount = parseInt(parts[1], "TotalMsgs");
 
-        // 2. Номер текущего сообщения
-        txt.messageNumber = parseInt(parts[2], "MsgNum", msgType);
+    // 2. Номер текущего сообщения
+    txt.messageNumber = parseInt(parts[2], "MsgNum");
 
-        // 3. Тип сообщения
-        txt.messageType = parseInt(parts[3], "MsgType", msgType);
+    // 3. Тип сообщения
+    txt.messageType = parseInt(parts[3], "MsgType");
 
-        // 4. Текстовое сообщение
-        txt.message = parts[4].toString();
+    // 4. Проверка согласованности
+    if (txt.messageNumber < 1 || txt.messageNumber > txt.messageCount) {
+        return reject(ParseError::OutOfRange, "MsgNum");
+    }
 
-        // 5. Проверка согласованности
-        if (txt.messageNumber < 1 || txt.messageNumber > txt.messageCount) {
-            throw std::out_of_range("Message number out of range");
-        }
+    // 5. Текстовое сообщение
+    txt.message = QString::fromLatin1(parts[4].data, parts[4].size);
 
-        txt.result = ParseResult::OK;
-        logInfo(msgType, QString("Parsed text message %1/%2: %3")
-                             .arg(txt.messageNumber)
-                             .arg(txt.messageCount)
-                             .arg(txt.message.left(50)));
-    }
-    catch (const std::exception& e) {
-        txt.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+    txt.result = ParseResult::OK;
+    if (debugEnabled()) {
+        logDebug(m_sentence, QString("Parsed text message %1/%2: %3")
+                                 .arg(txt.messageNumber)
+                                 .arg(txt.messageCount)
+                                 .arg(txt.message.left(50)));
     }
 
     data.type = MsgType::GPTXT;
-    data.data = serialize(txt);
+    data.payload = txt;
+    return true;
 }
 
 // Парсинг сообщения GNGLL
-void ParserNMEA::parseGNGLL(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNGLL(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNGLL";
     if (parts.size() < 7) {
-        throw std::invalid_argument("GNGLL requires at least 7 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNGLLData gll;
-    const QString msgType = "GNGLL";
-
-    try {
-        // 1. Парсинг координат
-        gll.latitude = parseCoordinate(parts[1], parts[2], msgType);
-        gll.longitude = parseCoordinate(parts[3], parts[4], msgType);
-
-        // 2. Парсинг времени
-        gll.time = parseTime(parts[5], msgType);
-
-        // 3. Статус валидности
-        QString status = parts[6].toString();
-        if (status == "A") {
-            gll.isValid = true;
-        } else if (status == "V") {
-            gll.isValid = false;
-        } else {
-            throw std::invalid_argument("Invalid data status");
-        }
 
-        // 4. Дополнительная проверка (опциональные поля)
-        if (parts.size() > 7) {
-            QString mode = parts[7].toString();
-            if (!mode.isEmpty() && mode != "A" && mode != "D" && mode != "E" && mode != "N" && mode != "S") {
-                logWarning(msgType, "Invalid mode indicator");
-            }
-        }
+    // 1. Парсинг координат
+    gll.latitude = parseCoordinate(parts[1], parts[2], "Latitude");
+    gll.longitude = parseCoordinate(parts[3], parts[4], "Longitude");
 
-        gll.result = ParseResult::OK;
-        logInfo(msgType, QString("Parsed position: %1, %2")
-                             .arg(gll.latitude, 0, 'f', 6)
-                             .arg(gll.longitude, 0, 'f', 6));
+    // 2. Парсинг времени
+    gll.time = parseTime(parts[5]);
+
+    // 3. Статус валидности
+    const NmeaField &status = parts[6];
+    if (status == 'A') {
+        gll.isValid = true;
+    } else if (status == 'V') {
+        gll.isValid = false;
+    } else {
+        return reject(ParseError::BadField, "Status");
     }
-    catch (const std::exception& e) {
-        gll.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+
+    // 4. Дополнительная проверка (опциональные поля)
+    if (parts.size() > 7) {
+        const NmeaField &mode = parts[7];
+        if (!mode.isEmpty() && mode != 'A' && mode != 'D' && mode != 'E' && mode != 'N' && mode != 'S') {
+            repair("Mode");
+        }
+    }
+
+    gll.result = ParseResult::OK;
+    if (debugEnabled()) {
+        logDebug(m_sentence, QString("Parsed position: %1, %2")
+                                 .arg(gll.latitude, 0, 'f', 6)
+                                 .arg(gll.longitude, 0, 'f', 6));
     }
 
     data.type = MsgType::GNGLL;
-    data.data = serialize(gll);
+    data.payload = gll;
+    return true;
 }
 
 // Парсинг сообщения GLGSV
-void ParserNMEA::parseGLGSV(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGLGSV(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GLGSV";
     if (parts.size() < 4) {
-        throw std::invalid_argument("GLGSV requires at least 4 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GLGSVData gsv;
-    const QString msgType = "GLGSV";
-
-    try {
-        // 1. Общая информация
-        gsv.totalMessages = parseInt(parts[1], "TotalMsgs", msgType);
-        gsv.messageNumber = parseInt(parts[2], "MsgNum", msgType);
-        gsv.satellitesCount = parseInt(parts[3], "Satellites", msgType);
 
-        // 2. Проверка согласованности
-        if (gsv.messageNumber < 1 || gsv.messageNumber > gsv.totalMessages) {
-            throw std::out_of_range("Message number out of range");
-        }
+    // 1. Общая информация
+    gsv.totalMessages = parseInt(parts[1], "TotalMsgs");
+    gsv.messageNumber = parseInt(parts[2], "MsgNum");
+    gsv.satellitesCount = parseInt(parts[3], "Satellites");
 
-        // 3. Парсинг данных спутников
-        int satDataFields = (parts.size() - 4) / 4;
-        for (int i = 0; i < satDataFields; ++i) {
-            int idx = 4 + i * 4;
+    // 2. Проверка согласованности
+    if (gsv.messageNumber < 1 || gsv.messageNumber > gsv.totalMessages) {
+        return reject(ParseError::OutOfRange, "MsgNum");
+    }
 
-            SatelliteInfo info;
-            info.prn = parseInt(parts[idx], "PRN", msgType);
-            info.elevation = parseDouble(parts[idx+1], "Elevation", msgType);
-            info.azimuth = parseDouble(parts[idx+2], "Azimuth", msgType);
-            info.snr = parts.size() > idx+3 ?
-                           parseDouble(parts[idx+3], "SNR", msgType) : 0.0;
+    // 3. Парсинг данных спутников
+    int satDataFields = (parts.size() - 4) / 4;
+    if (satDataFields > GLGSVData::MaxSatellitesPerMessage) {
+        return reject(ParseError::TooManyFields, "Satellites");
+    }
+    for (int i = 0; i < satDataFields; ++i) {
+        int idx = 4 + i * 4;
 
-            // Проверка допустимых значений
-            info.elevation = validateRange(info.elevation, 0.0, 90.0, "Elevation", msgType);
-            info.azimuth = validateAngle(info.azimuth, "Azimuth", msgType);
-            info.snr = validateRange(info.snr, 0.0, 99.0, "SNR", msgType);
+        SatelliteInfo info;
+        info.prn = parseInt(parts[idx], "PRN");
+        info.elevation = parseDouble(parts[idx+1], "Elevation");
+        info.azimuth = parseDouble(parts[idx+2], "Azimuth");
+        info.snr = parts.size() > idx+3 ?
+                       parseDouble(parts[idx+3], "SNR") : 0.0;
 
-            gsv.satelliteData.append(info);
+        // Проверка допустимых значений
+        info.elevation = validateRange(info.elevation, 0.0, 90.0, "Elevation");
+        if (!validateAngle(info.azimuth, "Azimuth")) {
+            return false;
         }
+        info.snr = validateRange(info.snr, 0.0, 99.0, "SNR");
 
-        // 4. Проверка общего количества спутников
-        if (gsv.messageNumber == gsv.totalMessages &&
-            gsv.satellitesCount != gsv.satelliteData.size()) {
-            logWarning(msgType, "Satellite count mismatch");
-        }
+        gsv.satelliteData[gsv.satelliteDataCount++] = info;
+    }
 
-        gsv.result = ParseResult::OK;
-        logInfo(msgType, QString("Parsed %1 satellites in message %2/%3")
-                             .arg(gsv.satelliteData.size())
-                             .arg(gsv.messageNumber)
-                             .arg(gsv.totalMessages));
+    // 4. Проверка общего количества спутников
+    if (gsv.messageNumber == gsv.totalMessages &&
+        gsv.satellitesCount != gsv.satelliteDataCount) {
+        logDebug(m_sentence, QStringLiteral("Satellite count mismatch"));
     }
-    catch (const std::exception& e) {
-        gsv.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+
+    gsv.result = ParseResult::OK;
+    if (debugEnabled()) {
+        logDebug(m_sentence, QString("Parsed %1 satellites in message %2/%3")
+                                 .arg(gsv.satelliteDataCount)
+                                 .arg(gsv.messageNumber)
+                                 .arg(gsv.totalMessages));
     }
 
     data.type = MsgType::GLGSV;
-    data.data = serialize(gsv);
+    data.payload = gsv;
+    return true;
 }
 
 // Парсинг сообщения GNVTG
-void ParserNMEA::parseGNVTG(const QVector<QStringRef>& parts, NavigationData& data)
+bool ParserNMEA::parseGNVTG(const NmeaFields &parts, NavigationData& data)
 {
+    m_sentence = "GNVTG";
     if (parts.size() < 9) {
-        throw std::invalid_argument("GNVTG requires at least 9 fields");
+        return reject(ParseError::MissingFields);
     }
 
     GNVTGData vtg;
-    const QString msgType = "GNVTG";
-
-    try {
-        // 1. Парсинг курсов
-        vtg.trueCourse = validateAngle(
-            parseDouble(parts[1], "TrueCourse", msgType),
-            "TrueCourse",
-            msgType
-            );
-
-        vtg.magneticCourse = validateAngle(
-            parseDouble(parts[3], "MagneticCourse", msgType),
-            "MagneticCourse",
-            msgType
-            );
-
-        // 2. Парсинг скоростей
-        vtg.speedKnots = validateRange(
-            parseDouble(parts[5], "SpeedKnots", msgType),
-            0.0,
-            999.9,
-            "SpeedKnots",
-            msgType
-            );
-
-        vtg.speedKmh = validateRange(
-            parseDouble(parts[7], "SpeedKmh", msgType),
-            0.0,
-            9999.9,
-            "SpeedKmh",
-            msgType
-            );
-
-        // 3. Проверка валидности данных
-        QString mode = parts.size() > 8 ? parts[8].toString() : "";
-        vtg.isValid = (mode == "A"); // A - Autonomous mode
-
-        // 4. Дополнительная проверка согласованности
-        double convertedKnots = vtg.speedKmh / 1.852;
-        if (std::abs(vtg.speedKnots - convertedKnots) > 0.1) {
-            logWarning(msgType, "Speed units mismatch");
-        }
 
-        vtg.result =ParseResult::OK;
-        logInfo(msgType, QString("Parsed course %1°, speed %2 knots")
-                             .arg(vtg.trueCourse, 0, 'f', 1)
-                             .arg(vtg.speedKnots, 0, 'f', 1));
+    // 1. Парсинг курсов
+    vtg.trueCourse = parseDouble(parts[1], "TrueCourse");
+    vtg.magneticCourse = parseDouble(parts[3], "MagneticCourse");
+    if (!validateAngle(vtg.trueCourse, "TrueCourse")
+        || !validateAngle(vtg.magneticCourse, "MagneticCourse")) {
+        return false;
     }
-    catch (const std::exception& e) {
-        vtg.result = ParseResult::ERROR;
-        logError(msgType, QString("Parse error: %1").arg(e.what()));
-        throw;
+
+    // 2. Парсинг скоростей
+    vtg.speedKnots = validateRange(parseDouble(parts[5], "SpeedKnots"), 0.0, 999.9, "SpeedKnots");
+    vtg.speedKmh = validateRange(parseDouble(parts[7], "SpeedKmh"), 0.0, 9999.9, "SpeedKmh");
+
+    // 3. Проверка валидности данных
+    vtg.isValid = parts.size() > 8 && parts[8] == 'A'; // A - Autonomous mode
+
+    // 4. Дополнительная проверка согласованности
+    double convertedKnots = vtg.speedKmh / KNOTS_TO_KMH;
+    if (std::abs(vtg.speedKnots - convertedKnots) > 0.1) {
+        logDebug(m_sentence, QStringLiteral("Speed units mismatch"));
+    }
+
+    vtg.result =ParseResult::OK;
+    if (debugEnabled()) {
+        logDebug(m_sentence, QString("Parsed course %1°, speed %2 knots")
+                                 .arg(vtg.trueCourse, 0, 'f', 1)
+                                 .arg(vtg.speedKnots, 0, 'f', 1));
     }
 
     data.type = MsgType::GNVTG;
-    data.data = serialize(vtg);
+    data.payload = vtg;
+    return true;
 }
 
-QTime ParserNMEA::parseTime(const QStringRef &ref, const QString &msgType) const
+QTime ParserNMEA::parseTime(const NmeaField &ref)
 {
-    if (ref .length() < 6) {
-        logError(msgType, "Invalid time format");
+    int32_t msecs;
+    if (!ref.toTimeMs(msecs)) {
+        repair("Time");
         return QTime();
     }
-
-    return QTime(
-        ref.mid(0, 2).toInt(),
-        ref.mid(2, 2).toInt(),
-        ref.mid(4, 2).toInt(),
-        ref.length() > 6 ? ref.mid(6).toInt() * 10 : 0
-        );
+    return QTime::fromMSecsSinceStartOfDay(msecs);
 }
 
-QDate ParserNMEA::parseDate(const QStringRef& dayRef,
-                            const QStringRef& monthRef,
-                            const QStringRef& yearRef,
-                            const QString& msgType) const
+QDate ParserNMEA::parseDate(const NmeaField &dayRef,
+                            const NmeaField &monthRef,
+                            const NmeaField &yearRef)
 {
     bool ok;
     int day = dayRef.toInt(&ok);
     if (!ok || day < 1 || day > 31) {
-        logError(msgType, "Invalid day value");
+        repair("Day");
         return QDate();
     }
 
     int month = monthRef.toInt(&ok);
     if (!ok || month < 1 || month > 12) {
-        logError(msgType, "Invalid month value");
+        repair("Month");
         return QDate();
     }
 
     int year = yearRef.toInt(&ok);
     if (!ok || year < 1970 || year > 2100) {
-        logError(msgType, "Invalid year value");
+        repair("Year");
         return QDate();
     }
 
     return QDate(year, month, day);
 }
 
-QDate ParserNMEA::parseDate(const QStringRef &ref, const QString& msgType) const {
-    if (ref.length() != 6) {
-        logError(msgType, "Invalid date format, expected 6 characters");
-        return QDate(); // Возвращаем пустую дату в случае ошибки
-    }
-
-    // Извлечение дня, месяца и года
-    int day = ref.mid(0, 2).toInt();
-    int month = ref.mid(2, 2).toInt();
-    int year = ref.mid(4, 2).toInt() + 2000; // Предполагаем, что год в формате YY
-
-    // Проверка на корректность значений
-    if (day < 1 || day > 31 || month < 1 || month > 12) {
-        logError(msgType, QString("Invalid day (%1) or month (%2)").arg(day).arg(month));
-        return QDate(); // Возвращаем пустую дату в случае ошибки
+QDate ParserNMEA::parseDate(const NmeaField &ref) {
+    int day;
+    int month;
+    int year;
+    if (!ref.toDate(day, month, year)) {
+        repair("Date");
+        return QDate();
     }
 
-    // Создание объекта QDate
+    // Проверка дня для конкретного месяца (31 апреля и т.п.)
     QDate date(year, month, day);
     if (!date.isValid()) {
-        logError(msgType, "Constructed date is invalid");
-        return QDate(); // Возвращаем пустую дату в случае ошибки
-    }
-
-    return date; // Возвращаем валидную дату
-}
-
-QTime ParserNMEA::parseTimeWithMilliseconds(const QStringRef& timeRef, const QString& msgType) const
-{
-    if (timeRef.length() < 6) {
-        logError(msgType, "Invalid time format");
-        return QTime();
-    }
-
-    QString timeStr = timeRef.toString();
-    timeStr.replace('.', ':');
-
-    QStringList parts = timeStr.split(':');
-    if (parts.size() < 3) {
-        logError(msgType, "Time format missing milliseconds");
-        return QTime();
-    }
-
-    bool ok;
-    int hours = parts[0].left(2).toInt(&ok);
-    if (!ok || hours < 0 || hours > 23) {
-        logError(msgType, "Invalid hours in time");
-        return QTime();
-    }
-
-    int minutes = parts[0].mid(2, 2).toInt(&ok);
-    if (!ok || minutes < 0 || minutes > 59) {
-        logError(msgType, "Invalid minutes in time");
-        return QTime();
-    }
-
-    int seconds = parts[1].left(2).toInt(&ok);
-    if (!ok || seconds < 0 || seconds > 59) {
-        logError(msgType, "Invalid seconds in time");
-        return QTime();
-    }
-
-    int msec = parts[2].left(2).toInt(&ok);
-    if (!ok || msec < 0 || msec > 99) {
-        logError(msgType, "Invalid milliseconds in time");
-        return QTime();
+        repair("Date");
+        return QDate();
     }
-
-    return QTime(hours, minutes, seconds, msec);
+    return date;
 }
 
-double ParserNMEA::parseDouble(const QStringRef& ref,
-                               const QString& fieldName,
-                               const QString& msgType) const
+double ParserNMEA::parseDouble(const NmeaField &ref, const char *fieldName)
 {
     bool ok;
     double value = ref.toDouble(&ok);
     if (!ok) {
-        logError(msgType, QString("Invalid double value for %1").arg(fieldName));
+        repair(fieldName);
         return 0.0;
     }
     return value;
 }
 
-int ParserNMEA::parseInt(const QStringRef& ref,
-                         const QString& fieldName,
-                         const QString& msgType) const
+int ParserNMEA::parseInt(const NmeaField &ref, const char *fieldName)
 {
     bool ok;
     int value = ref.toInt(&ok);
     if (!ok) {
-        logError(msgType, QString("Invalid integer value for %1").arg(fieldName));
+        repair(fieldName);
         return 0;
     }
     return value;
 }
 
-QString ParserNMEA::parseString(const QStringRef &ref, const QString &fieldName, const QString &msgType) const
-{
-    if (ref.isEmpty()) {
-        logError(msgType, QString("Empty value for %1").arg(fieldName));
-        return QString();
-    }
-    return ref.toString();
-}
-
-double ParserNMEA::parseCoordinate(const QStringRef& coord,
-                                   const QStringRef& dir,
-                                   const QString& msgType) const
+double ParserNMEA::parseCoordinate(const NmeaField &coord,
+                                   const NmeaField &dir,
+                                   const char *fieldName)
 {
-    if (coord.isEmpty() || dir.isEmpty()) {
-        logError(msgType, "Empty coordinate field");
+    double degrees;
+    if (dir.isEmpty() || !coord.toCoordinate(dir.at(0), degrees)) {
+        repair(fieldName);
         return 0.0;
     }
-
-    bool ok;
-    double value = coord.toDouble(&ok);
-    if (!ok) {
-        logError(msgType, "Invalid coordinate format");
-        return 0.0;
-    }
-
-    double degrees = static_cast<int>(value / 100);
-    double minutes = value - degrees * 100;
-    double result = degrees + minutes / 60.0;
-
-    if (dir == "S" || dir == "W") {
-        result *= -1;
-    }
-
-    return result;
+    return degrees;
 }
 
-double ParserNMEA::validateRange(double value, double min, double max,
-                                 const QString& field, const QString& context) const
+double ParserNMEA::validateRange(double value, double min, double max, const char *fieldName)
 {
     if (value < min || value > max) {
-        logError(context, QString("Value %1 out of range [%2-%3] for %4")
-                              .arg(value).arg(min).arg(max).arg(field));
+        repair(fieldName);
         return qBound(min, value, max);
     }
     return value;
 }
 
-int ParserNMEA::validateRange(int value, int min, int max, const QString &fieldName, const QString &msgType) const
+int ParserNMEA::validateRange(int value, int min, int max, const char *fieldName)
 {
     if (value < min || value > max) {
-        logError(msgType, QString("Value out of range for %1: %2").arg(fieldName).arg(value));
+        repair(fieldName);
     }
     return qBound(min, value, max);
 }
 
-double ParserNMEA::validateAngle(double degrees,
-                                 const QString& field,
-                                 const QString& context) const
+bool ParserNMEA::validateAngle(double &degrees, const char *fieldName)
 {
-    degrees = fmod(degrees, 360.0);
+    degrees = std::fmod(degrees, 360.0);
     if (degrees < 0.0) degrees += 360.0;
 
-    if (degrees < 0.0 || degrees >= 360.0) {
-        logError(context, QString("Invalid angle %1 for %2").arg(degrees).arg(field));
-        throw std::out_of_range("Angle out of valid range");
+    // NaN и бесконечность fmod не исправит
+    if (!(degrees >= 0.0 && degrees < 360.0)) {
+        return reject(ParseError::OutOfRange, fieldName);
     }
-    return degrees;
+    return true;
 }
 
-double ParserNMEA::validateNonNegative(double value,
-                                       const QString& field,
-                                       const QString& context) const
+bool ParserNMEA::validateNonNegative(double value, const char *fieldName)
 {
     if (value < 0.0) {
-        logError(context, QString("Negative value %1 for %2").arg(value).arg(field));
-        throw std::out_of_range("Negative value not allowed");
+        return reject(ParseError::OutOfRange, fieldName);
     }
-    return value;
-}
-
-QByteArray ParserNMEA::serialize(const GNRMCData &data) {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    try {
-        stream << data.time
-               << data.isValid
-               << data.latitude
-               << data.longitude
-               << data.speed
-               << data.course
-               << data.date
-               << data.magnDeviation
-               << static_cast<int>(data.coordinateDefinition)
-               << data.statusNav;
-    } catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GNRMC serialization failed: %1").arg(e.what()));
-        return QByteArray();
-    }
-    return buffer;
-}
-
-QByteArray ParserNMEA::serialize(const GNGGAData& data)
-{
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-
-    // Записываем каждое поле с проверкой
-    try {
-        stream << data.time
-               << data.latitude
-               << data.longitude
-               << static_cast<int>(data.coordDef)
-               << data.satellitesCount
-               << data.HDOP
-               << data.altitude  // Записывается как double
-               << (data.altUnit == GNGGAData::METER ? "M" : "F")
-               << data.diffElipsoidSeaLevel
-               << (data.diffElipsUnit == GNGGAData::METER ? "M" : "F")
-               << static_cast<double>(data.countSecDGPS) / 10.0
-               << data.idDGPS;
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GGA serialization failed: %1").arg(e.what()));
-        return QByteArray();
-    }
-
-    return buffer;
+    return true;
 }
 
-QByteArray ParserNMEA::serialize(const GNGSAData& data)
+bool ParserNMEA::reject(ParseError error, const char *fieldName)
 {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-
-    try {
-        // Записываем основные поля
-        stream << data.isAuto
-               << static_cast<int>(data.typeFormat);
+    ++m_errorCounts[static_cast<int>(error)];
 
-        // Записываем массив спутников
-        for (int i = 0; i < 12; ++i) {
-            stream << data.satellitesUsedId[i];
-        }
-
-        // Записываем DOP значения
-        stream << static_cast<double>(data.PDOP) / 10.0
-               << static_cast<double>(data.HDOP) / 10.0
-               << static_cast<double>(data.VDOP) / 10.0
-               << static_cast<int>(data.typeGNSS);
+    // Только запоминаем контекст; текст соберет lastErrorMessage()
+    m_lastError = error;
+    m_lastSentence = m_sentence;
+    m_lastField = fieldName;
+    m_lastLineLength = qBound(0, m_lineLength, static_cast<int>(sizeof(m_lastLine)));
+    if (m_lastLineLength > 0) {
+        std::memcpy(m_lastLine, m_line, static_cast<size_t>(m_lastLineLength));
     }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GSA serialization failed: %1").arg(e.what()));
-        return QByteArray();
-    }
-
-    return buffer;
-}
-
-QByteArray ParserNMEA::serialize(const GNZDAData& data)
-{
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
 
-    try {
-        // Записываем время с миллисекундами
-        stream << data.time;
-
-        // Записываем дату
-        stream << data.date;
-
-        // Распаковываем временное смещение
-        int hours = static_cast<int>(data.localOffset) / 60;
-        int minutes = static_cast<int>(data.localOffset) % 60;
-
-        stream << data.localOffset;
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("ZDA serialization failed: %1").arg(e.what()));
-        return QByteArray();
+    if (debugEnabled()) {
+        m_logger->log(Logger::Debug, lastErrorMessage());
     }
-
-    return buffer;
+    return false;
 }
 
-QByteArray ParserNMEA::serialize(const GNDHVData& data)
+void ParserNMEA::repair(const char *fieldName)
 {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-
-    try {
-        // Записываем время
-        stream << data.time.toString("HHmmss.zzz");
-
-        // Записываем скорости
-        stream << data.speed3D
-               << data.speedECEF_X
-               << data.speedECEF_Y
-               << data.speedECEF_Z
-               << data.speed;
+    ++m_repairedFields;
+    if (debugEnabled()) {
+        logDebug(m_sentence ? m_sentence : "PARSE",
+                 QString("Field %1 replaced with default").arg(QLatin1String(fieldName)));
     }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("DHV serialization failed: %1").arg(e.what()));
-        return QByteArray();
-    }
-
-    return buffer;
 }
 
-QByteArray ParserNMEA::serialize(const GNGSTData& data)
+QString ParserNMEA::lastErrorMessage() const
 {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
-
-    try {
-        // Записываем время с миллисекундами
-        stream << data.time.toString("HHmmss.zzz");
-
-        // Записываем значения ошибок
-        stream << data.rms
-               << data.semiMajorError
-               << data.semiMinorError
-               << data.semiMajorOrientation
-               << data.latitudeError
-               << data.longitudeError
-               << data.altitudeError;
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GST serialization failed: %1").arg(e.what()));
-        return QByteArray();
-    }
-
-    return buffer;
-}
-
-QByteArray ParserNMEA::serialize(const GLGSVData& data) {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
-
-    try {
-        stream << data.totalMessages
-               << data.messageNumber
-               << data.satellitesCount;
-
-        stream << static_cast<int>(data.satelliteData.size());
-        for (const auto& sat : data.satelliteData) {
-            stream << sat.prn
-                   << sat.elevation
-                   << sat.azimuth
-                   << sat.snr;
-        }
-    } catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GLGSV serialization failed: %1").arg(e.what()));
-        return QByteArray();
+    if (m_lastError == ParseError::None) {
+        return QString();
     }
 
-    return buffer;
-}
-
-QByteArray ParserNMEA::serialize(const GPTXTData& data)
-{
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    stream.setVersion(QDataStream::Qt_5_13);
-
-    try {
-        stream << data.messageCount
-               << data.messageNumber
-               << data.messageType
-               << data.message;
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GPTXT serialization failed: %1").arg(e.what()));
-        return QByteArray();
+    QString message = QString("[%1] %2")
+                          .arg(QLatin1String(m_lastSentence ? m_lastSentence : "PARSE"),
+                               QLatin1String(parseErrorName(m_lastError)));
+    if (m_lastField) {
+        message += QString(" (%1)").arg(QLatin1String(m_lastField));
     }
-
-    return buffer;
+    message += QString(". Data: %1").arg(QString::fromLatin1(m_lastLine, qMin(m_lastLineLength, 50)));
+    return message;
 }
 
-QByteArray ParserNMEA::serialize(const GNGLLData& data)
+quint64 ParserNMEA::totalErrors() const
 {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
-
-    try {
-        // Записываем координаты
-        stream << data.latitude
-               << data.longitude;
-
-        // Записываем время
-        stream << data.time.toString("HHmmss.zzz");
-
-        // Статус валидности
-        stream << (data.isValid ? "A" : "V");
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GNGLL serialization failed: %1").arg(e.what()));
-        return QByteArray();
+    quint64 total = 0;
+    for (quint64 count : m_errorCounts) {
+        total += count;
     }
-
-    return buffer;
+    return total;
 }
 
-QByteArray ParserNMEA::serialize(const GNVTGData& data)
+QString ParserNMEA::errorSummary() const
 {
-    QByteArray buffer;
-    QDataStream stream(&buffer, QIODevice::WriteOnly);
-    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
-
-    try {
-        // Форматируем данные согласно стандарту NMEA
-        stream << QString::number(data.trueCourse, 'f', 1) << "T"
-               << QString::number(data.magneticCourse, 'f', 1) << "M"
-               << QString::number(data.speedKnots, 'f', 1) << "N"
-               << QString::number(data.speedKmh, 'f', 1) << "K"
-               << (data.isValid ? "A" : "V");
-    }
-    catch (const std::exception& e) {
-        logError("SERIALIZE", QString("GNVTG serialization failed: %1").arg(e.what()));
-        return QByteArray();
+    QString summary = QString("разобрано %1, отклонено %2, исправлено полей %3")
+                          .arg(m_parsed)
+                          .arg(totalErrors())
+                          .arg(m_repairedFields);
+    for (int i = 1; i < static_cast<int>(ParseError::Count); ++i) {
+        if (m_errorCounts[i] > 0) {
+            summary += QString("; %1: %2")
+                           .arg(QLatin1String(parseErrorName(static_cast<ParseError>(i))))
+                           .arg(m_errorCounts[i]);
+        }
     }
-
-    return buffer;
+    return summary;
 }
 
-void ParserNMEA::logError(const QString &msgType, const QString &message) const
+void ParserNMEA::resetCounters()
 {
-    if (m_logger) {
-        m_logger->log(Logger::Error, QString("[%1] %2").arg(msgType, message));
-    }
+    m_errorCounts.fill(0);
+    m_repairedFields = 0;
+    m_parsed = 0;
+    m_lastError = ParseError::None;
 }
 
-void ParserNMEA::logWarning(const QString &msgType, const QString &message) const
+void ParserNMEA::logDebug(const char *msgType, const QString &message) const
 {
-    if (m_logger) {
-        m_logger->log(Logger::Warning, QString("[%1] %2").arg(msgType, message));
+    if (debugEnabled()) {
+        m_logger->log(Logger::Debug, QString("[%1] %2").arg(QLatin1String(msgType), message));
     }
 }
 
-void ParserNMEA::logInfo(const QString &msgType, const QString &message) const
+bool ParserNMEA::debugEnabled() const
 {
-    if (m_logger) {
-        m_logger->log(Logger::Info, QString("[%1] %2").arg(msgType, message));
-    }
+    return m_logger && m_logger->isEnabled(Logger::Debug);
 }
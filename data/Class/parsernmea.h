@@ -4,12 +4,33 @@
 
 #include "logger.h"
 #include "NavigationData.h"
+#include "nmeafields.h"
+#include "nmeaframing.h"
 #include <QObject>
-#include <QHash>
 #include <QVector>
-#include <QStringRef>
 #include <QByteArray>
 
+#include <array>
+
+// Причина отказа в разборе строки. Код фиксируется на горячем пути,
+// текст сообщения собирается только по запросу (lastErrorMessage()).
+enum class ParseError : quint8 {
+    None,
+    BadStart,        // Нет '$' или строка слишком короткая
+    NoChecksum,      // Нет '*' и двух символов контрольной суммы
+    TooLong,         // Длиннее 82 символов
+    BadChecksum,     // Контрольная сумма не совпала или не число
+    TooManyFields,   // Полей больше NmeaFields::MaxFields
+    UnknownTalker,   // Неизвестный источник (не GP/GL/GA/GB/BD/GN)
+    UnknownSentence, // Тип предложения не поддерживается
+    MissingFields,   // Полей меньше, чем требует тип предложения
+    BadField,        // Поле не удалось преобразовать
+    OutOfRange,      // Значение вне допустимого диапазона
+    Count
+};
+
+const char *parseErrorName(ParseError error);
+
 class ParserNMEA : public QObject
 {
     Q_OBJECT
@@ -17,88 +38,97 @@ public:
     explicit ParserNMEA(QObject *parent = nullptr);
     void setLogger(Logger *logger);
     NavigationData parseData(QString &line);
+    // Разбор ASCII-строки прямо из буфера приема, без перекодировки в UTF-16
+    NavigationData parseData(const char *line, int length);
+    NavigationData parseData(const QByteArray &line);
+    // Разбор предложения, уже размеченного scanNmeaFrames(): для корректного
+    // кадра проверка рамки и контрольной суммы не повторяется
+    NavigationData parseFrame(const char *buffer, const NmeaFrame &frame);
+
+    // Диагностика. Отказы считаются по причинам; исправленные поля
+    // (пустое число, значение за диапазоном) строку не отклоняют и
+    // учитываются отдельно.
+    ParseError lastError() const { return m_lastError; }
+    QString lastErrorMessage() const;
+    quint64 errorCount(ParseError error) const { return m_errorCounts[static_cast<int>(error)]; }
+    quint64 totalErrors() const;
+    quint64 repairedFieldCount() const { return m_repairedFields; }
+    quint64 parsedCount() const { return m_parsed; }
+    QString errorSummary() const;
+    void resetCounters();
 
 private:
-    // Методы серилизации
-    QByteArray serialize(const GNRMCData &data);
-    QByteArray serialize(const GNGGAData &data);
-    QByteArray serialize(const GNGSAData &data);
-    QByteArray serialize(const GNZDAData &data);
-    QByteArray serialize(const GNDHVData &data);
-    QByteArray serialize(const GNGSTData &data);
-    QByteArray serialize(const GPTXTData &data);
-    QByteArray serialize(const GNGLLData &data);
-    QByteArray serialize(const GLGSVData &data);
-    QByteArray serialize(const GNVTGData &data);
-
-    // Парсеры для каждого типа сообщений
-    void parseGNRMC(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNGGA(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNGSA(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNZDA(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNDHV(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNGST(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGPTXT(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNGLL(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGLGSV(const QVector<QStringRef> &parts, NavigationData &data);
-    void parseGNVTG(const QVector<QStringRef> &parts, NavigationData &data);
+    // Разбор полей после проверки рамки, starPos — позиция '*'
+    void parseSentence(const char *line, const char *starPos, NavigationData &result);
+
+    // Парсеры для каждого типа предложения, от любого источника (GP, GL, GA, GB, GN).
+    // Возвращают false при отказе, причина — в m_lastError.
+    bool parseGNRMC(const NmeaFields &parts, NavigationData &data);
+    bool parseGNGGA(const NmeaFields &parts, NavigationData &data);
+    bool parseGNGSA(const NmeaFields &parts, NavigationData &data);
+    bool parseGNZDA(const NmeaFields &parts, NavigationData &data);
+    bool parseGNDHV(const NmeaFields &parts, NavigationData &data);
+    bool parseGNGST(const NmeaFields &parts, NavigationData &data);
+    bool parseGPTXT(const NmeaFields &parts, NavigationData &data);
+    bool parseGNGLL(const NmeaFields &parts, NavigationData &data);
+    bool parseGLGSV(const NmeaFields &parts, NavigationData &data);
+    bool parseGNVTG(const NmeaFields &parts, NavigationData &data);
 
     // Вспомогательные методы
-    bool isValidString(QString &line);
-    bool validateChecksum(const QString &line) const;
-    void handleBuffer(QString &line);
-    QTime parseTime(const QStringRef &ref,
-                    const QString &msgType) const;
-    QTime parseTimeWithMilliseconds(const QStringRef& timeRef,
-                                    const QString& msgType) const;
-    QDate parseDate(const QStringRef& dayRef,
-                    const QStringRef& monthRef,
-                    const QStringRef& yearRef,
-                    const QString& msgType) const;
-    QDate parseDate(const QStringRef &ref,
-                    const QString& msgType) const;
-    double parseDouble(const QStringRef &ref,
-                       const QString &fieldName,
-                       const QString &msgType) const;
-    int parseInt(const QStringRef &ref,
-                 const QString &fieldName,
-                 const QString &msgType) const;
-    QString parseString(const QStringRef &ref,
-                        const QString &fieldName,
-                        const QString &msgType) const;
-    double parseCoordinate(const QStringRef &coord,
-                           const QStringRef &dir,
-                           const QString &msgType) const;
-
-    // Валидация
-    double validateAngle(double degrees,
-                         const QString& field,
-                         const QString& context) const;
+    // Проверка рамки: '$', '*', длина, контрольная сумма. Ничего не считает.
+    ParseError validateFrame(const char *line, int length) const;
+    bool validateChecksum(const char *line, int length) const;
+    // При ошибке поле заменяется значением по умолчанию (repair)
+    QTime parseTime(const NmeaField &ref);
+    QDate parseDate(const NmeaField &dayRef,
+                    const NmeaField &monthRef,
+                    const NmeaField &yearRef);
+    QDate parseDate(const NmeaField &ref);
+    double parseDouble(const NmeaField &ref, const char *fieldName);
+    int parseInt(const NmeaField &ref, const char *fieldName);
+    double parseCoordinate(const NmeaField &coord,
+                           const NmeaField &dir,
+                           const char *fieldName);
+
+    // Валидация: validateRange прижимает значение к границам,
+    // validateAngle и validateNonNegative отклоняют строку
     double validateRange(double value,
                          double min,
                          double max,
-                         const QString &fieldName,
-                         const QString &msgType) const;
+                         const char *fieldName);
     int validateRange(int value,
                       int min,
                       int max,
-                      const QString &fieldName,
-                      const QString &msgType) const;
-    double validateNonNegative(double value,
-                               const QString& field,
-                               const QString& context) const;
-
+                      const char *fieldName);
+    bool validateAngle(double &degrees, const char *fieldName);
+    bool validateNonNegative(double value, const char *fieldName);
 
-    // Логирование
-    void logError(const QString &msgType, const QString &message) const;
-    void logWarning(const QString &msgType, const QString &message) const;
-    void logInfo(const QString &msgType, const QString &message) const;
+    // Фиксация ошибок без форматирования строк
+    bool reject(ParseError error, const char *fieldName = nullptr);
+    void repair(const char *fieldName);
 
-    QString inCompleteLine ="";
+    // Логирование. Сообщения об успешном разборе и о несогласованных
+    // полях — на каждую строку, поэтому уровень Debug
+    void logDebug(const char *msgType, const QString &message) const;
+    bool debugEnabled() const;
 
     Logger *m_logger = nullptr;
-    QString m_buffer;
-    QHash<QString, std::function<void(ParserNMEA*, const QVector<QStringRef>&, NavigationData&)>> m_parsers;
+
+    // Контекст текущей строки — для сообщения об ошибке по запросу
+    const char *m_line = nullptr;
+    int m_lineLength = 0;
+    const char *m_sentence = nullptr;
+
+    // Последний отказ: копия начала строки, указатели — только на литералы
+    ParseError m_lastError = ParseError::None;
+    const char *m_lastSentence = nullptr;
+    const char *m_lastField = nullptr;
+    char m_lastLine[84] = {};
+    int m_lastLineLength = 0;
+
+    std::array<quint64, static_cast<int>(ParseError::Count)> m_errorCounts{};
+    quint64 m_repairedFields = 0;
+    quint64 m_parsed = 0;
 };
 
 #endif // PARSERNMEA_H
@@ -0,0 +1,107 @@
+// skyviewassembler.cpp
+#include "skyviewassembler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+quint8 toByte(double value)
+{
+    return static_cast<quint8>(qBound(0L, std::lround(value), 255L));
+}
+}
+
+bool SkyViewAssembler::add(const NavigationData &data)
+{
+    const GLGSVData *gsv = data.as<GLGSVData>();
+    if (data.result != OK || !gsv) {
+        return true;
+    }
+
+    Sequence &sequence = m_sequences[static_cast<int>(data.talker)];
+    if (gsv->messageNumber == 1) {
+        if (sequence.total > 0) {
+            drop(sequence);
+        }
+        if (gsv->totalMessages > MaxParts) {
+            ++m_stats.dropped;
+            return false;
+        }
+        sequence.total = gsv->totalMessages;
+        sequence.next = 1;
+        sequence.count = 0;
+    } else if (sequence.total == 0) {
+        // Начало последовательности потеряно
+        ++m_stats.dropped;
+        return false;
+    } else if (gsv->totalMessages != sequence.total || gsv->messageNumber != sequence.next) {
+        drop(sequence);
+        return false;
+    }
+
+    for (int i = 0; i < gsv->satelliteDataCount; ++i) {
+        const SatelliteInfo &info = gsv->satelliteData[i];
+        SkySatellite &sat = sequence.satellites[sequence.count++];
+        sat.prn = static_cast<quint16>(qBound(0, info.prn, 0xFFFF));
+        sat.azimuth = static_cast<quint16>(std::lround(info.azimuth) % 360);
+        sat.elevation = toByte(info.elevation);
+        sat.snr = toByte(info.snr);
+        sat.talker = data.talker;
+    }
+
+    if (sequence.next == sequence.total) {
+        commit(sequence);
+        sequence.total = 0;
+    } else {
+        ++sequence.next;
+    }
+    return true;
+}
+
+void SkyViewAssembler::take(SkyView &view)
+{
+    view.count = m_view.count;
+    std::copy(m_view.satellites, m_view.satellites + m_view.count, view.satellites);
+    m_view.count = 0;
+}
+
+void SkyViewAssembler::reset()
+{
+    for (Sequence &sequence : m_sequences) {
+        sequence.total = 0;
+    }
+    m_view.count = 0;
+    m_stats = Stats();
+}
+
+void SkyViewAssembler::drop(Sequence &sequence)
+{
+    sequence.total = 0;
+    ++m_stats.dropped;
+}
+
+void SkyViewAssembler::commit(const Sequence &sequence)
+{
+    ++m_stats.sequences;
+    const int viewed = m_view.count; // Повторы ищем только среди прежних последовательностей
+    for (int i = 0; i < sequence.count; ++i) {
+        const SkySatellite &sat = sequence.satellites[i];
+
+        int found = 0;
+        while (found < viewed && (m_view.satellites[found].prn != sat.prn ||
+                                  m_view.satellites[found].talker != sat.talker)) {
+            ++found;
+        }
+        if (found < viewed) {
+            SkySatellite &known = m_view.satellites[found];
+            known.snr = qMax(known.snr, sat.snr);
+            continue;
+        }
+
+        if (m_view.count == SkyView::MaxSatellites) {
+            ++m_stats.overflows;
+            continue;
+        }
+        m_view.satellites[m_view.count++] = sat;
+    }
+}
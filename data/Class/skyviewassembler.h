@@ -0,0 +1,53 @@
+// skyviewassembler.h
+#ifndef SKYVIEWASSEMBLER_H
+#define SKYVIEWASSEMBLER_H
+
+#include "NavigationData.h"
+
+// Сборка многочастных GSV в обзор неба эпохи.
+// Последовательность частей 1..N ведется отдельно для каждого источника
+// (GP, GL, GA, GB, GN) и попадает в обзор только целиком: пропуск или
+// повтор части отбрасывает последовательность. Спутник, пришедший повторно
+// (другой сигнал в NMEA 4.11), не дублируется — остается лучший SNR.
+// Вся память фиксирована: части копятся в буферах источников, обзор — в SkyView.
+class SkyViewAssembler {
+public:
+    static constexpr int MaxParts = 9; // Номер части GSV — одна цифра
+
+    struct Stats {
+        quint64 sequences = 0;  // Принятые последовательности
+        quint64 dropped = 0;    // Отброшены из-за пропущенной части
+        quint64 overflows = 0;  // Спутники сверх SkyView::MaxSatellites
+    };
+
+    // Принимает часть GSV; остальные сообщения игнорируются.
+    // false — часть нарушает порядок и отброшена вместе с последовательностью
+    bool add(const NavigationData &data);
+
+    // Отдает собранный обзор и начинает новый. Незавершенные
+    // последовательности продолжаются в следующем обзоре
+    void take(SkyView &view);
+
+    void reset();
+    const Stats &stats() const { return m_stats; }
+
+private:
+    static constexpr int TalkerCount = static_cast<int>(Talker::GN) + 1;
+    static constexpr int MaxPending = MaxParts * GLGSVData::MaxSatellitesPerMessage;
+
+    struct Sequence {
+        int total = 0; // 0 — последовательность не начата
+        int next = 0;  // Ожидаемый номер части
+        int count = 0;
+        SkySatellite satellites[MaxPending];
+    };
+
+    void drop(Sequence &sequence);
+    void commit(const Sequence &sequence);
+
+    Sequence m_sequences[TalkerCount];
+    SkyView m_view;
+    Stats m_stats;
+};
+
+#endif // SKYVIEWASSEMBLER_H
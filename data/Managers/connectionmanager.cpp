@@ -1,51 +1,59 @@
 #include "connectionmanager.h"
 
 ConnectionManager::ConnectionManager(QObject *parent)
-    : QObject(parent),
-    serialPort(new QSerialPort(this)),
-    ethernetClient(nullptr)
+    : QObject(parent)
 {
-
+    connect(&m_ingest, &IngestWorker::recordsReady, this, &ConnectionManager::onRecordsReady);
+    connect(&m_ingest, &IngestWorker::errorOccurred, this, [this](const QString &error) {
+        m_logger->log(Logger::Error, error);
+        emit errorOccurred(error);
+    });
+    connect(&m_ingest, &IngestWorker::sourceStateChanged, this, [this](const QString &source, const QString &state) {
+        const bool bad = state == EthernetClient::stateName(EthernetClient::Degraded)
+                         || state == EthernetClient::stateName(EthernetClient::Lost);
+        m_logger->log(bad ? Logger::Warning : Logger::Info, QString("%1: link %2").arg(source, state));
+    });
+    connect(&m_ingest, &IngestWorker::replayFinished, this, [this](int, const QString &source) {
+        m_logger->log(Logger::Info, QString("%1: replay finished").arg(source));
+    });
 }
 
 ConnectionManager::~ConnectionManager() {
-    // Освобождаем ресурсы
-    if (serialPort && serialPort->isOpen()) {
-        serialPort->close();
-    }
-    delete serialPort;
-
-    if (ethernetClient) {
-        ethernetClient->disconnectFromServer();
-        delete ethernetClient;
-    }
+    // Поток приема останавливается до удаления потребителей
+    m_ingest.closeAll();
 }
 
 void ConnectionManager::setLogger(Logger *logger) {
     m_logger = logger;
+    m_ingest.setLogger(logger);
+}
+
+void ConnectionManager::setFlightPerSource(bool enabled) {
+    m_ingest.setFlightPerSource(enabled);
 }
 
-void ConnectionManager::connectToTTL(const QString &portName)
+void ConnectionManager::setDataManager(DataManager *manager) {
+    dataManager = manager;
+    m_ingest.setStorage(manager->databaseManager(), manager->captureRecorder());
+}
+
+void ConnectionManager::setDatabaseManager(DatabaseManager *dbManager) {
+    m_ingest.setStorage(dbManager, dataManager ? dataManager->captureRecorder() : nullptr);
+}
+
+bool ConnectionManager::connectToTTL(const QString &portName)
 {
-    try {
-        m_logger->log(Logger::Debug, QString("Attempting TTL connection to %1").arg(portName));
-        serialPort->setPortName(portName);
-
-        if (serialPort->open(QIODevice::ReadOnly)) {
-            configureSerialPort();
-
-            connect(serialPort, &QSerialPort::readyRead, this, &ConnectionManager::onReadyRead);
-            m_logger->log(Logger::Info, QString("Successfully connected to %1").arg(portName));
-            emit connectionStatusChanged(true);
-        } else {
-            QString error = QString("Failed to open serial port: %1").arg(serialPort->errorString());
-            m_logger->log(Logger::Error, error);
-            emit errorOccurred(error);
-        }
-    } catch (const std::exception &e) {
-        m_logger->log(Logger::Critical, QString("TTL connection error: %1").arg(e.what()));
-        throw;
+    m_logger->log(Logger::Debug, QString("Attempting TTL connection to %1").arg(portName));
+
+    QString error;
+    if (m_ingest.openSerial(portName, &error) > 0) {
+        m_logger->log(Logger::Info, QString("Successfully connected to %1").arg(portName));
+        emit connectionStatusChanged(true);
+        return true;
     }
+    m_logger->log(Logger::Error, error);
+    emit errorOccurred(error);
+    return false;
 }
 
 void ConnectionManager::populateSerialPorts(QComboBox *serialPortComboBox) {
@@ -55,111 +63,58 @@ void ConnectionManager::populateSerialPorts(QComboBox *serialPortComboBox) {
     }
 }
 
-void ConnectionManager::configureSerialPort() {
-    // Настройки порта по умолчанию
-    serialPort->setBaudRate(QSerialPort::Baud115200);
-    serialPort->setDataBits(QSerialPort::Data8);
-    serialPort->setParity(QSerialPort::NoParity);
-    serialPort->setStopBits(QSerialPort::OneStop);
-    serialPort->setFlowControl(QSerialPort::NoFlowControl);
-}
-
-void ConnectionManager::connectToEthernet(const QString &ipAddress, quint16 port)
+bool ConnectionManager::connectToEthernet(const QString &ipAddress, quint16 port)
 {
-    try {
-        m_logger->log(Logger::Debug, QString("Attempting Ethernet connection to %1:%2").arg(ipAddress).arg(port));
-        ethernetClient = new EthernetClient(ipAddress, port, this);
-        connect(ethernetClient, &EthernetClient::errorOccurred, this, [this](const QString &error) {
-            m_logger->log(Logger::Error, QString("Ethernet error: %1").arg(error));
-            emit errorOccurred(error);
-        });
-
-        if (ethernetClient->connectToServer()) {
-            connect(ethernetClient, &EthernetClient::dataReceived, this, &ConnectionManager::onEthernetDataReceived);
-            m_logger->log(Logger::Info, "Ethernet connection established");
-            emit connectionStatusChanged(true);
-        } else {
-            QString error = "Failed to connect via Ethernet";
-            m_logger->log(Logger::Error, error);
-            emit errorOccurred(error);
-        }
-    } catch (const std::exception &e) {
-        m_logger->log(Logger::Critical, QString("Ethernet connection error: %1").arg(e.what()));
-        throw;
+    m_logger->log(Logger::Debug, QString("Attempting Ethernet connection to %1:%2").arg(ipAddress).arg(port));
+
+    QString error;
+    if (m_ingest.openUdp(ipAddress, port, &error) > 0) {
+        // Рукопожатие идет в потоке приема, о его итоге сообщит sourceStateChanged
+        m_logger->log(Logger::Info, "Ethernet handshake started");
+        emit connectionStatusChanged(true);
+        return true;
     }
+    m_logger->log(Logger::Error, error);
+    emit errorOccurred(error);
+    return false;
 }
 
 void ConnectionManager::disconnect()
 {
-    m_logger->log(Logger::Info, "Disconnecting...");
-
-    if (serialPort->isOpen()) {
-        serialPort->close();
-        m_logger->log(Logger::Debug, "Serial port closed");
-        emit connectionStatusChanged(false);
+    if (!m_ingest.isRunning()) {
+        return;
     }
 
-    if (ethernetClient) {
-        ethernetClient->disconnectFromServer();
-        m_logger->log(Logger::Debug, "Ethernet connection closed");
-        emit connectionStatusChanged(false);
+    m_logger->log(Logger::Info, "Disconnecting...");
+    m_ingest.closeAll();
+
+    for (const IngestWorker::SourceStats &stats : m_ingest.sourceStats()) {
+        m_logger->log(Logger::Info, QString("[%1] %2: %3 bytes, %4 sentences, %5 invalid, "
+                                            "latency avg %6 us, max %7 us%8")
+                                        .arg(stats.id)
+                                        .arg(stats.name)
+                                        .arg(stats.bytes)
+                                        .arg(stats.sentences)
+                                        .arg(stats.invalid)
+                                        .arg(stats.avgLatencyUs, 0, 'f', 1)
+                                        .arg(stats.maxLatencyUs, 0, 'f', 1)
+                                        .arg(stats.roundTripUs >= 0
+                                                 ? QString(", round trip %1 us").arg(stats.roundTripUs, 0, 'f', 0)
+                                                 : QString()));
     }
+    emit connectionStatusChanged(false);
 }
 
-void ConnectionManager::onEthernetDataReceived(const QByteArray &receivedData)
+void ConnectionManager::onRecordsReady(const QVector<NavigationData> &records, quint64 skipped)
 {
-    m_logger->log(Logger::Debug, QString("Received %1 bytes via Ethernet").arg(receivedData.size()));
-    dataManager->writeDataToFile(receivedData);
-    processReceivedData(receivedData);
-}
-
-void ConnectionManager::onReadyRead()
-{
-    QByteArray data = serialPort->readAll();
-    m_logger->log(Logger::Debug, QString("Received %1 bytes via TTL").arg(data.size()));
-    dataManager->writeDataToFile(data);
-    processReceivedData(data);
-}
+    if (skipped > 0) {
+        COMETA_LOG(m_logger, Logger::Debug, QString("Display skipped %1 records").arg(skipped));
+    }
 
-void ConnectionManager::processReceivedData(const QByteArray &data)
-{
-    try {
-        QStringList lines = QString::fromUtf8(data).split('\n', QString::SkipEmptyParts);
-        m_logger->log(Logger::Debug, QString("Processing %1 data lines").arg(lines.count()));
-
-        int validCount = 0;
-        int invalidCount = 0;
-
-        for (const QString &line : lines) {
-            QString cleanedLine = line.trimmed();
-            if (cleanedLine.isEmpty() || !cleanedLine.startsWith('$')) {
-                m_logger->log(Logger::Warning, QString("Invalid data line: %1").arg(cleanedLine.left(50)));
-                invalidCount++;
-                continue;
-            }
-
-            NavigationData parsedData = parser.parseData(cleanedLine);
-            if (parsedData.result == OK) {
-                // Форматируем данные
-                QString formatted = m_formatter.formatNavigationData(parsedData);
-
-                // Логируем отформатированные данные
-                m_logger->log(Logger::Info, "Parsed data:\n" + formatted);
-
-                // Отправляем в интерфейс (если нужно)
-                emit dataFormatted(formatted);
-
-                dataManager->saveNavigationData(parsedData);
-                validCount++;
-            } else {
-                m_logger->log(Logger::Warning, QString("Failed to parse: %1").arg(cleanedLine.left(50)));
-                invalidCount++;
-            }
-        }
-
-        m_logger->log(Logger::Info, QString("Data processing complete. Valid: %1, Invalid: %2").arg(validCount).arg(invalidCount));
-    } catch (const std::exception &e) {
-        m_logger->log(Logger::Error, QString("Data processing error: %1").arg(e.what()));
-        emit errorOccurred(e.what());
+    // Форматируются только записи, которые попадут на экран
+    for (const NavigationData &record : records) {
+        QString formatted = m_formatter.formatNavigationData(record);
+        COMETA_LOG(m_logger, Logger::Debug, "Parsed data:\n" + formatted);
+        emit dataFormatted(formatted);
     }
 }
@@ -3,15 +3,14 @@
 
 #include <QComboBox>
 #include <QObject>
-#include <QSerialPort>
 #include <QSerialPortInfo>
-#include "databasemanager.h"
 #include "datamanager.h"
-#include "ethernetclient.h"
 #include "formatnavigationdata.h"
+#include "ingestworker.h"
 #include "logger.h"
-#include "parsernmea.h"
 
+// Прием, разбор и запись идут в потоке IngestWorker; сюда приходят
+// только объединенные обновления для интерфейса
 class ConnectionManager : public QObject {
     Q_OBJECT
 
@@ -20,30 +19,35 @@ public:
     ~ConnectionManager();
 
     void setLogger(Logger *logger);
-
-    void connectToTTL(const QString &portName);
-    void connectToEthernet(const QString &ipAddress, quint16 port);
+    void setDataManager(DataManager *manager);
+    // Новая база для приема; только при отключенных источниках
+    void setDatabaseManager(DatabaseManager *dbManager);
+    // Несколько приемников сразу: каждому свой полет
+    void setFlightPerSource(bool enabled);
+
+    // Полет и запись потока должны быть готовы до вызова: первые записи
+    // источника уходят писателю сразу после открытия. false — источник не открыт
+    bool connectToTTL(const QString &portName);
+    bool connectToEthernet(const QString &ipAddress, quint16 port);
     void disconnect();
+    bool isConnected() const { return m_ingest.isRunning(); }
     void populateSerialPorts(QComboBox *serialPortComboBox); // Передаем QComboBox для заполнения
-    void onEthernetDataReceived(const QByteArray &receivedData);
-    void onReadyRead();
-    void processReceivedData(const QByteArray &data);
-    void configureSerialPort();
-    QSerialPort* getSerialPort(); // Метод для получения указателя на QSerialPort
+
+    QVector<IngestWorker::SourceStats> sourceStats() const { return m_ingest.sourceStats(); }
 
 signals:
     void connectionStatusChanged(bool connected);
     void errorOccurred(const QString &error);
     void dataFormatted(const QString &formattedData);
 
+private slots:
+    void onRecordsReady(const QVector<NavigationData> &records, quint64 skipped);
+
 private:
     NavigationDataFormatter m_formatter; // Добавляем форматтер
-    Logger *m_logger;
-    QSerialPort *serialPort;
-    EthernetClient *ethernetClient;
-    DatabaseManager *dbManager;
-    DataManager *dataManager;
-    ParserNMEA parser;
+    Logger *m_logger = nullptr;
+    DataManager *dataManager = nullptr;
+    IngestWorker m_ingest;
 };
 
 #endif // CONNECTIONMANAGER_H
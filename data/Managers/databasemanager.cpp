@@ -4,9 +4,12 @@ DatabaseManager::DatabaseManager(const QString &dbName, QObject *parent) : QObje
     QDir().mkpath(QDir::currentPath() + "/database");
     db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName(dbName);
+    // Фоновый писатель держит транзакцию на своем соединении — ждем ее, как и он
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
     initializeDatabase();
-    qRegisterMetaType<NavigationDataMap>("NavigationDataMap");
-    qRegisterMetaType<QList<NavigationDataMap>>("QList<NavigationDataMap>");
+    setupWriter();
+    qRegisterMetaType<NavigationFix>("NavigationFix");
+    qRegisterMetaType<QList<NavigationFix>>("QList<NavigationFix>");
 }
 
 bool DatabaseManager::initializeDatabase() {
@@ -143,11 +146,169 @@ bool DatabaseManager::initializeDatabase() {
          "createdAt TIMESTAMP DEFAULT CURRENT_TIMESTAMP)"}
     };
 
-    return createTables(m_tables);
+    return createTables(m_tables) && migrateSchema();
+}
+
+// Миграции схемы. Версия хранится в PRAGMA user_version; шаг N переводит
+// базу из версии N в N + 1. Новые шаги добавляются только в конец списка.
+const QVector<QStringList> &DatabaseManager::schemaMigrations() {
+    static const QVector<QStringList> migrations = {
+        // 0 -> 1: индексы для выборок по navigation_data_id
+        {
+            "CREATE INDEX IF NOT EXISTS idx_gnrmc_nav ON gnrmc_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gngga_nav ON gngga_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gngsa_nav ON gngsa_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_glgsv_nav ON glgsv_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gnzda_nav ON gnzda_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gndhv_nav ON gndhv_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gngst_nav ON gngst_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gngll_nav ON gngll_data(navigation_data_id)",
+            "CREATE INDEX IF NOT EXISTS idx_gnvtg_nav ON gnvtg_data(navigation_data_id)"
+        },
+        // 1 -> 2: целочисленная ссылка на рейс вместо текстового имени.
+        // flight_name остается для совместимости со старыми версиями программы
+        {
+            "INSERT OR IGNORE INTO flights (flight_name) "
+            "SELECT DISTINCT flight_name FROM navigation_data",
+            "ALTER TABLE navigation_data ADD COLUMN flight_id INTEGER REFERENCES flights(id)",
+            "UPDATE navigation_data SET flight_id = "
+            "(SELECT f.id FROM flights f WHERE f.flight_name = navigation_data.flight_name)",
+            "CREATE INDEX IF NOT EXISTS idx_navigation_data_flight "
+            "ON navigation_data(flight_id, timestamp)"
+        },
+        // 2 -> 3: одна запись на эпоху для графиков, карты и отчетов.
+        // Для старых полетов эпоха — строка navigation_data и ее сообщения
+        {
+            "CREATE TABLE IF NOT EXISTS navigation_fix ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "flight_id INTEGER REFERENCES flights(id), "
+            "timestamp TEXT, "                // QDateTime приема
+            "date TEXT, "                     // QDate UTC
+            "time TEXT, "                     // QTime UTC
+            "isValid INTEGER, "
+            "latitude REAL, "
+            "longitude REAL, "
+            "altitude REAL, "
+            "speed REAL, "
+            "course REAL, "
+            "satellitesCount INTEGER, "
+            "hdop REAL, "
+            "rms REAL, "
+            "latitudeError REAL, "
+            "longitudeError REAL, "
+            "altitudeError REAL, "
+            "sources INTEGER)",               // NavigationFix::Source
+            "CREATE INDEX IF NOT EXISTS idx_navigation_fix_flight ON navigation_fix(flight_id, id)",
+            "INSERT INTO navigation_fix "
+            "(flight_id, timestamp, date, time, isValid, latitude, longitude, altitude, "
+            "speed, course, satellitesCount, hdop, rms, latitudeError, longitudeError, "
+            "altitudeError, sources) "
+            "SELECT n.flight_id, n.timestamp, COALESCE(z.date, r.date), r.time, r.isValid, "
+            "r.latitude, r.longitude, COALESCE(g.altitude, 0), r.speed, r.course, "
+            "COALESCE(g.satellitesCount, 0), COALESCE(g.hdop, 0) / 10.0, "
+            "COALESCE(s.rms, 0), COALESCE(s.latitudeError, 0), "
+            "COALESCE(s.longitudeError, 0), COALESCE(s.altitudeError, 0), "
+            "1 | (CASE WHEN g.id IS NULL THEN 0 ELSE 2 END) "
+            "| (CASE WHEN z.id IS NULL THEN 0 ELSE 4 END) "
+            "| (CASE WHEN s.id IS NULL THEN 0 ELSE 16 END) "
+            "FROM navigation_data n "
+            "JOIN gnrmc_data r ON r.id = "
+            "(SELECT MIN(id) FROM gnrmc_data WHERE navigation_data_id = n.id) "
+            "LEFT JOIN gngga_data g ON g.id = "
+            "(SELECT MIN(id) FROM gngga_data WHERE navigation_data_id = n.id) "
+            "LEFT JOIN gnzda_data z ON z.id = "
+            "(SELECT MIN(id) FROM gnzda_data WHERE navigation_data_id = n.id) "
+            "LEFT JOIN gngst_data s ON s.id = "
+            "(SELECT MIN(id) FROM gngst_data WHERE navigation_data_id = n.id) "
+            "ORDER BY n.id"
+        },
+        // 3 -> 4: обзор неба эпохи — все спутники GSV одной строкой.
+        // satellites — SkyView::RecordSize байтов на спутник (SkyView::toBlob)
+        {
+            "CREATE TABLE IF NOT EXISTS sky_view ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "fix_id INTEGER REFERENCES navigation_fix(id), "
+            "flight_id INTEGER REFERENCES flights(id), "
+            "satellitesCount INTEGER, "
+            "satellites BLOB)",
+            "CREATE INDEX IF NOT EXISTS idx_sky_view_flight ON sky_view(flight_id, fix_id)"
+        },
+        // 4 -> 5: несколько приемников одновременно — строка помечается
+        // именем источника (порт, адрес:порт, файл); NULL — единственный поток
+        {
+            "ALTER TABLE navigation_data ADD COLUMN source_name TEXT",
+            "ALTER TABLE navigation_fix ADD COLUMN source_name TEXT"
+        }
+    };
+    return migrations;
+}
+
+int DatabaseManager::schemaVersion() {
+    QSqlQuery query("PRAGMA user_version");
+    return query.next() ? query.value(0).toInt() : 0;
+}
+
+bool DatabaseManager::migrateSchema() {
+    const QVector<QStringList> &migrations = schemaMigrations();
+    int version = schemaVersion();
+
+    if (version > migrations.size()) {
+        logError(QString("Database schema version %1 is newer than supported %2")
+                     .arg(version).arg(migrations.size()));
+        return false;
+    }
+
+    for (; version < migrations.size(); ++version) {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!db.transaction()) {
+            logError("Failed to start migration transaction");
+            return false;
+        }
+
+        try {
+            QSqlQuery query;
+            for (const QString &statement : migrations[version]) {
+                if (!query.exec(statement)) {
+                    throw std::runtime_error(
+                        QString("%1: %2").arg(statement, query.lastError().text()).toStdString());
+                }
+            }
+            // PRAGMA не принимает параметры — номер версии подставляется в текст
+            if (!query.exec(QString("PRAGMA user_version = %1").arg(version + 1))) {
+                throw std::runtime_error(query.lastError().text().toStdString());
+            }
+            if (!db.commit()) {
+                throw std::runtime_error(db.lastError().text().toStdString());
+            }
+        } catch (const std::exception &e) {
+            db.rollback();
+            logError(QString("Schema migration %1 -> %2 failed: %3")
+                         .arg(version).arg(version + 1).arg(e.what()));
+            return false;
+        }
+
+        if (m_logger) {
+            m_logger->log(Logger::Info, QString("Schema migrated %1 -> %2 in %3 ms")
+                                            .arg(version).arg(version + 1).arg(timer.elapsed()));
+        }
+    }
+    return true;
 }
 
 void DatabaseManager::setLogger(Logger *logger) {
     m_logger = logger;
+    m_writer->setLogger(logger);
+    if (m_backgroundWriter) {
+        m_backgroundWriter->setLogger(logger);
+    }
+}
+
+void DatabaseManager::setupWriter() {
+    m_writer = new NavigationBatchWriter(db.connectionName(), this);
+    connect(m_writer, &NavigationBatchWriter::batchCommitted,
+            this, &DatabaseManager::batchCommitted);
 }
 
 bool DatabaseManager::open() {
@@ -161,7 +322,10 @@ bool DatabaseManager::open() {
 }
 
 void DatabaseManager::close() {
+    stopBackgroundWriter();
     if (db.isOpen()) {
+        m_writer->flush(true);
+        m_writer->resetStatements();
         db.close();
         qDebug() << "База данных закрыта.";
     }
@@ -271,17 +435,22 @@ bool DatabaseManager::deleteFlight(const QString &flightName)
         const QStringList tables = {
             "gnrmc_data", "gngga_data", "gngsa_data", "glgsv_data",
             "gnzda_data", "gndhv_data", "gngst_data", "gngll_data",
-            "gnvtg_data", "navigation_data", "flights"
+            "gnvtg_data", "sky_view", "navigation_fix", "navigation_data", "flights"
         };
 
         QSqlQuery query;
         for (const QString &table : tables) {
             QString queryText;
-            if (table == "navigation_data" || table == "flights") {
+            if (table == "flights") {
                 queryText = QString("DELETE FROM %1 WHERE flight_name = ?").arg(table);
+            } else if (table == "navigation_data" || table == "navigation_fix" ||
+                       table == "sky_view") {
+                queryText = QString("DELETE FROM %1 WHERE flight_id = "
+                                    "(SELECT id FROM flights WHERE flight_name = ?)").arg(table);
             } else {
                 queryText = QString("DELETE FROM %1 WHERE navigation_data_id IN "
-                                    "(SELECT id FROM navigation_data WHERE flight_name = ?)").arg(table);
+                                    "(SELECT id FROM navigation_data WHERE flight_id = "
+                                    "(SELECT id FROM flights WHERE flight_name = ?))").arg(table);
             }
 
             query.prepare(queryText);
@@ -299,6 +468,7 @@ bool DatabaseManager::deleteFlight(const QString &flightName)
             logError(errorText);
             throw std::runtime_error(errorText.toStdString());
         }
+        m_flightCache.invalidate(flightName);
         return true;
     } catch (const std::exception& e) {
         db.rollback();
@@ -307,361 +477,111 @@ bool DatabaseManager::deleteFlight(const QString &flightName)
     }
 }
 
-bool DatabaseManager::saveNavigationData(const NavigationData &data) {
-    QElapsedTimer timer;
-    timer.start();
+bool DatabaseManager::saveNavigationData(const NavigationData &data, const QByteArray &rawLine) {
+    if (m_backgroundWriter) {
+        return m_backgroundWriter->enqueue(data, rawLine);
+    }
 
     if (!db.isOpen() && !open()) {
         logError("Database not open");
         return false;
     }
 
-    static QHash<MsgType, QString> typeNames = {
-        {MsgType::GNRMC, "GNRMC"}, {MsgType::GNGGA, "GNGGA"},
-        {MsgType::GNGSA, "GNGSA"}, {MsgType::GNZDA, "GNZDA"},
-        {MsgType::GNDHV, "GNDHV"}, {MsgType::GNGST, "GNGST"},
-        {MsgType::GPTXT, "GPTXT"}, {MsgType::GNGLL, "GNGLL"},
-        {MsgType::GLGSV, "GLGSV"}, {MsgType::GNVTG, "GNVTG"}
-    };
-
-    try {
-        if (!db.transaction()) {
-            throw std::runtime_error("Failed to start transaction");
-        }
-        if(firstType.isEmpty()){
-            firstType = data.type;
-        }
-
-        if (data.type == MsgType::GNRMC) {
-            QSqlQuery navQuery;
-            navQuery.prepare(
-                "INSERT INTO navigation_data "
-                "(flight_name, timestamp) "
-                "VALUES (?, ?)");
-
-            navQuery.addBindValue(flight_name);
-            navQuery.addBindValue(data.timestamp.toString(Qt::ISODateWithMs));
-
-            if (!navQuery.exec()) {
-                throw std::runtime_error(
-                    "Navigation data insert failed: " +
-                    navQuery.lastError().text().toStdString());
-            }
-
-            currentNavId = navQuery.lastInsertId().toInt();
-        }
-
-        // Лямбда для выполнения запросов
-        auto executeQuery = [&](QSqlQuery& query, const QString& context) {
-            if (!query.exec()) {
-                throw std::runtime_error(
-                    QString("%1 failed: %2")
-                        .arg(context)
-                        .arg(query.lastError().text())
-                        .toStdString());
-            }
-        };
-
-        // Обработка данных в зависимости от типа
-        switch (data.type) {
-        case MsgType::GNRMC: {
-            GNRMCData d;
-            QDataStream stream(data.data);
-            int coordDef, statusNav;
-            stream >> d.time >> d.isValid >> d.latitude >> d.longitude
-                >> d.speed >> d.course >> d.date >> d.magnDeviation
-                >> coordDef >> statusNav;
-
-            d.coordinateDefinition = static_cast<GNRMCData::CoordinateDefinition>(coordDef);
-            d.statusNav = static_cast<bool>(statusNav);
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gnrmc_data "
-                "(navigation_data_id, time, date, latitude, longitude, "
-                "speed, course, isValid, magnDeviation, coordinateDefinition, statusNav) "
-                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.date.toString("yyyy-MM-dd"));
-            q.addBindValue(d.latitude);
-            q.addBindValue(d.longitude);
-            q.addBindValue(d.speed);
-            q.addBindValue(d.course);
-            q.addBindValue(d.isValid);
-            q.addBindValue(d.magnDeviation);
-            q.addBindValue(static_cast<int>(d.coordinateDefinition));
-            q.addBindValue(d.statusNav);
-
-            executeQuery(q, "GNRMC insert");
-            break;
-        }
-
-        case MsgType::GNGGA: {
-            GNGGAData d;
-            QDataStream stream(data.data);
-            int coordDef, altUnit, diffUnit;
-            stream >> d.time
-                >> d.latitude
-                >> d.longitude
-                >> coordDef
-                >> d.satellitesCount
-                >> d.HDOP
-                >> d.altitude
-                >> altUnit
-                >> d.diffElipsoidSeaLevel
-                >> diffUnit
-                >> d.countSecDGPS
-                >> d.idDGPS;
-
-            d.coordDef = static_cast<GNGGAData::CoordinateDefinition>(coordDef);
-            d.altUnit = static_cast<GNGGAData::AltitudeUnits>(altUnit);
-            d.diffElipsUnit = static_cast<GNGGAData::AltitudeUnits>(diffUnit);
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gngga_data "
-                "(navigation_data_id, time, latitude, longitude, coordDef, "
-                "satellitesCount, hdop, altitude, altUnit, diffElipsoidSeaLevel, "
-                "diffElipsUnit, countSecDGPS, idDGPS) "
-                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.latitude);
-            q.addBindValue(d.longitude);
-            q.addBindValue(static_cast<int>(d.coordDef));
-            q.addBindValue(d.satellitesCount);
-            q.addBindValue(static_cast<int>(d.HDOP));
-            q.addBindValue(d.altitude);
-            qDebug()<<d.altitude;
-            q.addBindValue(static_cast<int>(d.altUnit));
-            q.addBindValue(d.diffElipsoidSeaLevel);
-            q.addBindValue(static_cast<int>(d.diffElipsUnit));
-            q.addBindValue(static_cast<int>(d.countSecDGPS));
-            q.addBindValue(d.idDGPS);
-
-            executeQuery(q, "GNGGA insert");
-            break;
-        }
-
-        case MsgType::GNGSA: {
-            GNGSAData d;
-            QDataStream stream(data.data);
-            int format, gnss;
-            stream >> d.isAuto >> format >> gnss;
-
-            d.typeFormat = static_cast<TypeFormat>(format);
-            d.typeGNSS = static_cast<TypeGNSS>(gnss);
-
-            QJsonArray satellites;
-            for (int i = 0; i < 12; ++i) {
-                stream >> d.satellitesUsedId[i];
-                if (d.satellitesUsedId[i] > 0) {
-                    satellites.append(d.satellitesUsedId[i]);
-                }
-            }
-
-            stream >> d.PDOP >> d.HDOP >> d.VDOP;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gngsa_data "
-                "(navigation_data_id, isAuto, typeFormat, typeGNSS, "
-                "satellitesUsed, pdop, hdop, vdop) "
-                "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.isAuto);
-            q.addBindValue(static_cast<int>(d.typeFormat));
-            q.addBindValue(static_cast<int>(d.typeGNSS));
-            q.addBindValue(QJsonDocument(satellites).toJson(QJsonDocument::Compact));
-            q.addBindValue(static_cast<int>(d.PDOP));
-            q.addBindValue(static_cast<int>(d.HDOP));
-            q.addBindValue(static_cast<int>(d.VDOP));
-
-            executeQuery(q, "GSA insert");
-            break;
-        }
-
-        case MsgType::GNZDA: {
-            GNZDAData d;
-            QDataStream stream(data.data);
-            stream >> d.time >> d.date >> d.localOffset;
+    return m_writer->write(data);
+}
 
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gnzda_data "
-                "(navigation_data_id, time, date, localOffset) "
-                "VALUES (?, ?, ?, ?)");
+bool DatabaseManager::startBackgroundWriter(int capacity,
+                                            DatabaseWriter::OverflowPolicy policy,
+                                            const QString &spillPath) {
+    stopBackgroundWriter();
 
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.date.toString("yyyy-MM-dd"));
-            q.addBindValue(static_cast<int>(d.localOffset));
+    // Все, что накоплено синхронным писателем, должно лечь в БД раньше очереди
+    m_writer->flush(true);
 
-            executeQuery(q, "GNZDA insert");
-            break;
-        }
+    m_backgroundWriter = new DatabaseWriter(db.databaseName(), capacity, policy, spillPath, this);
+    m_backgroundWriter->setLogger(m_logger);
+    m_backgroundWriter->setStorageProfile(m_storageProfile);
+    connect(m_backgroundWriter, &DatabaseWriter::batchCommitted,
+            this, &DatabaseManager::batchCommitted);
 
-        case MsgType::GNDHV: {
-            GNDHVData d;
-            QDataStream stream(data.data);
-            stream >> d.time >> d.speed3D >> d.speedECEF_X
-                >> d.speedECEF_Y >> d.speedECEF_Z >> d.speed;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gndhv_data "
-                "(navigation_data_id, time, speed3D, speedECEF_X, "
-                "speedECEF_Y, speedECEF_Z, speed) "
-                "VALUES (?, ?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.speed3D);
-            q.addBindValue(d.speedECEF_X);
-            q.addBindValue(d.speedECEF_Y);
-            q.addBindValue(d.speedECEF_Z);
-            q.addBindValue(d.speed);
-
-            executeQuery(q, "GNDHV insert");
-            break;
-        }
+    if (!m_backgroundWriter->start()) {
+        delete m_backgroundWriter;
+        m_backgroundWriter = nullptr;
+        logError("Background writer failed to start, falling back to synchronous writes");
+        return false;
+    }
 
-        case MsgType::GNGST: {
-            GNGSTData d;
-            QDataStream stream(data.data);
-            stream >> d.time >> d.rms >> d.semiMajorError
-                >> d.semiMinorError >> d.semiMajorOrientation
-                >> d.latitudeError >> d.longitudeError >> d.altitudeError;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gngst_data "
-                "(navigation_data_id, time, rms, semiMajorError, "
-                "semiMinorError, semiMajorOrientation, latitudeError, "
-                "longitudeError, altitudeError) "
-                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.rms);
-            q.addBindValue(d.semiMajorError);
-            q.addBindValue(d.semiMinorError);
-            q.addBindValue(d.semiMajorOrientation);
-            q.addBindValue(d.latitudeError);
-            q.addBindValue(d.longitudeError);
-            q.addBindValue(d.altitudeError);
-
-            executeQuery(q, "GNGST insert");
-            break;
-        }
+    m_backgroundWriter->setFlightName(flight_name);
+    m_backgroundWriter->setBatchMode(m_writer->isBatchMode(), m_batchMaxRecords, m_batchMaxLatencyMs);
+    return true;
+}
 
-        case MsgType::GPTXT: {
-            GPTXTData d;
-            QDataStream stream(data.data);
-            stream >> d.messageCount >> d.messageNumber >> d.messageType >> d.message;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gptxt_data "
-                "(navigation_data_id, messageCount, messageNumber, messageType, message) "
-                "VALUES (?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.messageCount);
-            q.addBindValue(d.messageNumber);
-            q.addBindValue(d.messageType);
-            q.addBindValue(d.message);
-
-            executeQuery(q, "GPTXT insert");
-            break;
-        }
+void DatabaseManager::stopBackgroundWriter() {
+    if (!m_backgroundWriter) {
+        return;
+    }
+    m_backgroundWriter->stop();
+    delete m_backgroundWriter;
+    m_backgroundWriter = nullptr;
+}
 
-        case MsgType::GNGLL: {
-            GNGLLData d;
-            QDataStream stream(data.data);
-            stream >> d.latitude >> d.longitude >> d.time >> d.isValid;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gngll_data "
-                "(navigation_data_id, latitude, longitude, time, isValid) "
-                "VALUES (?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.latitude);
-            q.addBindValue(d.longitude);
-            q.addBindValue(d.time.toString("HH:mm:ss.zzz"));
-            q.addBindValue(d.isValid);
-
-            executeQuery(q, "GNGLL insert");
-            break;
-        }
+bool DatabaseManager::setStorageProfile(StorageProfile profile) {
+    m_storageProfile = profile;
+    if (!db.isOpen()) {
+        return false;
+    }
 
-        case MsgType::GNVTG: {
-            GNVTGData d;
-            QDataStream stream(data.data);
-            stream >> d.trueCourse >> d.magneticCourse
-                >> d.speedKnots >> d.speedKmh >> d.isValid;
-
-            QSqlQuery q;
-            q.prepare(
-                "INSERT INTO gnvtg_data "
-                "(navigation_data_id, trueCourse, magneticCourse, "
-                "speedKnots, speedKmh, isValid) "
-                "VALUES (?, ?, ?, ?, ?, ?)");
-
-            q.addBindValue(currentNavId);
-            q.addBindValue(d.trueCourse);
-            q.addBindValue(d.magneticCourse);
-            q.addBindValue(d.speedKnots);
-            q.addBindValue(d.speedKmh);
-            q.addBindValue(d.isValid);
-
-            executeQuery(q, "GNVTG insert");
-            break;
-        }
-        default:
-            throw std::runtime_error(
-                "Unsupported message type: " +
-                typeNames.value(data.type, "UNKNOWN").toStdString());
-        }
+    QString error;
+    if (!applyStorageProfile(db, profile, &error)) {
+        logError("Storage profile: " + error);
+        return false;
+    }
 
-        if (!db.commit()) {
-            throw std::runtime_error("Commit failed");
-        }
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Storage profile: %1").arg(storageProfileName(profile)));
+    }
+    return true;
+}
 
-        m_logger->log(Logger::Info, QString("Saved %1 data block in %2 ms")
-                                        .arg(typeNames.value(data.type))
-                                        .arg(timer.elapsed()));
+DatabaseWriter::Stats DatabaseManager::writerStats() const {
+    return m_backgroundWriter ? m_backgroundWriter->stats() : DatabaseWriter::Stats();
+}
 
-        return true;
+void DatabaseManager::setBatchMode(bool enabled, int maxRecords, int maxLatencyMs) {
+    m_batchMaxRecords = maxRecords;
+    m_batchMaxLatencyMs = maxLatencyMs;
+    m_writer->setBatchMode(enabled, maxRecords, maxLatencyMs);
+    if (m_backgroundWriter) {
+        m_backgroundWriter->setBatchMode(enabled, maxRecords, maxLatencyMs);
     }
-    catch (const std::exception& e) {
-        db.rollback();
-        logError(QString("Save failed for %1: %2")
-                     .arg(typeNames.value(data.type, "UNKNOWN"))
-                     .arg(e.what()));
-        return false;
+    if (m_logger) {
+        m_logger->log(Logger::Info, enabled
+                                        ? QString("Batch writes enabled: %1 records / %2 ms")
+                                              .arg(maxRecords).arg(maxLatencyMs)
+                                        : QString("Batch writes disabled"));
+    }
+}
+
+bool DatabaseManager::flushPendingData() {
+    if (m_backgroundWriter) {
+        m_backgroundWriter->flush();
     }
+    return m_writer->flush(true);
 }
 
-bool DatabaseManager::insertNewFlight() {
+bool DatabaseManager::insertNewFlight(const QString &name) {
     if (!db.isOpen()) {
         if (m_logger) m_logger->log(Logger::Error, "DB not open for new flight");
         return false;
     }
 
-    firstType = "";
+    // Незаписанный пакет относится к предыдущему рейсу
+    flushPendingData();
 
-    // Получаем текущее время
-    QString currentAt = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-
-    // Генерируем имя рейса
-    QString flightName = QString("Flight_%1").arg(currentAt);
+    // Без имени рейс называется по времени создания
+    const QString flightName = name.isEmpty()
+        ? QString("Flight_%1").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+        : name;
 
     // Вставляем новый рейс в базу данных
     QSqlQuery query;
@@ -669,13 +589,18 @@ bool DatabaseManager::insertNewFlight() {
                   "VALUES (?)");
     query.addBindValue(flightName);
 
-    flight_name = flightName;
-
     if (!query.exec()) {
         logQueryError("Insert new flight", query);
         return false;
     }
 
+    // Писатели ищут id рейса по имени — только после вставки
+    flight_name = flightName;
+    m_writer->setFlightName(flightName);
+    if (m_backgroundWriter) {
+        m_backgroundWriter->setFlightName(flightName);
+    }
+
     if (m_logger) {
         m_logger->log(Logger::Info, QString("New flight created: %1 [ID: %2]")
                                         .arg(flightName).arg(query.lastInsertId().toString()));
@@ -685,13 +610,50 @@ bool DatabaseManager::insertNewFlight() {
     return true;
 }
 
+bool DatabaseManager::setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName) {
+    if (!db.isOpen()) {
+        if (m_logger) m_logger->log(Logger::Error, "DB not open for source flight");
+        return false;
+    }
+
+    if (!flightName.isEmpty()) {
+        QSqlQuery query;
+        query.prepare("INSERT OR IGNORE INTO flights (flight_name) VALUES (?)");
+        query.addBindValue(flightName);
+        if (!query.exec()) {
+            logQueryError("Insert source flight", query);
+            return false;
+        }
+    }
+
+    // Записи, уже поставленные в очередь, остаются в прежнем полете
+    m_writer->setSourceFlight(sourceId, sourceName, flightName);
+    if (m_backgroundWriter) {
+        m_backgroundWriter->setSourceFlight(sourceId, sourceName, flightName);
+    }
+
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Source %1 (%2) writes to flight %3")
+                                        .arg(sourceId)
+                                        .arg(sourceName)
+                                        .arg(flightName.isEmpty() ? flight_name : flightName));
+    }
+    return true;
+}
+
+void DatabaseManager::closeSource(int sourceId) {
+    m_writer->closeSource(sourceId);
+    if (m_backgroundWriter) {
+        m_backgroundWriter->closeSource(sourceId);
+    }
+}
+
 QString DatabaseManager::getLastFlight() {
     QString flight;
 
     // Выполняем запрос для получения последнего полета
-    QSqlQuery query("SELECT flightName FROM flights ORDER BY id DESC LIMIT 1");
-
-    if (query.exec()) {
+    QSqlQuery query;
+    if (query.exec("SELECT flight_name FROM flights ORDER BY id DESC LIMIT 1")) {
         if (query.next()) {
             flight = query.value(0).toString(); // Получаем название последнего полета
         }
@@ -815,7 +777,7 @@ QList<NavigationDataTable> DatabaseManager::getCustomData(
                            "SELECT %1 "
                            "FROM navigation_data AS n "
                            "%2 "
-                           "WHERE n.flight_name = :flightName "
+                           "WHERE n.flight_id = (SELECT id FROM flights WHERE flight_name = :flightName) "
                            "%3 "  // Фильтр
                            "ORDER BY %4 %5"
                            )
@@ -861,46 +823,22 @@ QList<NavigationDataTable> DatabaseManager::getCustomData(
 }
 
 void DatabaseManager::getNavigationDataFilterValidMap(const QString &filterField, const QString &filterValue, const QString &sortField, const QString &sortOrder, const QString &flightName) {
-    QList<NavigationData> data = getNavigationDataFilterValid(filterField, filterValue, sortField, sortOrder, flightName);
-
-    QList<NavigationDataMap> mapDataList; // Список для хранения преобразованных данных
-
-    for (const NavigationData &navData : data) {
-        NavigationDataMap mapData;
-
-        // Убедитесь, что navData.data - это QByteArray
-        QByteArray byteArray = navData.data; // Предполагается, что navData.data - это QByteArray
-        QDataStream stream(&byteArray, QIODevice::ReadOnly);
-
-        // Десериализация данных
-        stream >> mapData.id
-               >> mapData.timestamp
-               >> mapData.date
-               >> mapData.time
-               >> mapData.isValid
-               >> mapData.altitude
-               >> mapData.latitude
-               >> mapData.longitude
-               >> mapData.speed
-               >> mapData.course;
-
-        // Добавляем в список
-        mapDataList.append(mapData);
-    }
+    const QList<NavigationFix> fixes = getNavigationDataFilterValid(filterField, filterValue, sortField, sortOrder, flightName);
 
     // Преобразуем в QVariantList для передачи в QML
     QList<QVariant> variantList;
-    for (const NavigationDataMap &mapData : mapDataList) {
+    variantList.reserve(fixes.size());
+    for (const NavigationFix &fix : fixes) {
         QVariantMap variantMap;
-        variantMap["id"] = mapData.id;
-        variantMap["date"] = mapData.date;
-        variantMap["time"] = mapData.time;
-        variantMap["isValid"] = mapData.isValid;
-        variantMap["altitude"] = mapData.altitude;
-        variantMap["latitude"] = mapData.latitude;
-        variantMap["longitude"] = mapData.longitude;
-        variantMap["speed"] = mapData.speed;
-        variantMap["course"] = mapData.course;
+        variantMap["id"] = fix.id;
+        variantMap["date"] = fix.date;
+        variantMap["time"] = fix.time;
+        variantMap["isValid"] = fix.isValid;
+        variantMap["altitude"] = fix.altitude;
+        variantMap["latitude"] = fix.latitude;
+        variantMap["longitude"] = fix.longitude;
+        variantMap["speed"] = fix.speed;
+        variantMap["course"] = fix.course;
 
         variantList.append(variantMap);
     }
@@ -948,232 +886,176 @@ QString DatabaseManager::mapFilterField(const QString &uiField) {
     return fieldMap.value(uiField, defaultField);
 }
 
-QList<NavigationData> DatabaseManager::getNavigationDataFilter(QString &filterField,
-                                                               QString &filterValue,
-                                                               const QString &sortField,
-                                                               const QString &sortOrder,
-                                                               const QString &flightName)
+bool DatabaseManager::forEachSkyView(const QString &flightName,
+                                     const std::function<void(const SkyView &)> &visitor)
 {
-    QList<NavigationData> navigationDataList;
-
-    // Логирование входных параметров
-    m_logger->log(Logger::Debug,
-                  QString("Запрос данных. Параметры:\n"
-                          " - Поле фильтра: %1\n"
-                          " - Значение фильтра: %2\n"
-                          " - Поле сортировки: %3\n"
-                          " - Направление сортировки: %4\n"
-                          " - Полет: %5")
-                      .arg(filterField)
-                      .arg(filterValue)
-                      .arg(sortField)
-                      .arg(sortOrder)
-                      .arg(flightName));
-
-    // Маппинг полей
-    QString dbSortField = mapSortField(sortField);
-    QString dbFilterField = mapFilterField(filterField);
-
-    // Сброс фильтра при пустом значении
-    if (filterValue.isEmpty()) {
-        m_logger->log(Logger::Debug, "Значение фильтра пусто. Фильтрация отключена.");
-        dbFilterField = "";
-        filterValue = "";
-    }
-
-    // Формирование SQL-запроса
-    QString filterClause = "";
-    if (!dbFilterField.isEmpty() && !filterValue.isEmpty()) {
-        filterClause = QString(" AND %1 = :filter_value").arg(dbFilterField);
-    }
-
-    // Формируем SQL-запрос с параметрами
-    QString queryStr = QString(
-                           "SELECT gnrmc.id AS gnrmc_id, gnrmc.time AS gnrmc_time, gnrmc.date AS gnrmc_date, "
-                           "gnrmc.latitude AS gnrmc_latitude, gnrmc.longitude AS gnrmc_longitude, "
-                           "gnrmc.speed AS gnrmc_speed, gnrmc.course AS gnrmc_course, gnrmc.isValid AS gnrmc_isValid, "
-                           "gngga.altitude AS gngga_altitude, "
-                           "gnzda.time AS gnzda_time, gnzda.date AS gnzda_date, "
-                           "n.id AS n_id, n.timestamp AS n_timestamp "
-                           "FROM navigation_data n "
-                           "LEFT JOIN gnrmc_data gnrmc ON gnrmc.navigation_data_id = n.id "
-                           "LEFT JOIN gnzda_data gnzda ON gnzda.navigation_data_id = n.id "
-                           "LEFT JOIN gngga_data gngga ON gngga.navigation_data_id = n.id "
-                           "WHERE n.flight_name = :flight_name%1 "
-                           "ORDER BY %2 %3")
-                           .arg(filterClause)
-                           .arg(dbSortField)
-                           .arg(sortOrder == "DESC" ? "DESC" : "ASC");
-
     QSqlQuery query;
-    query.prepare(queryStr);
+    query.setForwardOnly(true);
+    query.prepare("SELECT fix_id, satellites FROM sky_view "
+                  "WHERE flight_id = (SELECT id FROM flights WHERE flight_name = ?) "
+                  "ORDER BY fix_id");
+    query.addBindValue(flightName);
 
-    // Привязка параметров
-    query.bindValue(":flight_name", flightName);
+    if (!query.exec()) {
+        logError(QString("Ошибка загрузки обзоров неба полета %1: %2")
+                     .arg(flightName, query.lastError().text()));
+        return false;
+    }
 
-    if (!filterField.isEmpty() && !filterValue.isEmpty()) {
-        query.bindValue(":filter_value", filterValue);
+    SkyView view;
+    while (query.next()) {
+        view.fixId = query.value(0).toInt();
+        if (!view.fromBlob(query.value(1).toByteArray())) {
+            logError(QString("Поврежденный обзор неба эпохи %1").arg(view.fixId));
+            continue;
+        }
+        visitor(view);
     }
+    return true;
+}
+
+std::shared_ptr<FlightColumns> DatabaseManager::loadFlightColumns(const QString &flightName, int afterId)
+{
+    auto columns = std::make_shared<FlightColumns>();
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare("SELECT id, timestamp, date, time, isValid, latitude, longitude, "
+                  "altitude, speed, course "
+                  "FROM navigation_fix "
+                  "WHERE flight_id = (SELECT id FROM flights WHERE flight_name = :flight_name) "
+                  "AND id > :after_id "
+                  "ORDER BY id");
+    query.bindValue(":flight_name", flightName);
+    query.bindValue(":after_id", afterId);
 
-    // Выполнение запроса
     if (!query.exec()) {
-        m_logger->log(Logger::Error,
-                      QString("Ошибка выполнения запроса!\n"
-                              " - Текст ошибки: %1\n")
-                          .arg(query.lastError().text()));
-        return navigationDataList;
+        logError(QString("Ошибка загрузки эпох полета %1: %2")
+                     .arg(flightName, query.lastError().text()));
+        return nullptr;
     }
 
-    // Обработка результатов
     while (query.next()) {
-        NavigationData data;
-        data.id = query.value("n_id").toInt();
-        data.timestamp = QDateTime::fromString(query.value("n_timestamp").toString(), "yyyy-MM-dd hh:mm:ss");
-
-        GNRMCData gnrmc;
-        gnrmc.isValid = query.value("gnrmc_isValid").toInt() ? 1 : 0;
-        gnrmc.latitude = query.value("gnrmc_latitude").toDouble();
-        gnrmc.longitude = query.value("gnrmc_longitude").toDouble();
-        gnrmc.speed = query.value("gnrmc_speed").toDouble();
-        gnrmc.course = query.value("gnrmc_course").toDouble();
-
-        GNGGAData gngga;
-        gngga.altitude = query.value("gngga_altitude").toFloat();
+        NavigationFix fix;
+        fix.id = query.value(0).toInt();
+        fix.timestamp = QDateTime::fromString(query.value(1).toString(), Qt::ISODateWithMs);
+        fix.date = QDate::fromString(query.value(2).toString(), "yyyy-MM-dd");
+        fix.time = QTime::fromString(query.value(3).toString(), "HH:mm:ss.zzz");
+        fix.isValid = query.value(4).toBool();
+        fix.latitude = query.value(5).toDouble();
+        fix.longitude = query.value(6).toDouble();
+        fix.altitude = query.value(7).toFloat();
+        fix.speed = query.value(8).toDouble();
+        fix.course = query.value(9).toDouble();
+        columns->append(fix);
+    }
+    return columns;
+}
 
-        GNZDAData gnzda;
-        gnzda.time = query.value("gnzda_time").toTime();
-        gnzda.date = query.value("gnzda_date").toDate();
+std::shared_ptr<const FlightColumns> DatabaseManager::flightColumns(const QString &flightName)
+{
+    // Число эпох и последний id по индексу (flight_id, id) — без чтения строк
+    QSqlQuery stamp;
+    stamp.prepare("SELECT COUNT(*), COALESCE(MAX(id), 0) FROM navigation_fix "
+                  "WHERE flight_id = (SELECT id FROM flights WHERE flight_name = ?)");
+    stamp.addBindValue(flightName);
+    if (!stamp.exec() || !stamp.next()) {
+        logError("Ошибка проверки кэша полета: " + stamp.lastError().text());
+        return nullptr;
+    }
+    const int rowCount = stamp.value(0).toInt();
+    const int lastId = stamp.value(1).toInt();
 
-        QByteArray byteArray;
-        QDataStream stream(&byteArray, QIODevice::WriteOnly);
-        stream << data.id
-               << data.timestamp
-               << gnzda.date
-               << gnzda.time
-               << gnrmc.isValid
-               << gngga.altitude
-               << gnrmc.latitude
-               << gnrmc.longitude
-               << gnrmc.speed
-               << gnrmc.course;
-        data.data = byteArray;
+    std::shared_ptr<const FlightColumns> cached = m_flightCache.find(flightName);
+    if (cached && cached->size() == rowCount && cached->lastId() == lastId) {
+        return cached;
+    }
 
-        navigationDataList.append(data);
+    std::shared_ptr<FlightColumns> columns;
+    if (cached && cached->size() < rowCount && cached->lastId() < lastId) {
+        // Идет запись полета — догружаем только новые эпохи
+        std::shared_ptr<FlightColumns> tail = loadFlightColumns(flightName, cached->lastId());
+        if (tail && cached->size() + tail->size() == rowCount) {
+            columns = std::make_shared<FlightColumns>(*cached);
+            columns->append(*tail);
+        }
+    }
+    if (!columns) {
+        columns = loadFlightColumns(flightName, 0);
+        if (!columns) {
+            return nullptr;
+        }
     }
 
-    qDebug()<<navigationDataList.count();
+    m_flightCache.insert(flightName, columns);
+    return columns;
+}
 
-    return navigationDataList;
+void DatabaseManager::setFlightCacheLimit(size_t maxBytes)
+{
+    m_flightCache.setMaxBytes(maxBytes);
 }
 
-QList<NavigationData> DatabaseManager::getNavigationDataFilterValid(const QString &filterField,
-                                                                    const QString &filterValue,
-                                                                    const QString &sortField,
-                                                                    const QString &sortOrder,
-                                                                    const QString &flightName)
+QList<NavigationFix> DatabaseManager::getNavigationFixes(const QString &filterField,
+                                                         const QString &filterValue,
+                                                         const QString &sortField,
+                                                         const QString &sortOrder,
+                                                         const QString &flightName,
+                                                         bool validOnly)
 {
-    QList<NavigationData> navigationDataList;
-
-    // Логирование входных параметров
-    m_logger->log(Logger::Debug,
-                  QString("Запрос данных (валидные). Параметры:\n"
-                          " - Поле фильтра: %1\n"
-                          " - Значение фильтра: %2\n"
-                          " - Поле сортировки: %3\n"
-                          " - Направление сортировки: %4\n"
-                          " - Полет: %5")
-                      .arg(filterField)
-                      .arg(filterValue)
-                      .arg(sortField)
-                      .arg(sortOrder)
-                      .arg(flightName));
-
-    // Маппинг полей
-    QString dbSortField = mapSortField(sortField);
-    QString dbFilterField = mapFilterField(filterField);
-
-    // Формирование фильтра
-    QString filterClause = "gnrmc.isValid = 1"; // Основное условие для валидных данных
-    if (!dbFilterField.isEmpty() && !filterValue.isEmpty()) {
-        filterClause += QString(" AND %1 = :filter_value").arg(dbFilterField);
-    }
-
-    // Формируем SQL-запрос
-    QString queryStr = QString(
-                           "SELECT gnrmc.id AS gnrmc_id, gnrmc.time AS gnrmc_time, gnrmc.date AS gnrmc_date, "
-                           "gnrmc.latitude AS gnrmc_latitude, gnrmc.longitude AS gnrmc_longitude, "
-                           "gnrmc.speed AS gnrmc_speed, gnrmc.course AS gnrmc_course, gnrmc.isValid AS gnrmc_isValid, "
-                           "gngga.altitude AS gngga_altitude, "
-                           "gnzda.time AS gnzda_time, gnzda.date AS gnzda_date, "
-                           "n.id AS n_id, n.timestamp AS n_timestamp "
-                           "FROM navigation_data n "
-                           "LEFT JOIN gnrmc_data gnrmc ON gnrmc.navigation_data_id = n.id "
-                           "LEFT JOIN gnzda_data gnzda ON gnzda.navigation_data_id = n.id "
-                           "LEFT JOIN gngga_data gngga ON gngga.navigation_data_id = n.id "
-                           "WHERE n.flight_name = :flight_name AND %1 "  // Добавляем условие валидности
-                           "ORDER BY %2 %3")
-                           .arg(filterClause)
-                           .arg(dbSortField)
-                           .arg(sortOrder == "DESC" ? "DESC" : "ASC");
+    QList<NavigationFix> fixes;
 
-    QSqlQuery query;
-    query.prepare(queryStr);
+    if (m_logger) {
+        m_logger->log(Logger::Debug,
+                      QString("Запрос эпох%1. Параметры:\n"
+                              " - Поле фильтра: %2\n"
+                              " - Значение фильтра: %3\n"
+                              " - Поле сортировки: %4\n"
+                              " - Направление сортировки: %5\n"
+                              " - Полет: %6")
+                          .arg(validOnly ? " (валидные)" : "")
+                          .arg(filterField)
+                          .arg(filterValue)
+                          .arg(sortField)
+                          .arg(sortOrder)
+                          .arg(flightName));
+    }
 
-    // Привязка параметров
-    query.bindValue(":flight_name", flightName);
-    if (!dbFilterField.isEmpty() && !filterValue.isEmpty()) {
-        query.bindValue(":filter_value", filterValue);
+    // Фильтр и сортировка по столбцам в памяти, SQLite читается один раз на полет
+    const std::shared_ptr<const FlightColumns> columns = flightColumns(flightName);
+    if (!columns) {
+        return fixes;
     }
 
-    // Выполнение запроса
-    if (!query.exec()) {
-        m_logger->log(Logger::Error,
-                      QString("Ошибка выполнения запроса!\n"
-                              " - Текст ошибки: %1\n")
-                          .arg(query.lastError().text()));
-        return navigationDataList;
+    const std::vector<int> rows = columns->select(filterField, filterValue, sortField,
+                                                  sortOrder == "DESC", validOnly);
+    fixes.reserve(static_cast<int>(rows.size()));
+    for (int row : rows) {
+        fixes.append(columns->fix(row));
     }
 
-    // Обработка результатов
-    while (query.next()) {
-        NavigationData data;
-        data.id = query.value("n_id").toInt();
-        data.timestamp = QDateTime::fromString(query.value("n_timestamp").toString(), Qt::ISODateWithMs);
-
-        GNRMCData gnrmc;
-        gnrmc.isValid = query.value("gnrmc_isValid").toBool();
-        gnrmc.latitude = query.value("gnrmc_latitude").toDouble();
-        gnrmc.longitude = query.value("gnrmc_longitude").toDouble();
-        gnrmc.speed = query.value("gnrmc_speed").toDouble();
-        gnrmc.course = query.value("gnrmc_course").toDouble();
-
-        GNGGAData gngga;
-        gngga.altitude = query.value("gngga_altitude").toDouble();
-
-        GNZDAData gnzda;
-        gnzda.time = query.value("gnzda_time").toTime();
-        gnzda.date = query.value("gnzda_date").toDate();
-
-        // Сериализация данных
-        QByteArray byteArray;
-        QDataStream stream(&byteArray, QIODevice::WriteOnly);
-        stream << data.id
-               << data.timestamp
-               << gnzda.date
-               << gnzda.time
-               << gnrmc.isValid
-               << gngga.altitude
-               << gnrmc.latitude
-               << gnrmc.longitude
-               << gnrmc.speed
-               << gnrmc.course;
-        data.data = byteArray;
-
-        navigationDataList.append(data);
-    }
-
-    m_logger->log(Logger::Debug, QString("Найдено записей: %1").arg(navigationDataList.count()));
-    return navigationDataList;
+    if (m_logger) {
+        m_logger->log(Logger::Debug, QString("Найдено эпох: %1").arg(fixes.count()));
+    }
+    return fixes;
+}
+
+QList<NavigationFix> DatabaseManager::getNavigationDataFilter(QString &filterField,
+                                                              QString &filterValue,
+                                                              const QString &sortField,
+                                                              const QString &sortOrder,
+                                                              const QString &flightName)
+{
+    return getNavigationFixes(filterField, filterValue, sortField, sortOrder, flightName, false);
+}
+
+QList<NavigationFix> DatabaseManager::getNavigationDataFilterValid(const QString &filterField,
+                                                                   const QString &filterValue,
+                                                                   const QString &sortField,
+                                                                   const QString &sortOrder,
+                                                                   const QString &flightName)
+{
+    return getNavigationFixes(filterField, filterValue, sortField, sortOrder, flightName, true);
 }
 
 // Метод для удаления навигационных данных по ID
@@ -1236,7 +1118,8 @@ QByteArray DatabaseManager::getCompleteFlightData(const QString &flightName) {
 
     // Основные данные навигации
     QSqlQuery navQuery;
-    navQuery.prepare("SELECT * FROM navigation_data WHERE flight_name = ?");
+    navQuery.prepare("SELECT * FROM navigation_data WHERE flight_id = "
+                     "(SELECT id FROM flights WHERE flight_name = ?)");
     navQuery.addBindValue(flightName);
 
     if(navQuery.exec()) {
@@ -1254,7 +1137,8 @@ QByteArray DatabaseManager::getCompleteFlightData(const QString &flightName) {
     for(auto it = tables.constBegin(); it != tables.constEnd(); ++it) {
         QSqlQuery query;
         query.prepare(QString("SELECT * FROM %1 WHERE navigation_data_id IN "
-                              "(SELECT id FROM navigation_data WHERE flight_name = ?)").arg(it.key()));
+                              "(SELECT id FROM navigation_data WHERE flight_id = "
+                              "(SELECT id FROM flights WHERE flight_name = ?))").arg(it.key()));
         query.addBindValue(flightName);
 
         if(query.exec()) {
@@ -1285,7 +1169,8 @@ QString DatabaseManager::getRawFlightData(const QString &flightName) {
     QSqlQuery query;
     foreach (const QString &table, tables) {
         query.prepare(QString("SELECT * FROM %1 WHERE navigation_data_id IN "
-                              "(SELECT id FROM navigation_data WHERE flight_name = ?)").arg(table));
+                              "(SELECT id FROM navigation_data WHERE flight_id = "
+                              "(SELECT id FROM flights WHERE flight_name = ?))").arg(table));
         query.addBindValue(flightName);
 
         if (!query.exec()) {
@@ -1314,7 +1199,8 @@ QString DatabaseManager::getFlightDataAsJson(const QString &flightName) {
     // Пример получения данных из таблицы gnrmc_data
     QSqlQuery query;
     query.prepare("SELECT * FROM gnrmc_data WHERE navigation_data_id IN "
-                  "(SELECT id FROM navigation_data WHERE flight_name = ?)");
+                  "(SELECT id FROM navigation_data WHERE flight_id = "
+                  "(SELECT id FROM flights WHERE flight_name = ?))");
     query.addBindValue(flightName);
 
     if(query.exec()) {
@@ -1332,5 +1218,9 @@ QString DatabaseManager::getFlightDataAsJson(const QString &flightName) {
 
 // Метод для логирования ошибок
 void DatabaseManager::logError(const QString &message) {
-    m_logger->log(Logger::Error, message);
+    if (m_logger) {
+        m_logger->log(Logger::Error, message);
+    } else {
+        qWarning("%s", qUtf8Printable(message));
+    }
 }
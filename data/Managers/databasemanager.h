@@ -1,7 +1,11 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include "databasewriter.h"
+#include "flightcache.h"
 #include "logger.h"
+#include "navigationbatchwriter.h"
+#include "storageprofile.h"
 #include "parsernmea.h"
 
 #include <QObject>
@@ -20,7 +24,9 @@
 #include <QJsonValue>
 #include <QMetaType>
 
-Q_DECLARE_METATYPE(NavigationDataMap)
+#include <functional>
+
+Q_DECLARE_METATYPE(NavigationFix)
 
 class DatabaseManager: public QObject {
     Q_OBJECT
@@ -29,8 +35,10 @@ public:
     DatabaseManager(QObject *parent = nullptr) : QObject(parent) {
         // Инициализация базы данных с некоторым значением по умолчанию
         db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
         //db.setDatabaseName("default.db"); // Установите имя базы данных по умолчанию
         initializeDatabase();
+        setupWriter();
     }
     void setLogger(Logger *logger);
 
@@ -53,29 +61,68 @@ public:
     void close();
     bool createTables(const QVector<QPair<QString, QString>>& tables);
     bool initializeDatabase();
+    bool migrateSchema();
+    int schemaVersion();
     int getLastInsertedId(const QString &tableName);
     int navigationDataId;
 
-    bool saveNavigationData(const NavigationData &data);
+    // rawLine — исходная строка NMEA, нужна фоновому писателю для SpillToFile
+    bool saveNavigationData(const NavigationData &data, const QByteArray &rawLine = QByteArray());
+
+    // Пакетная запись: одна транзакция на maxRecords записей или maxLatencyMs
+    void setBatchMode(bool enabled, int maxRecords, int maxLatencyMs);
+    // Дописывает накопленный пакет и закрывает текущую эпоху
+    bool flushPendingData();
+
+    // Профиль SQLite (журнал, synchronous, кэш, mmap). Фоновый писатель
+    // получает его при следующем запуске
+    bool setStorageProfile(StorageProfile profile);
+    StorageProfile storageProfile() const { return m_storageProfile; }
+
+    // Фоновая запись в отдельном потоке через ограниченную очередь
+    bool startBackgroundWriter(int capacity, DatabaseWriter::OverflowPolicy policy,
+                               const QString &spillPath);
+    // Только когда в базу никто не пишет из других потоков (IngestWorker закрыт):
+    // те вызывают saveNavigationData без блокировок. То же для close()
+    void stopBackgroundWriter();
+    // Только с фоновым писателем saveNavigationData можно вызывать из других потоков
+    bool hasBackgroundWriter() const { return m_backgroundWriter != nullptr; }
+    DatabaseWriter::Stats writerStats() const;
 
     bool deleteFlight(const QString &flightName);
     bool deleteNavigationDataById(int id);
-    bool insertNewFlight();
+    // Без имени рейс называется по времени создания (Flight_yyyyMMdd_HHmmss)
+    bool insertNewFlight(const QString &name = QString());
+    // Полет и имя источника приема (NavigationData::sourceId); полет создается,
+    // если его еще нет. Пустой flightName — источник пишет в текущий полет
+    bool setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName = QString());
+    void closeSource(int sourceId);
 
     Q_INVOKABLE QList<QString> getAllFlights();
+    // Последний полет в таблице; полеты источников (setSourceFlight) тоже считаются
     QString getLastFlight();
+    // Полет, созданный последним insertNewFlight
+    QString currentFlight() const { return flight_name; }
     Q_INVOKABLE QList<QVariant> getAllFlightsMap();
     Q_INVOKABLE QList<QVariant> getNavigationDataMap();
-    QList<NavigationData> getNavigationDataFilter(QString &filterField,
-                                                QString &filterValue,
-                                                const QString &sortField,
-                                                const QString &sortOrder,
-                                                const QString &flightName);
-    QList<NavigationData> getNavigationDataFilterValid(const QString &filterField,
-                                                       const QString &filterValue,
-                                                       const QString &sortField,
-                                                       const QString &sortOrder,
-                                                       const QString &flightName);
+    // Эпохи полета (одна запись на момент времени) из кэша полетов
+    QList<NavigationFix> getNavigationDataFilter(QString &filterField,
+                                                 QString &filterValue,
+                                                 const QString &sortField,
+                                                 const QString &sortOrder,
+                                                 const QString &flightName);
+    QList<NavigationFix> getNavigationDataFilterValid(const QString &filterField,
+                                                      const QString &filterValue,
+                                                      const QString &sortField,
+                                                      const QString &sortOrder,
+                                                      const QString &flightName);
+    // Столбцы полета из кэша; при записи полета догружаются новые эпохи
+    std::shared_ptr<const FlightColumns> flightColumns(const QString &flightName);
+    // Обзоры неба полета по порядку эпох. SkyView переиспользуется между
+    // вызовами visitor — копировать его только при необходимости
+    bool forEachSkyView(const QString &flightName,
+                        const std::function<void(const SkyView &)> &visitor);
+    void setFlightCacheLimit(size_t maxBytes);
     QString mapSortField(const QString &uiField);
     QString mapFilterField(const QString &uiField);
     NavigationData getLatestNavigationData();
@@ -88,6 +135,7 @@ signals:
     void databaseOpened();
     void databaseError(const QString &error);
     void dataLoaded(const QList<QVariant> &data);
+    void batchCommitted(int rows, double rowsPerSecond);
 
 public slots:
     void getNavigationDataFilterValidMap(const QString &filterField,
@@ -98,17 +146,30 @@ public slots:
 
 private:
     QVector<QPair<QString, QString>> m_tables;
+    static const QVector<QStringList> &schemaMigrations();
+    QList<NavigationFix> getNavigationFixes(const QString &filterField,
+                                            const QString &filterValue,
+                                            const QString &sortField,
+                                            const QString &sortOrder,
+                                            const QString &flightName,
+                                            bool validOnly);
+    std::shared_ptr<FlightColumns> loadFlightColumns(const QString &flightName, int afterId);
+    FlightCache m_flightCache;
     struct {
         int totalQueries = 0;
         int failedQueries = 0;
         QMap<QString, int> queryCounts;
     } stats;
 
-    int currentNavId;
     QString flight_name;
-    QString firstType;
     ParserNMEA parser;
-    Logger *m_logger;
+    Logger *m_logger = nullptr;
+    NavigationBatchWriter *m_writer = nullptr;
+    DatabaseWriter *m_backgroundWriter = nullptr;
+    StorageProfile m_storageProfile = StorageProfile::Safe;
+    int m_batchMaxRecords = 500;
+    int m_batchMaxLatencyMs = 250;
+    void setupWriter();
     void logError(const QString &message);
     QSqlDatabase db;
 };
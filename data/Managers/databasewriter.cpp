@@ -0,0 +1,290 @@
+#include "databasewriter.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+
+namespace {
+const char *const WRITER_CONNECTION = "cometa_writer";
+// Ожидание места в очереди для политики Block
+constexpr unsigned long BLOCK_WAIT_US = 200;
+}
+
+DatabaseWriter::DatabaseWriter(const QString &databasePath, int capacity,
+                               OverflowPolicy policy, const QString &spillPath,
+                               QObject *parent)
+    : QObject(parent),
+    m_databasePath(databasePath),
+    m_connectionName(QLatin1String(WRITER_CONNECTION)),
+    m_policy(policy),
+    m_queue(static_cast<size_t>(qMax(2, capacity)))
+{
+    m_thread.setObjectName("DatabaseWriter");
+    m_context.moveToThread(&m_thread);
+
+    if (m_policy == SpillToFile) {
+        QDir().mkpath(QFileInfo(spillPath).absolutePath());
+        m_spillFile.setFileName(spillPath);
+    }
+}
+
+DatabaseWriter::~DatabaseWriter()
+{
+    stop();
+}
+
+void DatabaseWriter::setLogger(Logger *logger)
+{
+    m_logger = logger;
+}
+
+DatabaseWriter::OverflowPolicy DatabaseWriter::policyFromString(const QString &name)
+{
+    if (name == "drop-oldest") {
+        return DropOldest;
+    }
+    if (name == "spill") {
+        return SpillToFile;
+    }
+    return Block;
+}
+
+bool DatabaseWriter::start()
+{
+    if (m_thread.isRunning()) {
+        return true;
+    }
+
+    m_thread.start();
+
+    bool opened = false;
+    QMetaObject::invokeMethod(&m_context, [this, &opened]() {
+        opened = openConnection();
+    }, Qt::BlockingQueuedConnection);
+
+    if (!opened) {
+        m_thread.quit();
+        m_thread.wait();
+    }
+    return opened;
+}
+
+void DatabaseWriter::stop()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    // Дописываем все, что осталось в очереди, и закрываем соединение
+    QMetaObject::invokeMethod(&m_context, [this]() {
+        drainQueue();
+        closeConnection();
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+
+    QMutexLocker locker(&m_spillMutex);
+    if (m_spillFile.isOpen()) {
+        m_spillFile.close();
+    }
+}
+
+bool DatabaseWriter::openConnection()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        db.setDatabaseName(m_databasePath);
+        // Соединение интерфейса может читать во время записи — ждем, а не падаем
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        if (!db.open()) {
+            if (m_logger) {
+                m_logger->log(Logger::Error, "Writer connection failed: " + db.lastError().text());
+            }
+            return false;
+        }
+
+        QString error;
+        if (!applyStorageProfile(db, m_profile, &error) && m_logger) {
+            m_logger->log(Logger::Warning, "Writer storage profile: " + error);
+        }
+    }
+
+    m_batch = new NavigationBatchWriter(m_connectionName);
+    m_batch->setLogger(m_logger);
+    connect(m_batch, &NavigationBatchWriter::batchCommitted,
+            this, &DatabaseWriter::batchCommitted);
+
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Database writer thread started (queue %1, policy %2)")
+                                        .arg(m_queue.capacity())
+                                        .arg(m_policy));
+    }
+    return true;
+}
+
+void DatabaseWriter::closeConnection()
+{
+    if (m_batch) {
+        m_batch->flush(true);
+        m_batch->resetStatements();
+        delete m_batch;
+        m_batch = nullptr;
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+
+    if (m_logger) {
+        const Stats s = stats();
+        m_logger->log(Logger::Info, QString("Database writer stopped: %1 written, %2 dropped, %3 spilled, max queue depth %4")
+                                        .arg(s.written)
+                                        .arg(s.dropped)
+                                        .arg(s.spilled)
+                                        .arg(s.maxQueueDepth));
+    }
+}
+
+bool DatabaseWriter::enqueue(const NavigationData &data, const QByteArray &rawLine)
+{
+    while (!m_queue.tryPush(data)) {
+        switch (m_policy) {
+        case Block:
+            scheduleDrain();
+            QThread::usleep(BLOCK_WAIT_US);
+            break;
+
+        case DropOldest: {
+            NavigationData oldest;
+            if (m_queue.tryPop(oldest)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+
+        case SpillToFile:
+            return spill(rawLine);
+        }
+    }
+
+    m_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    const int depth = static_cast<int>(m_queue.sizeApprox());
+    int maxDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    while (depth > maxDepth &&
+           !m_maxQueueDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {
+    }
+
+    scheduleDrain();
+    return true;
+}
+
+void DatabaseWriter::scheduleDrain()
+{
+    // Одно ожидающее пробуждение на любое число записей
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(&m_context, [this]() { drainQueue(); }, Qt::QueuedConnection);
+    }
+}
+
+void DatabaseWriter::drainQueue()
+{
+    m_drainScheduled.store(false, std::memory_order_release);
+    if (!m_batch) {
+        return;
+    }
+
+    NavigationData data;
+    while (m_queue.tryPop(data)) {
+        if (m_batch->write(data)) {
+            m_written.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool DatabaseWriter::spill(const QByteArray &rawLine)
+{
+    m_spilled.fetch_add(1, std::memory_order_relaxed);
+    if (rawLine.isEmpty()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_spillMutex);
+    if (!m_spillFile.isOpen() && !m_spillFile.open(QIODevice::Append)) {
+        return false;
+    }
+    // Формат совпадает с логом приема: файл можно импортировать повторно
+    return m_spillFile.write(rawLine) == rawLine.size() && m_spillFile.write("\r\n", 2) == 2;
+}
+
+void DatabaseWriter::setFlightName(const QString &flightName)
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    // Записи, поставленные до смены полета, уже в очереди и попадут в старый полет.
+    // Ждем применения: записи после возврата должны попасть уже в новый
+    QMetaObject::invokeMethod(&m_context, [this, flightName]() {
+        drainQueue();
+        if (m_batch) m_batch->setFlightName(flightName);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void DatabaseWriter::setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName)
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    // Источник открывается сразу после вызова — его первые записи не должны
+    // обогнать контекст и уйти в полет по умолчанию
+    QMetaObject::invokeMethod(&m_context, [this, sourceId, sourceName, flightName]() {
+        drainQueue();
+        if (m_batch) m_batch->setSourceFlight(sourceId, sourceName, flightName);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void DatabaseWriter::closeSource(int sourceId)
+{
+    QMetaObject::invokeMethod(&m_context, [this, sourceId]() {
+        drainQueue();
+        if (m_batch) m_batch->closeSource(sourceId);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWriter::setBatchMode(bool enabled, int maxRecords, int maxLatencyMs)
+{
+    QMetaObject::invokeMethod(&m_context, [this, enabled, maxRecords, maxLatencyMs]() {
+        drainQueue();
+        if (m_batch) m_batch->setBatchMode(enabled, maxRecords, maxLatencyMs);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWriter::flush()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(&m_context, [this]() {
+        drainQueue();
+        if (m_batch) m_batch->flush(true);
+    }, Qt::BlockingQueuedConnection);
+}
+
+DatabaseWriter::Stats DatabaseWriter::stats() const
+{
+    Stats s;
+    s.enqueued = m_enqueued.load(std::memory_order_relaxed);
+    s.written = m_written.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    s.spilled = m_spilled.load(std::memory_order_relaxed);
+    s.queueDepth = static_cast<int>(m_queue.sizeApprox());
+    s.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    return s;
+}
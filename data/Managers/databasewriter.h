@@ -0,0 +1,104 @@
+#ifndef DATABASEWRITER_H
+#define DATABASEWRITER_H
+
+#include "boundedqueue.h"
+#include "logger.h"
+#include "navigationbatchwriter.h"
+#include "storageprofile.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+
+// Фоновая запись в БД: отдельный поток со своим соединением QSqlDatabase.
+// Поток приема только кладет разобранные записи в ограниченную очередь,
+// поэтому медленный fsync больше не останавливает интерфейс и прием байтов.
+class DatabaseWriter : public QObject {
+    Q_OBJECT
+
+public:
+    // Что делать, если очередь заполнена
+    enum OverflowPolicy {
+        Block,      // Ждать, пока поток записи освободит место
+        DropOldest, // Вытеснить самую старую запись
+        SpillToFile // Сохранить исходную строку NMEA в файл для повторного импорта
+    };
+    Q_ENUM(OverflowPolicy)
+
+    struct Stats {
+        quint64 enqueued = 0;
+        quint64 written = 0;
+        quint64 dropped = 0;
+        quint64 spilled = 0;
+        int queueDepth = 0;
+        int maxQueueDepth = 0;
+    };
+
+    DatabaseWriter(const QString &databasePath, int capacity,
+                   OverflowPolicy policy, const QString &spillPath,
+                   QObject *parent = nullptr);
+    ~DatabaseWriter();
+
+    void setLogger(Logger *logger);
+    // Применяется к соединению потока записи при start()
+    void setStorageProfile(StorageProfile profile) { m_profile = profile; }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return m_thread.isRunning(); }
+
+    // Вызывается из потока приема. rawLine — исходная строка для SpillToFile,
+    // используется только внутри вызова и может ссылаться на чужой буфер
+    bool enqueue(const NavigationData &data, const QByteArray &rawLine = QByteArray());
+
+    // Настройки применяются в потоке записи после уже поставленных в очередь записей.
+    // Смена полета ждет применения — записи после возврата идут в новый полет
+    void setFlightName(const QString &flightName);
+    void setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName);
+    void closeSource(int sourceId);
+    void setBatchMode(bool enabled, int maxRecords, int maxLatencyMs);
+    void flush();
+
+    Stats stats() const;
+    OverflowPolicy policy() const { return m_policy; }
+
+    static OverflowPolicy policyFromString(const QString &name);
+
+signals:
+    void batchCommitted(int rows, double rowsPerSecond);
+
+private:
+    // Выполняются только в потоке записи
+    bool openConnection();
+    void closeConnection();
+    void drainQueue();
+
+    void scheduleDrain();
+    bool spill(const QByteArray &rawLine);
+
+    QString m_databasePath;
+    QString m_connectionName;
+    OverflowPolicy m_policy;
+    StorageProfile m_profile = StorageProfile::Safe;
+    BoundedQueue<NavigationData> m_queue;
+
+    QThread m_thread;
+    QObject m_context; // Живет в потоке записи, через него вызываются методы потока
+    NavigationBatchWriter *m_batch = nullptr;
+
+    QFile m_spillFile;
+    QMutex m_spillMutex;
+    Logger *m_logger = nullptr;
+
+    std::atomic<bool> m_drainScheduled{false};
+    std::atomic<quint64> m_enqueued{0};
+    std::atomic<quint64> m_written{0}; // Передано в NavigationBatchWriter
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_spilled{0};
+    std::atomic<int> m_maxQueueDepth{0};
+};
+
+#endif // DATABASEWRITER_H
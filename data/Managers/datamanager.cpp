@@ -6,109 +6,52 @@
 #include <QProgressDialog>
 
 DataManager::DataManager(DatabaseManager *dbManager, QObject *parent)
-    : QObject(parent), dbManager(dbManager) {
+    : QObject(parent), dbManager(dbManager),
+    m_importer(new LogImporter(dbManager, this)) {
 
+    connect(m_importer, &LogImporter::finished, this, &DataManager::finishProcessing);
+    connect(m_importer, &LogImporter::errorOccurred, this, &DataManager::errorOccurred);
 }
 
-// В реализации DataManager.cpp:
+// Разбор идет в пуле потоков, запись — в порядке строк файла
 void DataManager::processLogFile(const QString& filePath) {
     if (isProcessing) return;
-    isProcessing = true;
 
-    parser.setLogger(m_logger);
+    startTime = std::chrono::high_resolution_clock::now();
+    dbManager->insertNewFlight();
 
-    try {
-        currentFile = new QFile(filePath);
-        if (!currentFile->open(QIODevice::ReadOnly | QIODevice::Text)) {
-            emit errorOccurred("Не удалось открыть файл.");
-            delete currentFile;
-            currentFile = nullptr;
-            isProcessing = false;
-            return;
-        }
-
-        startTime = std::chrono::high_resolution_clock::now();
-        dbManager->insertNewFlight();
-
-        processedCount = 0;
-        savedCount = 0;
-        minLatitude = std::numeric_limits<double>::max();
-        maxLatitude = std::numeric_limits<double>::lowest();
-        minLongtitude = std::numeric_limits<double>::max();
-        maxLongtitude = std::numeric_limits<double>::lowest();
-        minAltitude = std::numeric_limits<double>::max();
-        maxAltitude = std::numeric_limits<double>::lowest();
-
-        QTimer::singleShot(0, this, &DataManager::processNextBlock);
-    } catch (const std::exception& e) {
-        emit errorOccurred("Ошибка обработки файла: " + QString::fromStdString(e.what()));
-        isProcessing = false;
-    }
+    isProcessing = m_importer->start(filePath);
 }
 
-void DataManager::processNextBlock() {
-    if (!currentFile || !currentFile->isOpen()) {
-        finishProcessing();
-        return;
-    }
-
-    const int blockSize = 8192;
-    QByteArray buffer = currentFile->read(blockSize);
-    if (buffer.isEmpty()) {
-        finishProcessing();
-        return;
-    }
-
-    QList<QString> lines = QString(buffer).split('\n', QString::SkipEmptyParts);
-    for (QString& line : lines) {
-        NavigationData navData = parser.parseData(line);
-        m_logger->log(Logger::Info, "Processed:\n" + line);
-        processedCount++;
-        if (navData.result == OK) {
-            saveNavigationData(navData);
-            savedCount++;
-
-            if (navData.type == GNGGA) {
-                GNGGAData gngga;
-                QDataStream stream(&navData.data, QIODevice::ReadOnly);
-                stream >> gngga.latitude >> gngga.longitude
-                    >> gngga.satellitesCount >> gngga.HDOP >> gngga.altitude;
-
-                minLatitude = std::min(minLatitude, static_cast<double>(gngga.latitude));
-                maxLatitude = std::max(maxLatitude, static_cast<double>(gngga.latitude));
-                minLongtitude = std::min(minLongtitude, static_cast<double>(gngga.longitude));
-                maxLongtitude = std::max(maxLongtitude, static_cast<double>(gngga.longitude));
-                minAltitude = std::min(minAltitude, static_cast<double>(gngga.altitude));
-                maxAltitude = std::max(maxAltitude, static_cast<double>(gngga.altitude));
-            }
-        }
-    }
-
-    QTimer::singleShot(0, this, &DataManager::processNextBlock);
+void DataManager::cancelProcessing() {
+    m_importer->cancel();
 }
 
-void DataManager::finishProcessing() {
-    currentFile->close();
-    delete currentFile;
-    currentFile = nullptr;
+void DataManager::finishProcessing(bool cancelled) {
+    // Дописываем последний неполный пакет до подсчета времени
+    dbManager->flushPendingData();
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - startTime;
 
-    QString summary = QString("Обработка завершена.\n")
-                      + QString("Самая низкая высота: %1 метров\n").arg(minAltitude)
-                      + QString("Самая высокая высота: %1\n").arg(maxAltitude)
-                      + QString("Самая низкая широта: %1\n").arg(minLatitude)
-                      + QString("Самая высокая широта: %1\n").arg(maxLatitude)
-                      + QString("Самая низкая долгота: %1\n").arg(minLongtitude)
-                      + QString("Самая высокая долгота: %1\n").arg(maxLongtitude)
-                      + QString("Обработано пакетов: %1\n").arg(savedCount)
-                      + QString("Обработка файла заняла %1 секунд.").arg(duration.count());
+    const LogImporter::Stats &stats = m_importer->stats();
+    QString summary = QString(cancelled ? "Обработка прервана.\n" : "Обработка завершена.\n");
+    if (stats.hasPosition) {
+        summary += QString("Самая низкая высота: %1 метров\n").arg(stats.minAltitude)
+                   + QString("Самая высокая высота: %1\n").arg(stats.maxAltitude)
+                   + QString("Самая низкая широта: %1\n").arg(stats.minLatitude)
+                   + QString("Самая высокая широта: %1\n").arg(stats.maxLatitude)
+                   + QString("Самая низкая долгота: %1\n").arg(stats.minLongitude)
+                   + QString("Самая высокая долгота: %1\n").arg(stats.maxLongitude);
+    }
+    summary += QString("Обработано пакетов: %1\n").arg(stats.saved)
+               + QString("Ошибок разбора: %1\n").arg(stats.errors)
+               + QString("Обработка файла заняла %1 секунд.").arg(duration.count());
 
     QMetaObject::invokeMethod(this, "showSummaryMessage",
                               Qt::QueuedConnection, Q_ARG(QString, summary));
 
-    emit dataProcessed(processedCount, savedCount, duration);
+    emit dataProcessed(stats.lines, stats.saved, duration);
     isProcessing = false;
 }
 
@@ -119,9 +62,9 @@ void DataManager::showSummaryMessage(const QString& summary) {
     msgBox.exec();
 }
 
-void DataManager::saveNavigationData(const NavigationData &navData) {
+void DataManager::saveNavigationData(const NavigationData &navData, const QByteArray &rawLine) {
     try {
-        if (!dbManager->saveNavigationData(navData)) {
+        if (!dbManager->saveNavigationData(navData, rawLine)) {
             emit errorOccurred("Не удалось сохранить навигационные данные для типа: " + QString::number(navData.type));
         }
     } catch (const std::exception &e) {
@@ -133,30 +76,29 @@ void DataManager::saveFile(const QString &flightName) {
     QString dirPath = QDir::currentPath() + "/data"; // Путь к директории
     QDir().mkpath(dirPath); // Создаем директорию, если она не существует
 
-    filePath = dirPath + "/" + flightName + ".bin"; // Путь к файлу с именем полета
+    if (!m_capture.open(dirPath + "/" + flightName + ".bin")) { // Путь к файлу с именем полета
+        emit errorOccurred("Не удалось открыть файл записи потока для полета " + flightName);
+    }
+}
+
+void DataManager::closeFile() {
+    m_capture.close();
+}
+
+void DataManager::setCaptureOptions(int flushBytes, int flushIntervalMs, int maxBufferedBytes,
+                                    RawCaptureRecorder::SyncPolicy syncPolicy, bool timestamps) {
+    m_capture.setThresholds(flushBytes, flushIntervalMs, maxBufferedBytes);
+    m_capture.setSyncPolicy(syncPolicy);
+    m_capture.setTimestamps(timestamps);
 }
 
 void DataManager::setLogger(Logger *logger) {
     m_logger = logger;
+    m_importer->setLogger(logger);
+    m_capture.setLogger(logger);
 }
 
 void DataManager::writeDataToFile(const QByteArray &data) {
-    QFile file(filePath);
-
-    if (!file.open(QIODevice::Append | QIODevice::WriteOnly)) {
-        m_logger->log(Logger::Error, // Добавляем уровень ошибки
-                    "Не удалось открыть файл для записи: " + file.errorString());
-        return;
-    }
-
-    qint64 bytesWritten = file.write(data);
-    if (bytesWritten == -1) {
-        m_logger->log(Logger::Error, // Добавляем уровень ошибки
-                    "Ошибка записи в файл: " + file.errorString());
-    } else {
-        m_logger->log(Logger::Debug, // Добавляем уровень отладки
-                    QString("Записано %1 байт в файл").arg(bytesWritten));
-    }
-
-    file.close();
+    // Только копия в буфер: файл открыт, на диск пишет поток записи
+    m_capture.write(data);
 }
@@ -4,7 +4,8 @@
 #include "databasemanager.h"
 #include "formatnavigationdata.h"
 #include "logger.h"
-#include "parsernmea.h"
+#include "logimporter.h"
+#include "rawcapturerecorder.h"
 
 #include <QObject>
 #include <QFile>
@@ -20,9 +21,18 @@ public:
     void processLogFile(const QString &filePath);
     void cancelProcessing();
 
-    void saveNavigationData(const NavigationData &navData);
+    void saveNavigationData(const NavigationData &navData, const QByteArray &rawLine = QByteArray());
+    // Сырой поток приема пишется в data/<полет>.bin фоновым потоком,
+    // порции — с метками времени приема
     void writeDataToFile(const QByteArray &data);
     void saveFile(const QString &flightName);
+    void closeFile();
+    void setCaptureOptions(int flushBytes, int flushIntervalMs, int maxBufferedBytes,
+                           RawCaptureRecorder::SyncPolicy syncPolicy, bool timestamps = true);
+    RawCaptureRecorder::Stats captureStats() const { return m_capture.stats(); }
+    // Потребители записей для потока приема
+    RawCaptureRecorder *captureRecorder() { return &m_capture; }
+    DatabaseManager *databaseManager() const { return dbManager; }
     void setLogger(Logger *logger);
 
 signals:
@@ -30,29 +40,18 @@ signals:
     void errorOccurred(const QString &error);
 
 private:
-    QFile* currentFile = nullptr;
-    qint64 filePosition = 0;
-    int processedCount = 0;
-    int savedCount = 0;
-    double minLatitude;
-    double maxLatitude;
-    double minLongtitude;
-    double maxLongtitude;
-    double minAltitude;
-    double maxAltitude;
     std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
     bool isProcessing = false;
 
-    void processNextBlock();
-    void finishProcessing();
-    void showSummaryMessage(const QString& summary);
+    void finishProcessing(bool cancelled);
+    Q_INVOKABLE void showSummaryMessage(const QString& summary);
 
     QThread m_workerThread;
-    QString filePath;
+    RawCaptureRecorder m_capture;
     NavigationDataFormatter *formatNavigation;
     DatabaseManager *dbManager;
-    ParserNMEA parser;
-    Logger *m_logger;
+    LogImporter *m_importer;
+    Logger *m_logger = nullptr;
 };
 
 #endif // DATAMANAGER_H
@@ -0,0 +1,271 @@
+#include "flightcache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const double NO_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+template <typename T>
+size_t columnBytes(const std::vector<T> &column)
+{
+    return column.capacity() * sizeof(T);
+}
+}
+
+void FlightColumns::reserve(int rows)
+{
+    const size_t n = static_cast<size_t>(rows);
+    id.reserve(n);
+    received.reserve(n);
+    time.reserve(n);
+    date.reserve(n);
+    latitude.reserve(n);
+    longitude.reserve(n);
+    altitude.reserve(n);
+    speed.reserve(n);
+    course.reserve(n);
+    validBits.reserve((n + 63) / 64);
+}
+
+void FlightColumns::append(const NavigationFix &fix)
+{
+    const int row = size();
+
+    id.push_back(fix.id);
+    received.push_back(fix.timestamp.isValid()
+                           ? static_cast<double>(fix.timestamp.toMSecsSinceEpoch())
+                           : NO_VALUE);
+    time.push_back(fix.time.isValid() ? static_cast<double>(fix.time.msecsSinceStartOfDay()) : NO_VALUE);
+    date.push_back(fix.date.isValid() ? static_cast<int>(fix.date.toJulianDay()) : NoDate);
+    latitude.push_back(fix.latitude);
+    longitude.push_back(fix.longitude);
+    altitude.push_back(fix.altitude);
+    speed.push_back(fix.speed);
+    course.push_back(fix.course);
+
+    if ((row & 63) == 0) {
+        validBits.push_back(0);
+    }
+    if (fix.isValid) {
+        validBits[row >> 6] |= quint64(1) << (row & 63);
+    }
+}
+
+void FlightColumns::append(const FlightColumns &other)
+{
+    const int offset = size();
+    id.insert(id.end(), other.id.begin(), other.id.end());
+    received.insert(received.end(), other.received.begin(), other.received.end());
+    time.insert(time.end(), other.time.begin(), other.time.end());
+    date.insert(date.end(), other.date.begin(), other.date.end());
+    latitude.insert(latitude.end(), other.latitude.begin(), other.latitude.end());
+    longitude.insert(longitude.end(), other.longitude.begin(), other.longitude.end());
+    altitude.insert(altitude.end(), other.altitude.begin(), other.altitude.end());
+    speed.insert(speed.end(), other.speed.begin(), other.speed.end());
+    course.insert(course.end(), other.course.begin(), other.course.end());
+
+    validBits.resize((static_cast<size_t>(size()) + 63) / 64, 0);
+    for (int row = 0; row < other.size(); ++row) {
+        if (other.isValid(row)) {
+            const int target = offset + row;
+            validBits[target >> 6] |= quint64(1) << (target & 63);
+        }
+    }
+}
+
+NavigationFix FlightColumns::fix(int row) const
+{
+    NavigationFix fix;
+    fix.id = id[row];
+    if (!std::isnan(received[row])) {
+        fix.timestamp = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(received[row]));
+    }
+    if (!std::isnan(time[row])) {
+        fix.time = QTime::fromMSecsSinceStartOfDay(static_cast<int>(time[row]));
+    }
+    if (date[row] != NoDate) {
+        fix.date = QDate::fromJulianDay(date[row]);
+    }
+    fix.isValid = isValid(row);
+    fix.latitude = latitude[row];
+    fix.longitude = longitude[row];
+    fix.altitude = static_cast<float>(altitude[row]);
+    fix.speed = speed[row];
+    fix.course = course[row];
+    return fix;
+}
+
+size_t FlightColumns::memoryBytes() const
+{
+    return columnBytes(id) + columnBytes(received) + columnBytes(time) + columnBytes(date)
+           + columnBytes(latitude) + columnBytes(longitude) + columnBytes(altitude)
+           + columnBytes(speed) + columnBytes(course) + columnBytes(validBits);
+}
+
+bool FlightColumns::fieldFromName(const QString &name, Field &field)
+{
+    // Поля сортировки приходят в нижнем регистре, поля фильтра — с заглавной
+    static const QHash<QString, Field> fields = {
+        {"id",        Id},
+        {"timestamp", Received},
+        {"time",      Time},
+        {"date",      Date},
+        {"latitude",  Latitude},
+        {"longitude", Longitude},
+        {"altitude",  Altitude},
+        {"speed",     Speed},
+        {"course",    Course},
+        {"isvalid",   Valid}
+    };
+
+    const auto it = fields.constFind(name.toLower());
+    if (it == fields.constEnd()) {
+        return false;
+    }
+    field = it.value();
+    return true;
+}
+
+double FlightColumns::value(Field field, int row) const
+{
+    switch (field) {
+    case Id:        return id[row];
+    case Received:  return received[row];
+    case Time:      return time[row];
+    case Date:      return date[row] != NoDate ? static_cast<double>(date[row]) : NO_VALUE;
+    case Latitude:  return latitude[row];
+    case Longitude: return longitude[row];
+    case Altitude:  return altitude[row];
+    case Speed:     return speed[row];
+    case Course:    return course[row];
+    case Valid:     return isValid(row) ? 1.0 : 0.0;
+    }
+    return NO_VALUE;
+}
+
+bool FlightColumns::matches(Field field, int row, const QString &filterValue) const
+{
+    switch (field) {
+    case Date: {
+        const QDate d = QDate::fromString(filterValue, Qt::ISODate);
+        return d.isValid() && date[row] != NoDate && date[row] == d.toJulianDay();
+    }
+    case Time: {
+        const QTime t = QTime::fromString(filterValue, Qt::ISODateWithMs);
+        return t.isValid() && !std::isnan(time[row]) && time[row] == t.msecsSinceStartOfDay();
+    }
+    case Received: {
+        const QDateTime dt = QDateTime::fromString(filterValue, Qt::ISODateWithMs);
+        return dt.isValid() && received[row] == static_cast<double>(dt.toMSecsSinceEpoch());
+    }
+    default: {
+        bool ok = false;
+        const double number = filterValue.toDouble(&ok);
+        if (field == Altitude) {
+            // Высота хранится как float — сравниваем с той же точностью
+            return ok && static_cast<float>(number) == static_cast<float>(altitude[row]);
+        }
+        return ok && value(field, row) == number;
+    }
+    }
+}
+
+std::vector<int> FlightColumns::select(const QString &filterField, const QString &filterValue,
+                                       const QString &sortField, bool descending,
+                                       bool validOnly) const
+{
+    Field filter = Id;
+    const bool filtered = !filterValue.isEmpty() && fieldFromName(filterField, filter);
+
+    std::vector<int> rows;
+    rows.reserve(id.size());
+    for (int row = 0; row < size(); ++row) {
+        if (validOnly && !isValid(row)) continue;
+        if (filtered && !matches(filter, row, filterValue)) continue;
+        rows.push_back(row);
+    }
+
+    Field sort = Id;
+    if (!fieldFromName(sortField, sort)) {
+        sort = Id;
+    }
+
+    // Строки уже упорядочены по id; неизвестное время (NaN) — как NULL в SQLite, в начале
+    if (sort == Id) {
+        if (descending) std::reverse(rows.begin(), rows.end());
+    } else {
+        std::stable_sort(rows.begin(), rows.end(), [this, sort, descending](int a, int b) {
+            const double va = value(sort, a);
+            const double vb = value(sort, b);
+            if (std::isnan(va) || std::isnan(vb)) {
+                return descending ? std::isnan(vb) && !std::isnan(va)
+                                  : std::isnan(va) && !std::isnan(vb);
+            }
+            return descending ? va > vb : va < vb;
+        });
+    }
+    return rows;
+}
+
+FlightCache::FlightCache(size_t maxBytes)
+    : m_maxBytes(maxBytes)
+{
+}
+
+void FlightCache::setMaxBytes(size_t maxBytes)
+{
+    m_maxBytes = maxBytes;
+    evict();
+}
+
+std::shared_ptr<const FlightColumns> FlightCache::find(const QString &flightName)
+{
+    const auto it = m_flights.constFind(flightName);
+    if (it == m_flights.constEnd()) {
+        return nullptr;
+    }
+    m_order.removeOne(flightName);
+    m_order.append(flightName);
+    return it.value();
+}
+
+void FlightCache::insert(const QString &flightName, std::shared_ptr<const FlightColumns> columns)
+{
+    invalidate(flightName);
+    if (!columns) {
+        return;
+    }
+
+    m_bytes += columns->memoryBytes();
+    m_flights.insert(flightName, std::move(columns));
+    m_order.append(flightName);
+    evict();
+}
+
+void FlightCache::invalidate(const QString &flightName)
+{
+    const auto it = m_flights.find(flightName);
+    if (it == m_flights.end()) {
+        return;
+    }
+    m_bytes -= it.value()->memoryBytes();
+    m_flights.erase(it);
+    m_order.removeOne(flightName);
+}
+
+void FlightCache::clear()
+{
+    m_flights.clear();
+    m_order.clear();
+    m_bytes = 0;
+}
+
+void FlightCache::evict()
+{
+    // Последний загруженный полет остается, даже если он один больше лимита
+    while (m_bytes > m_maxBytes && m_order.size() > 1) {
+        invalidate(m_order.first());
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef FLIGHTCACHE_H
+#define FLIGHTCACHE_H
+
+#include "NavigationData.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Эпохи одного полета в виде столбцов (structure-of-arrays).
+// Хранятся только поля, которые показывают вкладки: графики, 3D, карта,
+// таблица и отчет. Время суток и дата эпохи хранятся отдельно, как в
+// navigation_fix: у приемников только с GGA и у эпох до первого RMC/ZDA
+// дата неизвестна, а время суток есть.
+struct FlightColumns {
+    enum Field {
+        Id,
+        Received,
+        Time,
+        Date,
+        Latitude,
+        Longitude,
+        Altitude,
+        Speed,
+        Course,
+        Valid
+    };
+
+    std::vector<int> id;
+    std::vector<double> received; // время приема, мс
+    std::vector<double> time;     // время суток UTC, мс от полуночи (NaN — неизвестно)
+    std::vector<int> date;        // QDate::toJulianDay() (NoDate — неизвестна)
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    std::vector<double> altitude;
+    std::vector<double> speed;
+    std::vector<double> course;
+    std::vector<quint64> validBits; // бит на эпоху
+
+    static constexpr int NoDate = std::numeric_limits<int>::min();
+
+    int size() const { return static_cast<int>(id.size()); }
+    bool isValid(int row) const { return (validBits[row >> 6] >> (row & 63)) & 1u; }
+    int lastId() const { return id.empty() ? 0 : id.back(); }
+
+    void reserve(int rows);
+    void append(const NavigationFix &fix);
+    void append(const FlightColumns &other);
+    NavigationFix fix(int row) const;
+    size_t memoryBytes() const;
+
+    // Поле по имени из интерфейса (регистр не важен). false — поле неизвестно
+    static bool fieldFromName(const QString &name, Field &field);
+
+    // Номера строк, прошедших фильтр, в нужном порядке — аналог
+    // WHERE field = value [AND isValid = 1] ORDER BY sortField
+    std::vector<int> select(const QString &filterField, const QString &filterValue,
+                            const QString &sortField, bool descending,
+                            bool validOnly) const;
+
+private:
+    double value(Field field, int row) const;
+    bool matches(Field field, int row, const QString &filterValue) const;
+};
+
+// Кэш полетов в памяти с вытеснением давно не использованных (LRU) по
+// суммарному объему столбцов. Полет загружается из navigation_fix один раз,
+// после чего переключение вкладок не обращается к SQLite.
+// Используется из потока интерфейса.
+class FlightCache {
+public:
+    explicit FlightCache(size_t maxBytes = 256u * 1024u * 1024u);
+
+    void setMaxBytes(size_t maxBytes);
+    size_t maxBytes() const { return m_maxBytes; }
+    size_t memoryBytes() const { return m_bytes; }
+
+    // nullptr, если полета нет в кэше. Найденный полет становится самым свежим
+    std::shared_ptr<const FlightColumns> find(const QString &flightName);
+    void insert(const QString &flightName, std::shared_ptr<const FlightColumns> columns);
+    void invalidate(const QString &flightName);
+    void clear();
+
+private:
+    void evict();
+
+    size_t m_maxBytes;
+    size_t m_bytes = 0;
+    QHash<QString, std::shared_ptr<const FlightColumns>> m_flights;
+    QList<QString> m_order; // от давно использованных к свежим
+};
+
+#endif // FLIGHTCACHE_H
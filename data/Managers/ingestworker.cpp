@@ -0,0 +1,638 @@
+#include "ingestworker.h"
+#include "captureformat.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+namespace {
+// Файл записи подается кусками такого размера за один проход цикла событий
+constexpr qint64 REPLAY_CHUNK_SIZE = 64 * 1024;
+
+// Время записи -> время воспроизведения
+qint64 replayOffsetNs(quint64 timeUs, double speed)
+{
+    return static_cast<qint64>(static_cast<double>(timeUs) * 1000.0 / speed);
+}
+}
+
+IngestWorker::IngestWorker(QObject *parent)
+    : QObject(parent),
+    m_uiQueue(1024),
+    m_storageQueue(8192)
+{
+    m_thread.setObjectName("Ingest");
+    m_context.moveToThread(&m_thread);
+    m_clock.start();
+
+    m_updateTimer.setInterval(100);
+    connect(&m_updateTimer, &QTimer::timeout, this, &IngestWorker::drainQueues);
+}
+
+IngestWorker::~IngestWorker()
+{
+    closeAll();
+}
+
+void IngestWorker::setLogger(Logger *logger)
+{
+    m_logger = logger;
+}
+
+void IngestWorker::setStorage(DatabaseManager *dbManager, RawCaptureRecorder *capture)
+{
+    m_dbManager = dbManager;
+    m_capture = capture;
+}
+
+void IngestWorker::setUpdateInterval(int ms)
+{
+    m_updateTimer.setInterval(qMax(10, ms));
+}
+
+template <typename Add>
+int IngestWorker::openSource(const QString &name, QString *errorMessage, Add &&add)
+{
+    if (!startThread()) {
+        if (errorMessage) {
+            *errorMessage = "Ingest thread failed to start";
+        }
+        return 0;
+    }
+
+    // Полет назначается до первой записи источника
+    const int id = ++m_nextSourceId;
+    QString flightName;
+    if (m_flightPerSource) {
+        QString suffix = name;
+        suffix.replace(QRegularExpression("[^A-Za-z0-9]+"), "_");
+        flightName = QString("Flight_%1_%2")
+                         .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+                         .arg(suffix);
+    }
+    if (m_dbManager) {
+        m_dbManager->setSourceFlight(id, name, flightName);
+    }
+
+    bool opened = false;
+    QMetaObject::invokeMethod(&m_context, [&]() {
+        opened = add(createSource(id, name, flightName));
+    }, Qt::BlockingQueuedConnection);
+
+    if (opened) {
+        return id;
+    }
+
+    if (m_dbManager) {
+        m_dbManager->closeSource(id);
+        if (!flightName.isEmpty()) {
+            m_dbManager->deleteFlight(flightName);
+        }
+    }
+    if (sourceStats().isEmpty()) {
+        closeAll();
+    }
+    return 0;
+}
+
+int IngestWorker::openSerial(const QString &portName, QString *errorMessage)
+{
+    return openSource(portName, errorMessage, [&](Source *source) {
+        return addSerial(source, portName, errorMessage);
+    });
+}
+
+int IngestWorker::openUdp(const QString &host, quint16 port, QString *errorMessage)
+{
+    return openSource(QString("%1:%2").arg(host).arg(port), errorMessage, [&](Source *source) {
+        return addUdp(source, host, port, errorMessage);
+    });
+}
+
+int IngestWorker::openReplay(const QString &filePath, double speed, QString *errorMessage)
+{
+    return openSource(QFileInfo(filePath).fileName(), errorMessage, [&](Source *source) {
+        source->replaySpeed = qMax(0.0, speed);
+        return addReplay(source, filePath, errorMessage);
+    });
+}
+
+void IngestWorker::closeSource(int sourceId)
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    bool removed = false;
+    QMetaObject::invokeMethod(&m_context, [this, sourceId, &removed]() {
+        if (Source *source = findSource(sourceId)) {
+            logSourceSummary(*source);
+            removeSource(source);
+            removed = true;
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (removed) {
+        // Записи источника доходят до писателя раньше, чем закрывается его эпоха
+        drainQueues();
+        if (m_dbManager) {
+            m_dbManager->closeSource(sourceId);
+        }
+    }
+}
+
+void IngestWorker::closeAll()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(&m_context, [this]() {
+        removeSources();
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+
+    // Поток остановлен — забираем то, что он успел положить в очереди
+    m_updateTimer.stop();
+    drainQueues();
+
+    if (m_dbManager) {
+        for (const SourceStats &stats : sourceStats()) {
+            m_dbManager->closeSource(stats.id);
+        }
+    }
+
+    const quint64 dropped = m_storageDropped.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        COMETA_LOG(m_logger, Logger::Warning,
+                   QString("Ingest storage queue overflowed, %1 records dropped").arg(dropped));
+    }
+}
+
+QVector<IngestWorker::SourceStats> IngestWorker::sourceStats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_published;
+}
+
+bool IngestWorker::startThread()
+{
+    if (m_thread.isRunning()) {
+        return true;
+    }
+
+    // Фоновый писатель принимает записи из любого потока; без него запись
+    // идет через основное соединение, и ее выполняет поток владельца
+    m_directStorage = m_dbManager && m_dbManager->hasBackgroundWriter();
+    m_storageDropped.store(0, std::memory_order_relaxed);
+    m_uiSkipped.store(0, std::memory_order_relaxed);
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_published.clear();
+    }
+
+    m_thread.start();
+    m_updateTimer.start();
+    return m_thread.isRunning();
+}
+
+IngestWorker::Source *IngestWorker::createSource(int id, const QString &name, const QString &flightName)
+{
+    std::unique_ptr<Source> source(new Source);
+    source->stats.id = id;
+    source->stats.name = name;
+    source->stats.flightName = flightName;
+    source->parser.setLogger(m_logger);
+    source->rateStartNs = m_clock.nsecsElapsed();
+
+    Source *raw = source.get();
+    m_sources.push_back(std::move(source));
+    QMutexLocker locker(&m_statsMutex);
+    m_published.append(raw->stats);
+    return raw;
+}
+
+bool IngestWorker::addSerial(Source *source, const QString &portName, QString *errorMessage)
+{
+    source->stats.kind = SerialSource;
+
+    QSerialPort *serial = new QSerialPort(portName);
+    if (!serial->open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("Failed to open serial port: %1").arg(serial->errorString());
+        }
+        delete serial;
+        removeSource(source);
+        return false;
+    }
+
+    // Настройки порта по умолчанию
+    serial->setBaudRate(QSerialPort::Baud115200);
+    serial->setDataBits(QSerialPort::Data8);
+    serial->setParity(QSerialPort::NoParity);
+    serial->setStopBits(QSerialPort::OneStop);
+    serial->setFlowControl(QSerialPort::NoFlowControl);
+
+    source->serial = serial;
+    connect(serial, &QSerialPort::readyRead, &m_context, [this, source]() {
+        const qint64 receivedAt = m_clock.nsecsElapsed();
+        processChunk(*source, source->serial->readAll(), receivedAt);
+    });
+    connect(serial, &QSerialPort::errorOccurred, &m_context, [this, source](QSerialPort::SerialPortError error) {
+        if (error != QSerialPort::NoError) {
+            emit errorOccurred(QString("%1: %2").arg(source->stats.name, source->serial->errorString()));
+        }
+    });
+    return true;
+}
+
+bool IngestWorker::addUdp(Source *source, const QString &host, quint16 port, QString *errorMessage)
+{
+    source->stats.kind = UdpSource;
+
+    EthernetClient *ethernet = new EthernetClient(host, port);
+    source->ethernet = ethernet;
+    connect(ethernet, &EthernetClient::errorOccurred, this, &IngestWorker::errorOccurred);
+    // Пакет живет только во время сигнала — соединение прямое, в потоке приема
+    connect(ethernet, &EthernetClient::datagramsReceived, &m_context, [this, source](const DatagramBatch &batch) {
+        processBatch(*source, batch, m_clock.nsecsElapsed());
+    }, Qt::DirectConnection);
+    // Рукопожатие и keepalive идут асинхронно — о состоянии сообщают сигналы
+    connect(ethernet, &EthernetClient::stateChanged, &m_context, [this, source](EthernetClient::State state) {
+        source->stats.linkState = EthernetClient::stateName(state);
+        publishStats(*source);
+        emit sourceStateChanged(source->stats.name, source->stats.linkState);
+    });
+    connect(ethernet, &EthernetClient::roundTripMeasured, &m_context, [this, source](qint64 microseconds) {
+        source->stats.roundTripUs = static_cast<double>(microseconds);
+        publishStats(*source);
+    });
+
+    if (!ethernet->connectToServer()) {
+        if (errorMessage) {
+            *errorMessage = "Failed to bind UDP socket";
+        }
+        removeSource(source);
+        return false;
+    }
+    return true;
+}
+
+bool IngestWorker::addReplay(Source *source, const QString &filePath, QString *errorMessage)
+{
+    source->stats.kind = ReplaySource;
+
+    QFile *file = new QFile(filePath);
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("Failed to open %1: %2").arg(filePath, file->errorString());
+        }
+        delete file;
+        removeSource(source);
+        return false;
+    }
+    source->file = file;
+
+    qint64 startMs = 0;
+    const QByteArray header = file->peek(CaptureFileHeaderSize);
+    source->replayTimed = readCaptureFileHeader(header.constData(), header.size(), &startMs);
+    if (source->replayTimed) {
+        file->seek(CaptureFileHeaderSize);
+        COMETA_LOG(m_logger, Logger::Info,
+                   QString("%1: replaying capture of %2 at %3")
+                       .arg(source->stats.name,
+                            QDateTime::fromMSecsSinceEpoch(startMs).toString("yyyy-MM-dd HH:mm:ss"),
+                            source->replaySpeed > 0.0 ? QString("%1x").arg(source->replaySpeed)
+                                                      : QString("max speed")));
+    } else {
+        COMETA_LOG(m_logger, Logger::Info,
+                   QString("%1: no receive timestamps, replaying at max speed").arg(source->stats.name));
+    }
+    source->replayStartNs = m_clock.nsecsElapsed();
+
+    // Чтение кусками через цикл событий: остальные источники не ждут конца файла.
+    // Таймер однократный: следующий запуск — сразу или к времени очередной порции
+    source->fileTimer = new QTimer();
+    source->fileTimer->setSingleShot(true);
+    source->fileTimer->setTimerType(Qt::PreciseTimer);
+    connect(source->fileTimer, &QTimer::timeout, &m_context, [this, source]() {
+        readReplay(*source);
+    });
+    source->fileTimer->start(0);
+    return true;
+}
+
+void IngestWorker::readReplay(Source &source)
+{
+    if (source.replayTimed) {
+        readTimedReplay(source);
+        return;
+    }
+
+    // Запись без меток — сплошной поток
+    const QByteArray chunk = source.file->read(REPLAY_CHUNK_SIZE);
+    if (!chunk.isEmpty()) {
+        processChunk(source, chunk, m_clock.nsecsElapsed());
+    }
+    if (!chunk.isEmpty() && !source.file->atEnd()) {
+        source.fileTimer->start(0);
+        return;
+    }
+    finishReplay(source);
+}
+
+void IngestWorker::readTimedReplay(Source &source)
+{
+    qint64 fed = 0;
+    while (fed < REPLAY_CHUNK_SIZE) {
+        const char *begin = source.replayBuffer.constData() + source.replayPos;
+        const int available = source.replayBuffer.size() - source.replayPos;
+        CaptureChunkHeader header;
+        const int headerSize = decodeCaptureChunkHeader(begin, available, header);
+        if (headerSize < 0) {
+            COMETA_LOG(m_logger, Logger::Warning,
+                       QString("%1: corrupted capture chunk, replay stopped").arg(source.stats.name));
+            finishReplay(source);
+            return;
+        }
+
+        if (headerSize == 0 || available - headerSize < static_cast<int>(header.length)) {
+            // Порция не целиком в буфере: остаток переносится в начало и дочитывается
+            source.replayBuffer.remove(0, source.replayPos);
+            source.replayPos = 0;
+            const QByteArray more = source.file->read(
+                qMax<qint64>(REPLAY_CHUNK_SIZE, static_cast<qint64>(header.length) + CaptureChunkHeaderMaxSize));
+            if (more.isEmpty()) {
+                // Конец файла; обрывок порции в конце остается от прерванной записи
+                finishReplay(source);
+                return;
+            }
+            source.replayBuffer.append(more);
+            continue;
+        }
+
+        const quint64 timeUs = source.replayTimeUs + header.deltaUs;
+        if (source.replaySpeed > 0.0) {
+            const qint64 waitNs = source.replayStartNs + replayOffsetNs(timeUs, source.replaySpeed)
+                                  - m_clock.nsecsElapsed();
+            if (waitNs > 0) {
+                // Ожидание округляется вверх: таймер не срабатывает раньше порции
+                source.fileTimer->start(static_cast<int>((waitNs + 999999) / 1000000));
+                publishStats(source);
+                return;
+            }
+        }
+
+        source.replayTimeUs = timeUs;
+        source.replayPos += headerSize + static_cast<int>(header.length);
+        fed += header.length;
+        consume(source, source.replayFramers[header.sourceId], begin + headerSize,
+                static_cast<int>(header.length), header.endOfMessage, m_clock.nsecsElapsed());
+    }
+
+    publishStats(source);
+    source.fileTimer->start(0);
+}
+
+void IngestWorker::finishReplay(Source &source)
+{
+    // Последняя строка может быть без \r\n
+    const qint64 now = m_clock.nsecsElapsed();
+    consume(source, source.framer, nullptr, 0, true, now);
+    for (auto &entry : source.replayFramers) {
+        consume(source, entry.second, nullptr, 0, true, now);
+    }
+    source.replayBuffer = QByteArray();
+    source.replayPos = 0;
+
+    source.stats.linkState = "finished";
+    publishStats(source);
+    emit replayFinished(source.stats.id, source.stats.name);
+}
+
+void IngestWorker::closeDevices(Source &source)
+{
+    if (source.serial) {
+        source.serial->close();
+        delete source.serial;
+        source.serial = nullptr;
+    }
+    if (source.ethernet) {
+        source.ethernet->disconnectFromServer();
+        delete source.ethernet;
+        source.ethernet = nullptr;
+    }
+    delete source.fileTimer;
+    source.fileTimer = nullptr;
+    delete source.file;
+    source.file = nullptr;
+}
+
+void IngestWorker::removeSource(Source *source)
+{
+    const int index = indexOf(*source);
+    if (index < 0) {
+        return;
+    }
+    closeDevices(*source);
+    m_sources.erase(m_sources.begin() + index);
+
+    QMutexLocker locker(&m_statsMutex);
+    m_published.remove(index);
+}
+
+void IngestWorker::removeSources()
+{
+    // Итоговые счетчики закрытых источников остаются в sourceStats()
+    for (const std::unique_ptr<Source> &source : m_sources) {
+        logSourceSummary(*source);
+        closeDevices(*source);
+        publishStats(*source);
+    }
+    m_sources.clear();
+}
+
+void IngestWorker::logSourceSummary(const Source &source)
+{
+    const NmeaFramer::Stats framing = framingStats(source);
+    COMETA_LOG(m_logger, Logger::Info,
+               QString("%1: parser statistics: %2").arg(source.stats.name, source.parser.errorSummary()));
+    COMETA_LOG(m_logger, Logger::Info,
+               QString("%1: framing statistics: received %2 bytes, discarded %3, "
+                       "sentences %4, stitched %5, overflows %6")
+                   .arg(source.stats.name)
+                   .arg(framing.bytesReceived)
+                   .arg(framing.bytesDiscarded)
+                   .arg(framing.frames)
+                   .arg(framing.stitchedFrames)
+                   .arg(framing.overflows));
+}
+
+void IngestWorker::processChunk(Source &source, const QByteArray &data, qint64 receivedAt)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    consume(source, source.framer, data.constData(), data.size(), false, receivedAt);
+    publishStats(source);
+}
+
+void IngestWorker::processBatch(Source &source, const DatagramBatch &batch, qint64 receivedAt)
+{
+    ++source.stats.batches;
+    for (int i = 0; i < batch.size(); ++i) {
+        // Служебные датаграммы клиент обнулил
+        if (batch.length(i) > 0) {
+            ++source.stats.datagrams;
+            // Датаграмма заканчивается вместе с последним предложением
+            consume(source, source.framer, batch.data(i), batch.length(i), true, receivedAt);
+        }
+    }
+    publishStats(source);
+}
+
+void IngestWorker::consume(Source &source, NmeaFramer &framer, const char *data, int size, bool endOfMessage,
+                           qint64 receivedAt)
+{
+    // Воспроизведение не записывается повторно
+    if (m_capture && source.stats.kind != ReplaySource) {
+        m_capture->write(data, size, static_cast<quint16>(source.stats.id), endOfMessage);
+    }
+    source.stats.bytes += static_cast<quint64>(size);
+
+    // Предложение, разрезанное границей чтения, доберет следующий вызов
+    auto handleFrame = [&](const char *buffer, const NmeaFrame &frame) {
+        NavigationData parsed = source.parser.parseFrame(buffer, frame);
+        parsed.sourceId = static_cast<quint16>(source.stats.id);
+        if (parsed.result != OK) {
+            // Причина уже учтена в счетчиках парсера, текст — только для отладки
+            COMETA_LOG(m_logger, Logger::Debug, "Failed to parse: " + source.parser.lastErrorMessage());
+            ++source.stats.invalid;
+            return;
+        }
+
+        deliver(parsed, buffer + frame.offset, frame.length);
+        ++source.stats.sentences;
+
+        const quint64 latency = static_cast<quint64>(m_clock.nsecsElapsed() - receivedAt);
+        source.latencySumNs += latency;
+        source.latencyMaxNs = qMax(source.latencyMaxNs, latency);
+        ++source.stats.latencySamples;
+    };
+
+    const quint64 overflows = framer.stats().overflows;
+    if (size > 0) {
+        framer.feed(data, size, handleFrame);
+    }
+    if (endOfMessage) {
+        framer.flush(handleFrame);
+    }
+    source.stats.framingOverflows += framer.stats().overflows - overflows;
+}
+
+void IngestWorker::deliver(const NavigationData &data, const char *raw, int length)
+{
+    if (m_directStorage) {
+        m_dbManager->saveNavigationData(data, QByteArray::fromRawData(raw, length));
+    } else if (m_dbManager && !m_storageQueue.tryPush(data)) {
+        m_storageDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Интерфейсу нужны только последние записи — переполнение не ошибка
+    if (!m_uiQueue.tryPush(data)) {
+        m_uiSkipped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IngestWorker::publishStats(Source &source)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 window = now - source.rateStartNs;
+    if (window >= 1000000000) {
+        source.stats.bytesPerSecond = (source.stats.bytes - source.rateBytes) * 1e9 / window;
+        source.stats.sentencesPerSecond = (source.stats.sentences - source.rateSentences) * 1e9 / window;
+        source.rateStartNs = now;
+        source.rateBytes = source.stats.bytes;
+        source.rateSentences = source.stats.sentences;
+    }
+
+    SourceStats stats = source.stats;
+    if (stats.latencySamples > 0) {
+        stats.avgLatencyUs = source.latencySumNs / 1000.0 / stats.latencySamples;
+        stats.maxLatencyUs = source.latencyMaxNs / 1000.0;
+    }
+
+    const int index = indexOf(source);
+    QMutexLocker locker(&m_statsMutex);
+    if (index >= 0 && index < m_published.size()) {
+        m_published[index] = stats;
+    }
+}
+
+NmeaFramer::Stats IngestWorker::framingStats(const Source &source)
+{
+    NmeaFramer::Stats total = source.framer.stats();
+    for (const auto &entry : source.replayFramers) {
+        const NmeaFramer::Stats &stats = entry.second.stats();
+        total.bytesReceived += stats.bytesReceived;
+        total.bytesDiscarded += stats.bytesDiscarded;
+        total.frames += stats.frames;
+        total.stitchedFrames += stats.stitchedFrames;
+        total.overflows += stats.overflows;
+    }
+    return total;
+}
+
+int IngestWorker::indexOf(const Source &source) const
+{
+    for (size_t i = 0; i < m_sources.size(); ++i) {
+        if (m_sources[i].get() == &source) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+IngestWorker::Source *IngestWorker::findSource(int sourceId) const
+{
+    for (const std::unique_ptr<Source> &source : m_sources) {
+        if (source->stats.id == sourceId) {
+            return source.get();
+        }
+    }
+    return nullptr;
+}
+
+void IngestWorker::drainQueues()
+{
+    NavigationData record;
+    if (!m_directStorage && m_dbManager) {
+        while (m_storageQueue.tryPop(record)) {
+            m_dbManager->saveNavigationData(record);
+        }
+    }
+
+    // Из накопившегося за интервал интерфейсу уходят последние MaxUpdateRecords
+    QVector<NavigationData> latest;
+    int next = 0;
+    quint64 skipped = m_uiSkipped.exchange(0, std::memory_order_relaxed);
+    while (m_uiQueue.tryPop(record)) {
+        if (latest.size() < MaxUpdateRecords) {
+            latest.append(record);
+        } else {
+            latest[next] = record;
+            next = (next + 1) % MaxUpdateRecords;
+            ++skipped;
+        }
+    }
+    std::rotate(latest.begin(), latest.begin() + next, latest.end());
+
+    if (!latest.isEmpty() || skipped > 0) {
+        emit recordsReady(latest, skipped);
+    }
+}
@@ -0,0 +1,183 @@
+#ifndef INGESTWORKER_H
+#define INGESTWORKER_H
+
+#include "boundedqueue.h"
+#include "databasemanager.h"
+#include "ethernetclient.h"
+#include "logger.h"
+#include "NavigationData.h"
+#include "nmeaframer.h"
+#include "parsernmea.h"
+#include "rawcapturerecorder.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QSerialPort>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Поток приема: владеет всеми источниками — последовательными портами,
+// UDP-клиентами и файлами записи. У каждого источника свой разметчик,
+// парсер и полет, записи помечаются id источника (NavigationData::sourceId)
+// и уходят одному писателю БД. Готовые записи раздаются потребителям
+// через очереди: сырой поток — RawCaptureRecorder, записи — фоновому
+// писателю БД (или очереди, которую разбирает поток владельца), интерфейсу —
+// только последние записи раз в updateInterval.
+class IngestWorker : public QObject {
+    Q_OBJECT
+
+public:
+    enum SourceKind {
+        SerialSource,
+        UdpSource,
+        ReplaySource // Файл записи приема, подается в тот же конвейер
+    };
+
+    struct SourceStats {
+        int id = 0;
+        QString name;
+        SourceKind kind = SerialSource;
+        QString flightName; // Пустое — полет по умолчанию
+        quint64 bytes = 0;
+        quint64 sentences = 0;
+        quint64 invalid = 0;
+        quint64 framingOverflows = 0;
+        // Пропускная способность за последнюю секунду
+        double bytesPerSecond = 0.0;
+        double sentencesPerSecond = 0.0;
+        // Задержка от чтения из устройства до передачи записи потребителям
+        quint64 latencySamples = 0;
+        double avgLatencyUs = 0.0;
+        double maxLatencyUs = 0.0;
+        // Только для UDP: пакеты приема, состояние связи и круговая задержка CONNECT/PING
+        quint64 datagrams = 0;
+        quint64 batches = 0;
+        QString linkState;
+        double roundTripUs = -1.0;
+    };
+
+    // Сколько последних записей интерфейс получает за одно обновление
+    static constexpr int MaxUpdateRecords = 32;
+
+    explicit IngestWorker(QObject *parent = nullptr);
+    ~IngestWorker();
+
+    void setLogger(Logger *logger);
+    // Потребители записей; менять можно только при закрытых источниках (closeAll):
+    // поток приема пишет в dbManager без блокировок. Пока источники открыты,
+    // dbManager нельзя закрывать и останавливать его фоновый писатель
+    void setStorage(DatabaseManager *dbManager, RawCaptureRecorder *capture);
+    void setUpdateInterval(int ms);
+    // Свой полет на каждый источник (Flight_<время>_<источник>); иначе все
+    // источники пишут в текущий полет, а строки только помечаются источником
+    void setFlightPerSource(bool enabled) { m_flightPerSource = enabled; }
+
+    // Возвращают id источника или 0 при ошибке
+    int openSerial(const QString &portName, QString *errorMessage = nullptr);
+    int openUdp(const QString &host, quint16 port, QString *errorMessage = nullptr);
+    // Запись приема подается в конвейер в темпе записи, умноженном на speed
+    // (1 — исходный темп, 0 — максимальная скорость). Файл без меток времени
+    // читается с максимальной скоростью. В запись приема не попадает
+    int openReplay(const QString &filePath, double speed = 0.0, QString *errorMessage = nullptr);
+    void closeSource(int sourceId);
+    // Закрывает все источники и дописывает очереди
+    void closeAll();
+    bool isRunning() const { return m_thread.isRunning(); }
+
+    // Снимок счетчиков; можно вызывать из любого потока
+    QVector<SourceStats> sourceStats() const;
+    quint64 droppedRecords() const { return m_storageDropped.load(std::memory_order_relaxed); }
+
+signals:
+    // Последние записи за интервал; skipped — сколько пропущено при объединении
+    void recordsReady(const QVector<NavigationData> &records, quint64 skipped);
+    void errorOccurred(const QString &error);
+    void sourceStateChanged(const QString &source, const QString &state);
+    // Файл записи дочитан до конца
+    void replayFinished(int sourceId, const QString &source);
+
+private:
+    struct Source {
+        SourceStats stats;
+        QSerialPort *serial = nullptr;
+        EthernetClient *ethernet = nullptr;
+        QFile *file = nullptr;
+        QTimer *fileTimer = nullptr;
+        ParserNMEA parser;
+        NmeaFramer framer;
+        quint64 latencySumNs = 0;
+        quint64 latencyMaxNs = 0;
+        // Окно расчета пропускной способности
+        qint64 rateStartNs = 0;
+        quint64 rateBytes = 0;
+        quint64 rateSentences = 0;
+        // Воспроизведение записи с метками времени
+        bool replayTimed = false;
+        double replaySpeed = 0.0;
+        qint64 replayStartNs = 0;
+        quint64 replayTimeUs = 0; // Время приема последней поданной порции от начала записи
+        QByteArray replayBuffer;
+        int replayPos = 0;
+        // У каждого источника записи свой разметчик: куски приемников не склеиваются
+        std::map<quint16, NmeaFramer> replayFramers;
+    };
+
+    // Выполняются в потоке владельца
+    bool startThread();
+    template <typename Add>
+    int openSource(const QString &name, QString *errorMessage, Add &&add);
+    void drainQueues();
+
+    // Выполняются только в потоке приема
+    Source *createSource(int id, const QString &name, const QString &flightName);
+    bool addSerial(Source *source, const QString &portName, QString *errorMessage);
+    bool addUdp(Source *source, const QString &host, quint16 port, QString *errorMessage);
+    bool addReplay(Source *source, const QString &filePath, QString *errorMessage);
+    void readReplay(Source &source);
+    void readTimedReplay(Source &source);
+    void finishReplay(Source &source);
+    void closeDevices(Source &source);
+    void removeSource(Source *source);
+    void removeSources();
+    void logSourceSummary(const Source &source);
+    void processChunk(Source &source, const QByteArray &data, qint64 receivedAt);
+    void processBatch(Source &source, const DatagramBatch &batch, qint64 receivedAt);
+    void consume(Source &source, NmeaFramer &framer, const char *data, int size, bool endOfMessage,
+                 qint64 receivedAt);
+    void deliver(const NavigationData &data, const char *raw, int length);
+    void publishStats(Source &source);
+    static NmeaFramer::Stats framingStats(const Source &source);
+    int indexOf(const Source &source) const;
+    Source *findSource(int sourceId) const;
+
+    QThread m_thread;
+    QObject m_context; // Живет в потоке приема, через него вызываются методы потока
+    std::vector<std::unique_ptr<Source>> m_sources; // Только в потоке приема
+    QElapsedTimer m_clock;
+    int m_nextSourceId = 0;
+    bool m_flightPerSource = false;
+
+    DatabaseManager *m_dbManager = nullptr;
+    RawCaptureRecorder *m_capture = nullptr;
+    bool m_directStorage = false; // Фоновый писатель принимает записи из любого потока
+    Logger *m_logger = nullptr;
+
+    BoundedQueue<NavigationData> m_uiQueue;
+    BoundedQueue<NavigationData> m_storageQueue;
+    std::atomic<quint64> m_uiSkipped{0};
+    std::atomic<quint64> m_storageDropped{0};
+    QTimer m_updateTimer;
+
+    mutable QMutex m_statsMutex;
+    QVector<SourceStats> m_published; // В порядке m_sources
+};
+
+#endif // INGESTWORKER_H
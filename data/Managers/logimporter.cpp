@@ -0,0 +1,279 @@
+#include "logimporter.h"
+#include "captureformat.h"
+
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <limits>
+#include <map>
+
+LogImporter::LogImporter(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent),
+    m_dbManager(dbManager)
+{
+    connect(&m_watcher, &QFutureWatcher<ParsedChunk>::finished,
+            this, &LogImporter::onChunkFinished);
+}
+
+LogImporter::~LogImporter()
+{
+    // Потоки пула читают отображенный файл — дожидаемся их до закрытия
+    m_cancelled = true;
+    m_watcher.disconnect(this);
+    for (QFuture<ParsedChunk> &future : m_inFlight) {
+        future.waitForFinished();
+    }
+}
+
+void LogImporter::setLogger(Logger *logger)
+{
+    m_logger = logger;
+}
+
+void LogImporter::setChunking(qint64 chunkBytes, int maxChunksInFlight)
+{
+    m_chunkBytes = qMax<qint64>(64 * 1024, chunkBytes);
+    m_maxChunksInFlight = qMax(0, maxChunksInFlight);
+}
+
+bool LogImporter::start(const QString &filePath)
+{
+    if (m_running) {
+        return false;
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        emit errorOccurred("Не удалось открыть файл: " + m_file.errorString());
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size > 0 ? reinterpret_cast<const char *>(m_file.map(0, m_size)) : nullptr;
+    if (!m_data && m_size > 0) {
+        // Отображение недоступно (например, сетевой диск) — читаем целиком
+        m_fallback = m_file.readAll();
+        m_data = m_fallback.constData();
+        m_size = m_fallback.size();
+    }
+
+    if (m_data && readCaptureFileHeader(m_data, static_cast<int>(qMin<qint64>(m_size, CaptureFileHeaderSize)))) {
+        bool corrupted = false;
+        QByteArray unpacked = unpackCapture(m_data, m_size, &corrupted);
+        if (m_fallback.isEmpty()) {
+            m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+        }
+        m_fallback = unpacked;
+        m_data = m_fallback.isEmpty() ? nullptr : m_fallback.constData();
+        m_size = m_fallback.size();
+        if (corrupted && m_logger) {
+            m_logger->log(Logger::Warning, "Запись приема " + filePath + " оборвана, импортируется до места обрыва");
+        }
+    }
+
+    m_stats = Stats();
+    m_stats.bytesTotal = m_size;
+    m_stats.minLatitude = std::numeric_limits<double>::max();
+    m_stats.maxLatitude = std::numeric_limits<double>::lowest();
+    m_stats.minLongitude = std::numeric_limits<double>::max();
+    m_stats.maxLongitude = std::numeric_limits<double>::lowest();
+    m_stats.minAltitude = std::numeric_limits<double>::max();
+    m_stats.maxAltitude = std::numeric_limits<double>::lowest();
+
+    m_nextOffset = 0;
+    m_cancelled = false;
+    m_running = true;
+
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Импорт %1 (%2 байт), куски по %3 байт")
+                                        .arg(filePath)
+                                        .arg(m_size)
+                                        .arg(m_chunkBytes));
+    }
+
+    submitChunks();
+    // finished не должен прийти раньше возврата из start(), даже для пустого файла
+    QMetaObject::invokeMethod(this, [this]() { watchNextChunk(); }, Qt::QueuedConnection);
+    return true;
+}
+
+void LogImporter::cancel()
+{
+    m_cancelled = true;
+}
+
+void LogImporter::submitChunks()
+{
+    const int maxInFlight = m_maxChunksInFlight > 0
+                                ? m_maxChunksInFlight
+                                : 2 * QThreadPool::globalInstance()->maxThreadCount();
+
+    while (!m_cancelled && m_nextOffset < m_size && m_inFlight.size() < maxInFlight) {
+        const char *begin = m_data + m_nextOffset;
+        const char *const fileEnd = m_data + m_size;
+        const char *end = begin + qMin(m_chunkBytes, m_size - m_nextOffset);
+
+        // Кусок заканчивается на конце строки, строка целиком попадает в один кусок
+        if (end < fileEnd) {
+            const char *newline = static_cast<const char *>(std::memchr(end, '\n', fileEnd - end));
+            end = newline ? newline + 1 : fileEnd;
+        }
+
+        m_nextOffset = end - m_data;
+        m_inFlight.enqueue(QtConcurrent::run(&LogImporter::parseChunk,
+                                             begin, end, m_nextOffset, m_logger));
+    }
+}
+
+void LogImporter::watchNextChunk()
+{
+    if (m_inFlight.isEmpty()) {
+        finish();
+        return;
+    }
+    // Для уже готового future сигнал finished придет через цикл событий
+    m_watcher.setFuture(m_inFlight.head());
+}
+
+void LogImporter::onChunkFinished()
+{
+    if (m_inFlight.isEmpty()) {
+        return;
+    }
+
+    const QFuture<ParsedChunk> future = m_inFlight.dequeue();
+    if (!m_cancelled) {
+        consume(future.result());
+        emit progress(m_stats.bytesDone, m_stats.bytesTotal);
+    }
+
+    submitChunks();
+    watchNextChunk();
+}
+
+LogImporter::ParsedChunk LogImporter::parseChunk(const char *begin, const char *end,
+                                                 qint64 endOffset, Logger *logger)
+{
+    // Парсер на кусок: у каждого потока пула свой экземпляр
+    ParserNMEA parser;
+    parser.setLogger(logger);
+
+    ParsedChunk chunk;
+    chunk.end = endOffset;
+    chunk.records.reserve(static_cast<int>((end - begin) / 64));
+
+    // Кусок заканчивается концом строки или файла — хвоста не остается
+    std::vector<NmeaFrame> frames;
+    frames.reserve(static_cast<size_t>((end - begin) / 64));
+    scanNmeaFrames(begin, static_cast<int>(end - begin), frames, true);
+
+    for (const NmeaFrame &frame : frames) {
+        ++chunk.lines;
+        NavigationData data = parser.parseFrame(begin, frame);
+        if (data.result == OK) {
+            chunk.records.append({std::move(data), begin + frame.offset, frame.length});
+        } else {
+            ++chunk.errors;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(ParseError::Count); ++i) {
+        chunk.errorsByReason[i] = static_cast<int>(parser.errorCount(static_cast<ParseError>(i)));
+    }
+    return chunk;
+}
+
+QByteArray LogImporter::unpackCapture(const char *data, qint64 size, bool *corrupted)
+{
+    // Порции разных источников перемешаны — собираем поток каждого отдельно
+    std::map<quint16, QByteArray> streams;
+    qint64 offset = CaptureFileHeaderSize;
+    *corrupted = false;
+    while (offset < size) {
+        CaptureChunkHeader header;
+        const int available = static_cast<int>(qMin<qint64>(size - offset, CaptureChunkHeaderMaxSize));
+        const int headerSize = decodeCaptureChunkHeader(data + offset, available, header);
+        if (headerSize <= 0 || size - offset - headerSize < header.length) {
+            *corrupted = true;
+            break;
+        }
+        offset += headerSize;
+
+        QByteArray &stream = streams[header.sourceId];
+        stream.append(data + offset, static_cast<int>(header.length));
+        // Датаграмма заканчивается вместе с последним предложением
+        if (header.endOfMessage && !stream.endsWith('\n')) {
+            stream.append('\n');
+        }
+        offset += header.length;
+    }
+
+    QByteArray unpacked;
+    for (auto &entry : streams) {
+        unpacked.append(entry.second);
+        if (!unpacked.endsWith('\n')) {
+            unpacked.append('\n');
+        }
+    }
+    return unpacked;
+}
+
+void LogImporter::consume(const ParsedChunk &chunk)
+{
+    for (const ParsedLine &line : chunk.records) {
+        if (m_dbManager->saveNavigationData(line.data, QByteArray::fromRawData(line.raw, line.length))) {
+            ++m_stats.saved;
+        }
+
+        // Без решения (качество 0) пустые координаты приходят как 0.0 — в границы не входят
+        const GNGGAData *gga = line.data.as<GNGGAData>();
+        if (gga && gga->coordDef != GNGGAData::COORDINATE_UNDEFINE) {
+            m_stats.hasPosition = true;
+            m_stats.minLatitude = qMin(m_stats.minLatitude, gga->latitude);
+            m_stats.maxLatitude = qMax(m_stats.maxLatitude, gga->latitude);
+            m_stats.minLongitude = qMin(m_stats.minLongitude, gga->longitude);
+            m_stats.maxLongitude = qMax(m_stats.maxLongitude, gga->longitude);
+            m_stats.minAltitude = qMin(m_stats.minAltitude, static_cast<double>(gga->altitude));
+            m_stats.maxAltitude = qMax(m_stats.maxAltitude, static_cast<double>(gga->altitude));
+        }
+    }
+
+    m_stats.lines += chunk.lines;
+    m_stats.errors += chunk.errors;
+    for (int i = 0; i < static_cast<int>(ParseError::Count); ++i) {
+        m_stats.errorsByReason[i] += chunk.errorsByReason[i];
+    }
+    m_stats.bytesDone = chunk.end;
+}
+
+void LogImporter::finish()
+{
+    if (!m_running) {
+        return;
+    }
+
+    if (m_fallback.isEmpty() && m_data) {
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+    }
+    m_fallback.clear();
+    m_data = nullptr;
+    m_file.close();
+    m_running = false;
+
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Импорт %1: строк %2, сохранено %3, ошибок разбора %4")
+                                        .arg(m_cancelled ? "прерван" : "завершен")
+                                        .arg(m_stats.lines)
+                                        .arg(m_stats.saved)
+                                        .arg(m_stats.errors));
+        for (int i = 1; i < static_cast<int>(ParseError::Count); ++i) {
+            if (m_stats.errorsByReason[i] > 0) {
+                m_logger->log(Logger::Info, QString("  %1: %2")
+                                                .arg(QLatin1String(parseErrorName(static_cast<ParseError>(i))))
+                                                .arg(m_stats.errorsByReason[i]));
+            }
+        }
+    }
+    emit finished(m_cancelled);
+}
@@ -0,0 +1,107 @@
+#ifndef LOGIMPORTER_H
+#define LOGIMPORTER_H
+
+#include "databasemanager.h"
+#include "logger.h"
+#include "parsernmea.h"
+
+#include <QFile>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+
+// Импорт лог-файла NMEA.
+// Файл отображается в память и делится на куски по границам строк, куски
+// разбираются в пуле потоков QtConcurrent. Результаты передаются в
+// DatabaseManager строго в порядке файла. Одновременно в работе не больше
+// maxChunksInFlight кусков, поэтому память не растет с размером файла.
+// Запись приема с метками времени (captureformat.h) сначала распаковывается
+// в память: заголовки порций убираются, потоки источников идут друг за другом.
+class LogImporter : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stats {
+        qint64 bytesTotal = 0;
+        qint64 bytesDone = 0;
+        int lines = 0;
+        int saved = 0;
+        int errors = 0;
+        std::array<int, static_cast<int>(ParseError::Count)> errorsByReason{};
+        double minLatitude = 0.0;
+        double maxLatitude = 0.0;
+        double minLongitude = 0.0;
+        double maxLongitude = 0.0;
+        double minAltitude = 0.0;
+        double maxAltitude = 0.0;
+        bool hasPosition = false; // Границы заполнены по GGA
+    };
+
+    explicit LogImporter(DatabaseManager *dbManager, QObject *parent = nullptr);
+    ~LogImporter();
+
+    void setLogger(Logger *logger);
+    // Размер куска для одного потока и число кусков в работе (0 — по числу потоков)
+    void setChunking(qint64 chunkBytes, int maxChunksInFlight = 0);
+
+    // Записи попадают в текущий полет DatabaseManager
+    bool start(const QString &filePath);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    const Stats &stats() const { return m_stats; }
+
+signals:
+    void progress(qint64 bytesDone, qint64 bytesTotal);
+    void finished(bool cancelled);
+    void errorOccurred(const QString &error);
+
+private:
+    struct ParsedLine {
+        NavigationData data;
+        const char *raw;
+        int length;
+    };
+
+    struct ParsedChunk {
+        QVector<ParsedLine> records;
+        qint64 end = 0; // Смещение конца куска в файле
+        int lines = 0;
+        int errors = 0;
+        std::array<int, static_cast<int>(ParseError::Count)> errorsByReason{};
+    };
+
+    static ParsedChunk parseChunk(const char *begin, const char *end, qint64 endOffset,
+                                  Logger *logger);
+    // Байты порций записи приема; corrupted — файл оборван или испорчен
+    static QByteArray unpackCapture(const char *data, qint64 size, bool *corrupted);
+
+    void submitChunks();
+    void watchNextChunk();
+    void onChunkFinished();
+    void consume(const ParsedChunk &chunk);
+    void finish();
+
+    DatabaseManager *m_dbManager;
+    Logger *m_logger = nullptr;
+
+    QFile m_file;
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_nextOffset = 0;
+    QByteArray m_fallback; // Если файл нельзя отобразить в память или это запись приема
+
+    qint64 m_chunkBytes = 4 * 1024 * 1024;
+    int m_maxChunksInFlight = 0;
+
+    QQueue<QFuture<ParsedChunk>> m_inFlight; // В порядке файла
+    QFutureWatcher<ParsedChunk> m_watcher;   // Следит за первым куском очереди
+
+    Stats m_stats;
+    bool m_running = false;
+    bool m_cancelled = false;
+};
+
+#endif // LOGIMPORTER_H
@@ -0,0 +1,602 @@
+#include "navigationbatchwriter.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSqlError>
+
+namespace {
+// Ключи кэша для INSERT в navigation_data, navigation_fix и sky_view
+// (остальные ключи — значения MsgType)
+constexpr int NAVIGATION_STATEMENT = -1;
+constexpr int FIX_STATEMENT = -2;
+constexpr int SKY_VIEW_STATEMENT = -3;
+
+// Каждый пакет пишется в журнал на уровне Debug, сводка — раз в интервал
+constexpr qint64 SUMMARY_INTERVAL_MS = 10000;
+
+const char *const NAVIGATION_INSERT =
+    "INSERT INTO navigation_data "
+    "(flight_id, flight_name, timestamp, source_name) "
+    "VALUES (?, ?, ?, ?)";
+
+const char *const FIX_INSERT =
+    "INSERT INTO navigation_fix "
+    "(flight_id, timestamp, date, time, isValid, latitude, longitude, altitude, "
+    "speed, course, satellitesCount, hdop, rms, latitudeError, longitudeError, "
+    "altitudeError, sources, source_name) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char *const SKY_VIEW_INSERT =
+    "INSERT INTO sky_view "
+    "(fix_id, flight_id, satellitesCount, satellites) "
+    "VALUES (?, ?, ?, ?)";
+}
+
+NavigationBatchWriter::NavigationBatchWriter(const QString &connectionName, QObject *parent)
+    : QObject(parent), m_connectionName(connectionName)
+{
+    m_flushTimer.setSingleShot(true);
+    connect(&m_flushTimer, &QTimer::timeout, this, [this]() { flush(); });
+}
+
+NavigationBatchWriter::~NavigationBatchWriter()
+{
+    flush(true);
+}
+
+void NavigationBatchWriter::setLogger(Logger *logger)
+{
+    m_logger = logger;
+}
+
+void NavigationBatchWriter::setBatchMode(bool enabled, int maxRecords, int maxLatencyMs)
+{
+    flush();
+    m_batchMode = enabled;
+    m_maxRecords = qMax(1, maxRecords);
+    m_maxLatencyMs = qMax(0, maxLatencyMs);
+    m_pending.reserve(m_maxRecords);
+}
+
+void NavigationBatchWriter::setFlightName(const QString &flightName)
+{
+    // Последняя эпоха старого полета записывается в старый полет
+    flush(true);
+    m_flightName = flightName;
+    m_flightId = lookupFlightId(flightName);
+
+    for (auto &entry : m_sources) {
+        SourceContext &source = *entry.second;
+        if (!source.ownFlight) {
+            source.flightName = m_flightName;
+            source.flightId = m_flightId;
+            source.currentNavId = 0;
+            source.epochs.reset();
+        }
+    }
+}
+
+void NavigationBatchWriter::setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName)
+{
+    // Пакет и незавершенная эпоха источника остаются в прежнем полете
+    flush();
+    SourceContext &source = context(sourceId);
+    if (source.epochs.hasPending()) {
+        commit(QVector<NavigationData>(), sourceId);
+    }
+
+    source.sourceName = sourceName;
+    source.ownFlight = !flightName.isEmpty();
+    source.flightName = source.ownFlight ? flightName : m_flightName;
+    source.flightId = source.ownFlight ? lookupFlightId(flightName) : m_flightId;
+    source.currentNavId = 0;
+    source.epochs.reset();
+}
+
+void NavigationBatchWriter::closeSource(int sourceId)
+{
+    flush();
+    auto it = m_sources.find(sourceId);
+    if (it == m_sources.end()) {
+        return;
+    }
+    if (it->second->epochs.hasPending()) {
+        commit(QVector<NavigationData>(), sourceId);
+    }
+    m_sources.erase(it);
+}
+
+NavigationBatchWriter::SourceContext &NavigationBatchWriter::context(int sourceId)
+{
+    std::unique_ptr<SourceContext> &source = m_sources[sourceId];
+    if (!source) {
+        source.reset(new SourceContext);
+        source->flightName = m_flightName;
+        source->flightId = m_flightId;
+    }
+    return *source;
+}
+
+int NavigationBatchWriter::lookupFlightId(const QString &flightName)
+{
+    QSqlQuery query(database());
+    query.prepare("SELECT id FROM flights WHERE flight_name = ?");
+    query.addBindValue(flightName);
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    if (!flightName.isEmpty()) {
+        logError(QString("Flight %1 not found").arg(flightName));
+    }
+    return 0;
+}
+
+bool NavigationBatchWriter::hasPendingEpochs() const
+{
+    for (const auto &entry : m_sources) {
+        if (entry.second->epochs.hasPending()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QSqlDatabase NavigationBatchWriter::database() const
+{
+    return QSqlDatabase::database(m_connectionName, false);
+}
+
+bool NavigationBatchWriter::write(const NavigationData &data)
+{
+    if (!m_batchMode) {
+        return commit(QVector<NavigationData>{data});
+    }
+
+    m_pending.append(data);
+    if (m_pending.size() >= m_maxRecords) {
+        return flush();
+    }
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start(m_maxLatencyMs);
+    }
+    return true;
+}
+
+bool NavigationBatchWriter::flush(bool closeEpoch)
+{
+    m_flushTimer.stop();
+    if (m_pending.isEmpty() && !(closeEpoch && hasPendingEpochs())) {
+        return true;
+    }
+
+    const QVector<NavigationData> records = std::move(m_pending);
+    m_pending.clear();
+    m_pending.reserve(m_maxRecords);
+    return commit(records, closeEpoch ? CloseAll : CloseNone);
+}
+
+void NavigationBatchWriter::resetStatements()
+{
+    // Запросы держат ссылку на соединение — сбрасываем их перед закрытием БД
+    m_statements.clear();
+}
+
+bool NavigationBatchWriter::commit(const QVector<NavigationData> &records, int closeSourceId)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlDatabase db = database();
+    if (!db.isOpen()) {
+        logError("Database not open");
+        return false;
+    }
+
+    if (!db.transaction()) {
+        logError("Failed to start transaction: " + db.lastError().text());
+        return false;
+    }
+
+    // Ошибка одной записи не откатывает весь пакет — как и при записи по одной
+    int written = 0;
+    NavigationFix fix;
+    for (const NavigationData &data : records) {
+        SourceContext &source = context(data.sourceId);
+        if (insertRecord(source, data)) {
+            ++written;
+        }
+        if (source.epochs.add(data, fix)) {
+            insertFix(source, fix);
+        }
+    }
+    for (auto &entry : m_sources) {
+        SourceContext &source = *entry.second;
+        const bool close = closeSourceId == CloseAll || closeSourceId == entry.first;
+        if (close && source.epochs.flush(fix)) {
+            insertFix(source, fix);
+        }
+    }
+
+    if (!db.commit()) {
+        logError("Commit failed: " + db.lastError().text());
+        db.rollback();
+        return false;
+    }
+
+    const qint64 elapsedNs = qMax<qint64>(timer.nsecsElapsed(), 1);
+    m_lastRowsPerSecond = written * 1e9 / static_cast<double>(elapsedNs);
+    m_totalRows += static_cast<quint64>(written);
+
+    if (m_batchMode) {
+        COMETA_LOG(m_logger, Logger::Debug, QString("Committed batch of %1 records in %2 ms (%3 rows/s)")
+                                                .arg(written)
+                                                .arg(elapsedNs / 1e6, 0, 'f', 2)
+                                                .arg(m_lastRowsPerSecond, 0, 'f', 0));
+
+        m_summaryRows += static_cast<quint64>(written);
+        ++m_summaryBatches;
+        if (!m_summaryTimer.isValid()) {
+            m_summaryTimer.start();
+        } else if (m_summaryTimer.elapsed() >= SUMMARY_INTERVAL_MS) {
+            COMETA_LOG(m_logger, Logger::Info, QString("Committed %1 records in %2 batches over %3 s")
+                                                   .arg(m_summaryRows)
+                                                   .arg(m_summaryBatches)
+                                                   .arg(m_summaryTimer.elapsed() / 1000.0, 0, 'f', 1));
+            m_summaryTimer.restart();
+            m_summaryRows = 0;
+            m_summaryBatches = 0;
+        }
+        emit batchCommitted(written, m_lastRowsPerSecond);
+    } else if (written > 0) {
+        COMETA_LOG(m_logger, Logger::Debug, QString("Saved %1 data block in %2 ms")
+                                                .arg(msgTypeName(records.first().type))
+                                                .arg(elapsedNs / 1000000));
+    }
+
+    return written == records.size();
+}
+
+bool NavigationBatchWriter::insertFix(SourceContext &context, const NavigationFix &fix)
+{
+    QSqlQuery *q = statement(FIX_STATEMENT, FIX_INSERT);
+    if (!q) {
+        return false;
+    }
+
+    q->addBindValue(context.flightId > 0 ? QVariant(context.flightId) : QVariant());
+    q->addBindValue(fix.timestamp.toString(Qt::ISODateWithMs));
+    q->addBindValue(fix.date.toString("yyyy-MM-dd"));
+    q->addBindValue(fix.time.toString("HH:mm:ss.zzz"));
+    q->addBindValue(fix.isValid);
+    q->addBindValue(fix.latitude);
+    q->addBindValue(fix.longitude);
+    q->addBindValue(fix.altitude);
+    q->addBindValue(fix.speed);
+    q->addBindValue(fix.course);
+    q->addBindValue(fix.satellitesCount);
+    q->addBindValue(fix.hdop);
+    q->addBindValue(fix.rms);
+    q->addBindValue(fix.latitudeError);
+    q->addBindValue(fix.longitudeError);
+    q->addBindValue(fix.altitudeError);
+    q->addBindValue(fix.sources);
+    q->addBindValue(context.sourceName.isEmpty() ? QVariant() : QVariant(context.sourceName));
+
+    if (!q->exec()) {
+        logError("Navigation fix insert failed: " + q->lastError().text());
+        return false;
+    }
+    ++m_totalFixes;
+
+    const SkyView &sky = context.epochs.completedSkyView();
+    if (sky.count > 0) {
+        insertSkyView(context, q->lastInsertId().toInt(), sky);
+    }
+    return true;
+}
+
+bool NavigationBatchWriter::insertSkyView(const SourceContext &context, int fixId, const SkyView &sky)
+{
+    QSqlQuery *q = statement(SKY_VIEW_STATEMENT, SKY_VIEW_INSERT);
+    if (!q) {
+        return false;
+    }
+
+    q->addBindValue(fixId);
+    q->addBindValue(context.flightId > 0 ? QVariant(context.flightId) : QVariant());
+    q->addBindValue(sky.count);
+    q->addBindValue(sky.toBlob());
+
+    if (!q->exec()) {
+        logError("Sky view insert failed: " + q->lastError().text());
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery *NavigationBatchWriter::statement(int key, const char *sql)
+{
+    auto it = m_statements.find(key);
+    if (it == m_statements.end()) {
+        QSqlQuery query(database());
+        if (!query.prepare(QLatin1String(sql))) {
+            logError(QString("Prepare failed: %1").arg(query.lastError().text()));
+            return nullptr;
+        }
+        it = m_statements.insert(key, query);
+    }
+    return &it.value();
+}
+
+bool NavigationBatchWriter::insertRecord(SourceContext &context, const NavigationData &data)
+{
+    try {
+        if (data.type == MsgType::GNRMC) {
+            QSqlQuery *navQuery = statement(NAVIGATION_STATEMENT, NAVIGATION_INSERT);
+            if (!navQuery) {
+                throw std::runtime_error("Navigation data statement unavailable");
+            }
+
+            navQuery->addBindValue(context.flightId > 0 ? QVariant(context.flightId) : QVariant());
+            navQuery->addBindValue(context.flightName);
+            navQuery->addBindValue(data.timestamp.toString(Qt::ISODateWithMs));
+            navQuery->addBindValue(context.sourceName.isEmpty() ? QVariant() : QVariant(context.sourceName));
+
+            if (!navQuery->exec()) {
+                throw std::runtime_error(
+                    "Navigation data insert failed: " +
+                    navQuery->lastError().text().toStdString());
+            }
+
+            context.currentNavId = navQuery->lastInsertId().toInt();
+        }
+
+        // Лямбда для выполнения запросов
+        auto executeQuery = [&](QSqlQuery *query, const QString &context) {
+            if (!query->exec()) {
+                throw std::runtime_error(
+                    QString("%1 failed: %2")
+                        .arg(context)
+                        .arg(query->lastError().text())
+                        .toStdString());
+            }
+        };
+        auto prepared = [&](const char *sql) {
+            QSqlQuery *query = statement(data.type, sql);
+            if (!query) {
+                throw std::runtime_error(std::string("Statement unavailable for ") + msgTypeName(data.type));
+            }
+            return query;
+        };
+
+        // Обработка данных в зависимости от типа
+        switch (data.type) {
+        case MsgType::GNRMC: {
+            const GNRMCData &d = std::get<GNRMCData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gnrmc_data "
+                "(navigation_data_id, time, date, latitude, longitude, "
+                "speed, course, isValid, magnDeviation, coordinateDefinition, statusNav) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.date.toString("yyyy-MM-dd"));
+            q->addBindValue(d.latitude);
+            q->addBindValue(d.longitude);
+            q->addBindValue(d.speed);
+            q->addBindValue(d.course);
+            q->addBindValue(d.isValid);
+            q->addBindValue(d.magnDeviation);
+            q->addBindValue(static_cast<int>(d.coordinateDefinition));
+            q->addBindValue(d.statusNav);
+
+            executeQuery(q, "GNRMC insert");
+            break;
+        }
+
+        case MsgType::GNGGA: {
+            const GNGGAData &d = std::get<GNGGAData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gngga_data "
+                "(navigation_data_id, time, latitude, longitude, coordDef, "
+                "satellitesCount, hdop, altitude, altUnit, diffElipsoidSeaLevel, "
+                "diffElipsUnit, countSecDGPS, idDGPS) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.latitude);
+            q->addBindValue(d.longitude);
+            q->addBindValue(static_cast<int>(d.coordDef));
+            q->addBindValue(d.satellitesCount);
+            q->addBindValue(static_cast<int>(d.HDOP));
+            q->addBindValue(d.altitude);
+            q->addBindValue(static_cast<int>(d.altUnit));
+            q->addBindValue(d.diffElipsoidSeaLevel);
+            q->addBindValue(static_cast<int>(d.diffElipsUnit));
+            q->addBindValue(static_cast<int>(d.countSecDGPS));
+            q->addBindValue(d.idDGPS);
+
+            executeQuery(q, "GNGGA insert");
+            break;
+        }
+
+        case MsgType::GNGSA: {
+            const GNGSAData &d = std::get<GNGSAData>(data.payload);
+
+            QJsonArray satellites;
+            for (int id : d.satellitesUsedId) {
+                if (id > 0) {
+                    satellites.append(id);
+                }
+            }
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gngsa_data "
+                "(navigation_data_id, isAuto, typeFormat, typeGNSS, "
+                "satellitesUsed, pdop, hdop, vdop) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.isAuto);
+            q->addBindValue(static_cast<int>(d.typeFormat));
+            q->addBindValue(static_cast<int>(d.typeGNSS));
+            q->addBindValue(QJsonDocument(satellites).toJson(QJsonDocument::Compact));
+            q->addBindValue(static_cast<int>(d.PDOP));
+            q->addBindValue(static_cast<int>(d.HDOP));
+            q->addBindValue(static_cast<int>(d.VDOP));
+
+            executeQuery(q, "GSA insert");
+            break;
+        }
+
+        case MsgType::GNZDA: {
+            const GNZDAData &d = std::get<GNZDAData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gnzda_data "
+                "(navigation_data_id, time, date, localOffset) "
+                "VALUES (?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.date.toString("yyyy-MM-dd"));
+            q->addBindValue(static_cast<int>(d.localOffset));
+
+            executeQuery(q, "GNZDA insert");
+            break;
+        }
+
+        case MsgType::GNDHV: {
+            const GNDHVData &d = std::get<GNDHVData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gndhv_data "
+                "(navigation_data_id, time, speed3D, speedECEF_X, "
+                "speedECEF_Y, speedECEF_Z, speed) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.speed3D);
+            q->addBindValue(d.speedECEF_X);
+            q->addBindValue(d.speedECEF_Y);
+            q->addBindValue(d.speedECEF_Z);
+            q->addBindValue(d.speed);
+
+            executeQuery(q, "GNDHV insert");
+            break;
+        }
+
+        case MsgType::GNGST: {
+            const GNGSTData &d = std::get<GNGSTData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gngst_data "
+                "(navigation_data_id, time, rms, semiMajorError, "
+                "semiMinorError, semiMajorOrientation, latitudeError, "
+                "longitudeError, altitudeError) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.rms);
+            q->addBindValue(d.semiMajorError);
+            q->addBindValue(d.semiMinorError);
+            q->addBindValue(d.semiMajorOrientation);
+            q->addBindValue(d.latitudeError);
+            q->addBindValue(d.longitudeError);
+            q->addBindValue(d.altitudeError);
+
+            executeQuery(q, "GNGST insert");
+            break;
+        }
+
+        case MsgType::GPTXT: {
+            const GPTXTData &d = std::get<GPTXTData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gptxt_data "
+                "(navigation_data_id, messageCount, messageNumber, messageType, message) "
+                "VALUES (?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.messageCount);
+            q->addBindValue(d.messageNumber);
+            q->addBindValue(d.messageType);
+            q->addBindValue(d.message);
+
+            executeQuery(q, "GPTXT insert");
+            break;
+        }
+
+        case MsgType::GNGLL: {
+            const GNGLLData &d = std::get<GNGLLData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gngll_data "
+                "(navigation_data_id, latitude, longitude, time, isValid) "
+                "VALUES (?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.latitude);
+            q->addBindValue(d.longitude);
+            q->addBindValue(d.time.toString("HH:mm:ss.zzz"));
+            q->addBindValue(d.isValid);
+
+            executeQuery(q, "GNGLL insert");
+            break;
+        }
+
+        case MsgType::GNVTG: {
+            const GNVTGData &d = std::get<GNVTGData>(data.payload);
+
+            QSqlQuery *q = prepared(
+                "INSERT INTO gnvtg_data "
+                "(navigation_data_id, trueCourse, magneticCourse, "
+                "speedKnots, speedKmh, isValid) "
+                "VALUES (?, ?, ?, ?, ?, ?)");
+
+            q->addBindValue(context.currentNavId);
+            q->addBindValue(d.trueCourse);
+            q->addBindValue(d.magneticCourse);
+            q->addBindValue(d.speedKnots);
+            q->addBindValue(d.speedKmh);
+            q->addBindValue(d.isValid);
+
+            executeQuery(q, "GNVTG insert");
+            break;
+        }
+
+        case MsgType::GLGSV:
+            // Части GSV не пишутся по одной: EpochAssembler собирает их
+            // в обзор неба эпохи, который записывает insertFix в sky_view
+            break;
+
+        default:
+            throw std::runtime_error(
+                std::string("Unsupported message type: ") + msgTypeName(data.type));
+        }
+
+        return true;
+    }
+    catch (const std::exception& e) {
+        logError(QString("Save failed for %1: %2")
+                     .arg(msgTypeName(data.type))
+                     .arg(e.what()));
+        return false;
+    }
+}
+
+void NavigationBatchWriter::logError(const QString &message)
+{
+    if (m_logger) {
+        m_logger->log(Logger::Error, message);
+    } else {
+        qWarning("%s", qUtf8Printable(message));
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef NAVIGATIONBATCHWRITER_H
+#define NAVIGATIONBATCHWRITER_H
+
+#include "epochassembler.h"
+#include "logger.h"
+#include "NavigationData.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+#include <unordered_map>
+
+// Запись навигационных данных в SQLite пакетами.
+// Записи копятся в памяти и фиксируются одной транзакцией, когда набирается
+// maxRecords записей или проходит maxLatencyMs с момента первой записи в пакете.
+// Подготовленные INSERT-запросы кэшируются для каждой таблицы.
+// Параллельно сообщения собираются по эпохам в navigation_fix — по одной
+// записи на момент времени для графиков, карты и отчетов, и обзор неба
+// эпохи по GSV в sky_view.
+// Записи нескольких приемников различаются по NavigationData::sourceId:
+// у каждого источника свой полет, своя текущая строка navigation_data и
+// своя сборка эпох, строки помечаются именем источника.
+class NavigationBatchWriter : public QObject {
+    Q_OBJECT
+
+public:
+    explicit NavigationBatchWriter(const QString &connectionName = QLatin1String(QSqlDatabase::defaultConnection),
+                                   QObject *parent = nullptr);
+    ~NavigationBatchWriter();
+
+    void setLogger(Logger *logger);
+
+    // Пакетный режим. При выключенном режиме каждая запись фиксируется сразу
+    void setBatchMode(bool enabled, int maxRecords, int maxLatencyMs);
+    bool isBatchMode() const { return m_batchMode; }
+
+    // Смена полета по умолчанию — для источников без своего полета.
+    // Накопленный пакет записывается в предыдущий полет
+    void setFlightName(const QString &flightName);
+    // Имя и полет источника sourceId; пустой flightName — полет по умолчанию
+    void setSourceFlight(int sourceId, const QString &sourceName, const QString &flightName);
+    // Источник закрыт: его незавершенная эпоха записывается
+    void closeSource(int sourceId);
+
+    bool write(const NavigationData &data);
+    // closeEpoch — записать и незавершенную эпоху (конец данных, смена полета)
+    bool flush(bool closeEpoch = false);
+    void resetStatements();
+
+    int pendingCount() const { return m_pending.size(); }
+    quint64 totalRows() const { return m_totalRows; }
+    quint64 totalFixes() const { return m_totalFixes; }
+    double lastRowsPerSecond() const { return m_lastRowsPerSecond; }
+
+signals:
+    void batchCommitted(int rows, double rowsPerSecond);
+
+private:
+    struct SourceContext {
+        QString sourceName; // Пустое — строки без метки источника
+        QString flightName;
+        int flightId = 0;
+        int currentNavId = 0;
+        bool ownFlight = false;
+        EpochAssembler epochs;
+    };
+
+    // Чью незавершенную эпоху записать при фиксации: ничью, всех или источника с этим id
+    static constexpr int CloseNone = -2;
+    static constexpr int CloseAll = -1;
+
+    bool commit(const QVector<NavigationData> &records, int closeSourceId = CloseNone);
+    bool insertRecord(SourceContext &context, const NavigationData &data);
+    bool insertFix(SourceContext &context, const NavigationFix &fix);
+    bool insertSkyView(const SourceContext &context, int fixId, const SkyView &sky);
+    SourceContext &context(int sourceId);
+    int lookupFlightId(const QString &flightName);
+    bool hasPendingEpochs() const;
+    QSqlQuery *statement(int key, const char *sql);
+    void logError(const QString &message);
+
+    QSqlDatabase database() const;
+
+    QString m_connectionName;
+    QHash<int, QSqlQuery> m_statements;
+    QVector<NavigationData> m_pending;
+    QTimer m_flushTimer;
+    std::unordered_map<int, std::unique_ptr<SourceContext>> m_sources;
+
+    bool m_batchMode = false;
+    int m_maxRecords = 500;
+    int m_maxLatencyMs = 250;
+
+    // Полет по умолчанию
+    QString m_flightName;
+    int m_flightId = 0;
+
+    quint64 m_totalRows = 0;
+    quint64 m_totalFixes = 0;
+    double m_lastRowsPerSecond = 0.0;
+
+    // Сводка пакетов для журнала: одна строка Info за SUMMARY_INTERVAL_MS
+    QElapsedTimer m_summaryTimer;
+    quint64 m_summaryRows = 0;
+    int m_summaryBatches = 0;
+
+    Logger *m_logger = nullptr;
+};
+
+#endif // NAVIGATIONBATCHWRITER_H
@@ -0,0 +1,304 @@
+#include "rawcapturerecorder.h"
+#include "captureformat.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Свободное имя для новой сессии: <имя>.bin, затем <имя>_2.bin, <имя>_3.bin...
+QString freeCapturePath(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists() || info.size() == 0) {
+        return filePath;
+    }
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    for (int n = 2;; ++n) {
+        const QString candidate = info.dir().filePath(QString("%1_%2%3").arg(info.completeBaseName()).arg(n).arg(suffix));
+        const QFileInfo next(candidate);
+        if (!next.exists() || next.size() == 0) {
+            return candidate;
+        }
+    }
+}
+}
+
+RawCaptureRecorder::RawCaptureRecorder(QObject *parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName("RawCapture");
+    m_context.moveToThread(&m_thread);
+}
+
+RawCaptureRecorder::~RawCaptureRecorder()
+{
+    close();
+}
+
+void RawCaptureRecorder::setLogger(Logger *logger)
+{
+    m_logger = logger;
+}
+
+void RawCaptureRecorder::setThresholds(int flushBytes, int flushIntervalMs, int maxBufferedBytes)
+{
+    m_flushBytes = qMax(1, flushBytes);
+    m_flushIntervalMs = qMax(1, flushIntervalMs);
+    m_maxBufferedBytes = qMax(m_flushBytes, maxBufferedBytes);
+}
+
+RawCaptureRecorder::SyncPolicy RawCaptureRecorder::syncPolicyFromString(const QString &name)
+{
+    if (name == "none") {
+        return NoSync;
+    }
+    if (name == "flush") {
+        return SyncOnFlush;
+    }
+    return SyncOnClose;
+}
+
+bool RawCaptureRecorder::open(const QString &filePath)
+{
+    close();
+
+    // Метки порций отсчитываются от заголовка файла — сессия с метками не
+    // дописывается к чужому файлу, а начинает свой
+    m_filePath = m_timestamps ? freeCapturePath(filePath) : filePath;
+    // Два буфера по порогу сброса с запасом: в обычном режиме прием не выделяет память
+    m_buffer.reserve(m_flushBytes * 2);
+    m_spare.reserve(m_flushBytes * 2);
+
+    m_thread.start();
+    bool opened = false;
+    QMetaObject::invokeMethod(&m_context, [this, &opened]() {
+        opened = openFile();
+    }, Qt::BlockingQueuedConnection);
+
+    if (!opened) {
+        m_thread.quit();
+        m_thread.wait();
+        return false;
+    }
+    m_open.store(true, std::memory_order_release);
+    return true;
+}
+
+void RawCaptureRecorder::close()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    m_open.store(false, std::memory_order_release);
+    QMetaObject::invokeMethod(&m_context, [this]() {
+        drainBuffer();
+        closeFile();
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+
+    // Байты, пришедшие во время закрытия, в файл уже не попадут
+    QMutexLocker locker(&m_bufferMutex);
+    m_dropped.fetch_add(static_cast<quint64>(m_buffer.size()), std::memory_order_relaxed);
+    m_buffer.resize(0);
+}
+
+void RawCaptureRecorder::write(const char *data, int size, quint16 sourceId, bool endOfMessage)
+{
+    if (size <= 0 || !m_open.load(std::memory_order_acquire)) {
+        return;
+    }
+    m_received.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+
+    bool full = false;
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        if (m_buffer.size() + size + CaptureChunkHeaderMaxSize > m_maxBufferedBytes) {
+            // Диск не успевает — прием важнее полноты записи
+            m_dropped.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+            return;
+        }
+        if (m_chunked) {
+            // Метка берется под мьютексом: приращения порций не бывают отрицательными
+            const qint64 nowUs = m_chunkClock.nsecsElapsed() / 1000;
+            CaptureChunkHeader header;
+            header.deltaUs = static_cast<quint64>(nowUs - m_lastChunkUs);
+            header.sourceId = sourceId;
+            header.endOfMessage = endOfMessage;
+            header.length = static_cast<quint32>(size);
+            m_lastChunkUs = nowUs;
+
+            char encoded[CaptureChunkHeaderMaxSize];
+            m_buffer.append(encoded, encodeCaptureChunkHeader(encoded, header));
+        }
+        m_buffer.append(data, size);
+        full = m_buffer.size() >= m_flushBytes;
+    }
+
+    if (full) {
+        scheduleDrain();
+    }
+}
+
+void RawCaptureRecorder::flush()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+    QMetaObject::invokeMethod(&m_context, [this]() { drainBuffer(); }, Qt::BlockingQueuedConnection);
+}
+
+RawCaptureRecorder::Stats RawCaptureRecorder::stats() const
+{
+    Stats s;
+    s.bytesReceived = m_received.load(std::memory_order_relaxed);
+    s.bytesWritten = m_written.load(std::memory_order_relaxed);
+    s.bytesDropped = m_dropped.load(std::memory_order_relaxed);
+    s.flushes = m_flushes.load(std::memory_order_relaxed);
+    s.bytesPerSecond = static_cast<double>(m_bytesPerSecond.load(std::memory_order_relaxed));
+    return s;
+}
+
+void RawCaptureRecorder::scheduleDrain()
+{
+    // Одно ожидающее пробуждение на любое число заполненных порций
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(&m_context, [this]() { drainBuffer(); }, Qt::QueuedConnection);
+    }
+}
+
+bool RawCaptureRecorder::openFile()
+{
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::Append | QIODevice::WriteOnly)) {
+        if (m_logger) {
+            m_logger->log(Logger::Error, "Не удалось открыть файл для записи: " + m_file.errorString());
+        }
+        return false;
+    }
+
+    // Файл с метками всегда новый и начинается с заголовка
+    m_chunked = false;
+    if (m_timestamps && m_file.size() == 0) {
+        char header[CaptureFileHeaderSize];
+        writeCaptureFileHeader(header, QDateTime::currentMSecsSinceEpoch());
+        m_chunked = m_file.write(header, CaptureFileHeaderSize) == CaptureFileHeaderSize;
+    }
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        m_chunkClock.start();
+        m_lastChunkUs = 0;
+    }
+
+    // Таймер создается в потоке записи и срабатывает в нем же
+    m_flushTimer = new QTimer();
+    connect(m_flushTimer, &QTimer::timeout, &m_context, [this]() {
+        drainBuffer();
+        updateRate();
+    });
+    m_flushTimer->start(m_flushIntervalMs);
+    m_rateTimer.start();
+    m_rateBytes = m_written.load(std::memory_order_relaxed);
+
+    if (m_logger) {
+        m_logger->log(Logger::Info, QString("Запись потока в %1 (сброс по %2 байт или %3 мс, fsync %4%5)")
+                                        .arg(m_filePath)
+                                        .arg(m_flushBytes)
+                                        .arg(m_flushIntervalMs)
+                                        .arg(m_syncPolicy)
+                                        .arg(m_chunked ? ", метки времени" : ""));
+    }
+    return true;
+}
+
+void RawCaptureRecorder::closeFile()
+{
+    delete m_flushTimer;
+    m_flushTimer = nullptr;
+
+    if (m_syncPolicy != NoSync) {
+        syncFile();
+    }
+    m_file.close();
+    m_bytesPerSecond.store(0, std::memory_order_relaxed);
+
+    if (m_logger) {
+        const Stats s = stats();
+        m_logger->log(Logger::Info, QString("Запись потока %1 закрыта: принято %2 байт, записано %3, "
+                                            "потеряно %4, сбросов %5")
+                                        .arg(m_filePath)
+                                        .arg(s.bytesReceived)
+                                        .arg(s.bytesWritten)
+                                        .arg(s.bytesDropped)
+                                        .arg(s.flushes));
+    }
+}
+
+void RawCaptureRecorder::drainBuffer()
+{
+    m_drainScheduled.store(false, std::memory_order_release);
+
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        qSwap(m_buffer, m_spare);
+    }
+    if (m_spare.isEmpty() || !m_file.isOpen()) {
+        return;
+    }
+
+    // Одна запись на порцию; flush() передает ее ОС, fsync — по политике
+    const qint64 written = m_file.write(m_spare);
+    if (written != m_spare.size() || !m_file.flush()) {
+        if (m_logger) {
+            m_logger->log(Logger::Error, "Ошибка записи в файл: " + m_file.errorString());
+        }
+        m_dropped.fetch_add(static_cast<quint64>(m_spare.size() - qMax<qint64>(written, 0)),
+                            std::memory_order_relaxed);
+    }
+    m_written.fetch_add(static_cast<quint64>(qMax<qint64>(written, 0)), std::memory_order_relaxed);
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_syncPolicy == SyncOnFlush) {
+        syncFile();
+    }
+    // Емкость зарезервирована, resize(0) память не освобождает
+    m_spare.resize(0);
+}
+
+void RawCaptureRecorder::updateRate()
+{
+    const qint64 elapsedMs = m_rateTimer.restart();
+    const quint64 written = m_written.load(std::memory_order_relaxed);
+    if (elapsedMs > 0) {
+        m_bytesPerSecond.store((written - m_rateBytes) * 1000 / static_cast<quint64>(elapsedMs),
+                               std::memory_order_relaxed);
+    }
+    m_rateBytes = written;
+}
+
+bool RawCaptureRecorder::syncFile()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    const bool synced = _commit(m_file.handle()) == 0;
+#else
+    const bool synced = ::fsync(m_file.handle()) == 0;
+#endif
+    if (!synced && m_logger) {
+        m_logger->log(Logger::Warning, "fsync failed for " + m_filePath);
+    }
+    return synced;
+}
@@ -0,0 +1,113 @@
+#ifndef RAWCAPTURERECORDER_H
+#define RAWCAPTURERECORDER_H
+
+#include "logger.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+
+// Запись сырого потока приема (.bin). Файл открыт все время записи, байты
+// копятся в буфере и сбрасываются на диск отдельным потоком — по объему
+// (flushBytes) или по времени (flushIntervalMs). Поток приема только
+// копирует байты под мьютексом и не ждет диска. Если диск не успевает и
+// в буфере больше maxBufferedBytes, новые данные отбрасываются и учитываются.
+// Каждая порция записывается с меткой времени приема и id источника
+// (captureformat.h) — запись можно воспроизвести в исходном темпе.
+class RawCaptureRecorder : public QObject {
+    Q_OBJECT
+
+public:
+    // Когда вызывать fsync
+    enum SyncPolicy {
+        NoSync,      // Только запись в кэш ОС
+        SyncOnFlush, // После каждого сброса буфера
+        SyncOnClose  // При закрытии файла
+    };
+    Q_ENUM(SyncPolicy)
+
+    struct Stats {
+        quint64 bytesReceived = 0;
+        quint64 bytesWritten = 0;
+        quint64 bytesDropped = 0;
+        quint64 flushes = 0;
+        double bytesPerSecond = 0.0; // Запись на диск за последний интервал
+    };
+
+    explicit RawCaptureRecorder(QObject *parent = nullptr);
+    ~RawCaptureRecorder();
+
+    void setLogger(Logger *logger);
+    // Применяются при следующем open()
+    void setThresholds(int flushBytes, int flushIntervalMs, int maxBufferedBytes);
+    void setSyncPolicy(SyncPolicy policy) { m_syncPolicy = policy; }
+    // false — прежний формат без меток времени
+    void setTimestamps(bool enabled) { m_timestamps = enabled; }
+
+    // Открывает файл; предыдущий файл закрывается. Без меток времени файл
+    // дописывается, с метками непустой файл не трогается — запись идет в
+    // <имя>_2.bin и далее (фактическое имя — filePath())
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); }
+    QString filePath() const { return m_filePath; }
+
+    // Вызывается из потока приема; endOfMessage — порция является целой датаграммой
+    void write(const char *data, int size, quint16 sourceId = 0, bool endOfMessage = false);
+    void write(const QByteArray &data) { write(data.constData(), data.size()); }
+
+    // Дожидается записи всего, что уже в буфере
+    void flush();
+
+    Stats stats() const;
+
+    static SyncPolicy syncPolicyFromString(const QString &name);
+
+private:
+    // Выполняются только в потоке записи
+    bool openFile();
+    void closeFile();
+    void drainBuffer();
+    void updateRate();
+    bool syncFile();
+
+    void scheduleDrain();
+
+    QString m_filePath;
+    QFile m_file;
+    SyncPolicy m_syncPolicy = SyncOnClose;
+    int m_flushBytes = 256 * 1024;
+    int m_flushIntervalMs = 500;
+    int m_maxBufferedBytes = 16 * 1024 * 1024;
+    bool m_timestamps = true;
+
+    QMutex m_bufferMutex;
+    QByteArray m_buffer; // Заполняет поток приема
+    QByteArray m_spare;  // Пишет на диск поток записи; буферы меняются местами
+    bool m_chunked = false;    // Порции пишутся с заголовками
+    QElapsedTimer m_chunkClock; // Время приема порций, под m_bufferMutex
+    qint64 m_lastChunkUs = 0;
+
+    QThread m_thread;
+    QObject m_context; // Живет в потоке записи, через него вызываются методы потока
+    QTimer *m_flushTimer = nullptr;
+    QElapsedTimer m_rateTimer;
+    quint64 m_rateBytes = 0;
+    Logger *m_logger = nullptr;
+
+    std::atomic<bool> m_open{false};
+    std::atomic<bool> m_drainScheduled{false};
+    std::atomic<quint64> m_received{0};
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_flushes{0};
+    std::atomic<quint64> m_bytesPerSecond{0};
+};
+
+#endif // RAWCAPTURERECORDER_H
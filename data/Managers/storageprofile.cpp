@@ -0,0 +1,72 @@
+#include "storageprofile.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+
+namespace {
+struct ProfileSettings {
+    const char *journalMode;
+    const char *synchronous;
+    int cacheSizeKb;     // Отрицательное cache_size в SQLite — размер в КиБ
+    qint64 mmapSize;
+    const char *tempStore;
+};
+
+ProfileSettings settingsFor(StorageProfile profile)
+{
+    switch (profile) {
+    case StorageProfile::FastIngest:
+        return {"WAL", "NORMAL", 64 * 1024, 256LL * 1024 * 1024, "MEMORY"};
+    case StorageProfile::ReadOptimized:
+        return {"WAL", "NORMAL", 256 * 1024, 1024LL * 1024 * 1024, "MEMORY"};
+    case StorageProfile::Safe:
+    default:
+        return {"DELETE", "FULL", 2 * 1024, 0, "DEFAULT"};
+    }
+}
+}
+
+StorageProfile storageProfileFromString(const QString &name)
+{
+    if (name == "fast-ingest") {
+        return StorageProfile::FastIngest;
+    }
+    if (name == "read-optimized") {
+        return StorageProfile::ReadOptimized;
+    }
+    return StorageProfile::Safe;
+}
+
+const char *storageProfileName(StorageProfile profile)
+{
+    switch (profile) {
+    case StorageProfile::FastIngest:    return "fast-ingest";
+    case StorageProfile::ReadOptimized: return "read-optimized";
+    case StorageProfile::Safe:
+    default:                            return "safe";
+    }
+}
+
+bool applyStorageProfile(QSqlDatabase &db, StorageProfile profile, QString *error)
+{
+    const ProfileSettings s = settingsFor(profile);
+    const QStringList pragmas = {
+        QString("PRAGMA journal_mode=%1").arg(s.journalMode),
+        QString("PRAGMA synchronous=%1").arg(s.synchronous),
+        QString("PRAGMA cache_size=-%1").arg(s.cacheSizeKb),
+        QString("PRAGMA mmap_size=%1").arg(s.mmapSize),
+        QString("PRAGMA temp_store=%1").arg(s.tempStore)
+    };
+
+    QSqlQuery query(db);
+    for (const QString &pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            if (error) {
+                *error = QString("%1 failed: %2").arg(pragma, query.lastError().text());
+            }
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef STORAGEPROFILE_H
+#define STORAGEPROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+// Профиль хранения SQLite: журнал, уровень синхронизации, кэш страниц,
+// mmap и размещение временных таблиц. Применяется при открытии соединения.
+enum class StorageProfile {
+    Safe,          // Журнал отката и полный fsync — как раньше
+    FastIngest,    // WAL и synchronous=NORMAL: максимум вставок в секунду
+    ReadOptimized  // WAL, большой кэш и mmap для отчетов по длинным полетам
+};
+
+StorageProfile storageProfileFromString(const QString &name);
+const char *storageProfileName(StorageProfile profile);
+
+// Возвращает false и текст ошибки, если какая-то из PRAGMA не выполнилась
+bool applyStorageProfile(QSqlDatabase &db, StorageProfile profile, QString *error = nullptr);
+
+#endif // STORAGEPROFILE_H
@@ -3,22 +3,10 @@
 #include <QDebug>
 #include <QQuickView>
 #include <QQmlApplicationEngine>
-#include <gtest/gtest.h>
 #include <QSettings>
 #include <mainwindow.h>
 #include <settings.h>
 
-// Класс для запуска тестов в отдельном потоке
-class TestRunner : public QThread {
-protected:
-    void run() override {
-        ::testing::InitGoogleTest();
-        int result = RUN_ALL_TESTS(); // Запуск всех тестов
-        qDebug() << "Тесты завершены с кодом:" << result;
-        QCoreApplication::exit(result); // Завершение приложения с кодом результата тестов
-    }
-};
-
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
@@ -30,9 +18,6 @@ int main(int argc, char *argv[])
     qmlRegisterUncreatableType<Logger>("App.Logging", 1, 0, "Logger",
                                        "Cannot create Logger instances in QML");
     qRegisterMetaType<Logger::LogLevel>("LogLevel");
-    // Запуск тестов в отдельном потоке
-    TestRunner testRunner;
-    //testRunner.start();
 
     QSettings settings("Cometa", "Cometa");
     QString dbPath = settings.value("databasePath", QDir::currentPath() + "/database/mydatabase.db").toString();
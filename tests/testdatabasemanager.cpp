@@ -1,2 +1,435 @@
 #include "testdatabasemanager.h"
+#include "flightcache.h"
 
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+namespace {
+// Драйвер QSQLITE загружается как плагин — нужен экземпляр приложения
+void ensureApplication()
+{
+    static int argc = 1;
+    static char name[] = "cometa_tests";
+    static char *argv[] = {name, nullptr};
+    if (!QCoreApplication::instance()) {
+        new QCoreApplication(argc, argv);
+    }
+}
+
+// База версии 0, как ее оставляли первые версии программы: рейсы по имени,
+// без flight_id, navigation_fix и индексов. Третья строка — без RMC
+bool createLegacyDatabase(const QString &path)
+{
+    bool created = true;
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase("QSQLITE", "legacy");
+        legacy.setDatabaseName(path);
+        if (!legacy.open()) {
+            created = false;
+        } else {
+            QSqlQuery query(legacy);
+            const QStringList statements = {
+                "CREATE TABLE gnrmc_data ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "navigation_data_id INTEGER NOT NULL, "
+                "time TEXT, date TEXT, latitude REAL, longitude REAL, speed REAL, course REAL, "
+                "isValid INTEGER, magnDeviation REAL, coordinateDefinition INTEGER, statusNav INTEGER, "
+                "FOREIGN KEY(navigation_data_id) REFERENCES navigation_data(id))",
+                "CREATE TABLE navigation_data ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "flight_name TEXT NOT NULL, "
+                "timestamp TEXT NOT NULL, "
+                "FOREIGN KEY(flight_name) REFERENCES flights(flight_name))",
+                "CREATE TABLE flights ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "flight_name TEXT NOT NULL UNIQUE, "
+                "status TEXT, "
+                "createdAt TIMESTAMP DEFAULT CURRENT_TIMESTAMP)",
+                "INSERT INTO flights (flight_name) VALUES ('Old_1')",
+                "INSERT INTO navigation_data (flight_name, timestamp) VALUES "
+                "('Old_1', '2024-12-06T05:27:14.000'), "
+                "('Old_1', '2024-12-06T05:27:15.000'), "
+                "('Old_2', '2024-12-06T06:00:00.000')",
+                "INSERT INTO gnrmc_data (navigation_data_id, time, date, latitude, longitude, "
+                "speed, course, isValid) VALUES "
+                "(1, '05:27:14.000', '2024-12-06', 56.4151, 61.8903, 0.12, 0, 1), "
+                "(2, '05:27:15.000', '2024-12-06', 56.4152, 61.8904, 0.13, 0, 1)",
+                "PRAGMA user_version = 0"
+            };
+            for (const QString &statement : statements) {
+                if (!query.exec(statement)) {
+                    created = false;
+                    break;
+                }
+            }
+            legacy.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("legacy");
+    return created;
+}
+
+NavigationFix makeFix(int id, const QTime &time, double speed, bool valid)
+{
+    NavigationFix fix;
+    fix.id = id;
+    fix.timestamp = QDateTime(QDate(2024, 12, 6), time, Qt::UTC);
+    fix.date = QDate(2024, 12, 6);
+    fix.time = time;
+    fix.isValid = valid;
+    fix.latitude = 56.4151;
+    fix.longitude = 61.8903;
+    fix.speed = speed;
+    return fix;
+}
+
+std::shared_ptr<const FlightColumns> makeColumns(int rows)
+{
+    std::shared_ptr<FlightColumns> columns = std::make_shared<FlightColumns>();
+    for (int i = 0; i < rows; ++i) {
+        columns->append(makeFix(i + 1, QTime(5, 27, 14).addSecs(i), i, true));
+    }
+    return columns;
+}
+}
+
+void TestDataBaseManager::SetUp()
+{
+    ensureApplication();
+}
+
+void TestDataBaseManager::TearDown()
+{
+    closeDatabase();
+}
+
+void TestDataBaseManager::closeDatabase()
+{
+    if (dbManager) {
+        dbManager->close();
+        delete dbManager;
+        dbManager = nullptr;
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+}
+
+bool TestDataBaseManager::openDatabase(const QString &dbName)
+{
+    dbManager = new DatabaseManager(dbName);
+    return QSqlDatabase::database(QLatin1String(QSqlDatabase::defaultConnection), false).isOpen();
+}
+
+int TestDataBaseManager::queryInt(const QString &sql)
+{
+    QSqlQuery query;
+    if (!query.exec(sql) || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+NavigationData TestDataBaseManager::rmc(const char *time, quint16 sourceId)
+{
+    const QByteArray body = QByteArray("GNRMC,") + time
+                            + ",A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V";
+    quint8 checksum = 0;
+    for (const char c : body) {
+        checksum ^= static_cast<quint8>(c);
+    }
+    const QByteArray line = "$" + body + "*" + QByteArray::number(checksum, 16).rightJustified(2, '0').toUpper();
+
+    NavigationData data = parser.parseData(line);
+    data.sourceId = sourceId;
+    return data;
+}
+
+// Пакетный режим: записи лежат в памяти до flushPendingData, а он
+// записывает и незавершенную эпоху
+TEST_F(TestDataBaseManager, BatchHoldsRecordsUntilFlush) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_batch"));
+    dbManager->setBatchMode(true, 100, 60000);
+
+    for (const char *time : {"052714.00", "052715.00", "052716.00"}) {
+        const NavigationData data = rmc(time);
+        ASSERT_EQ(data.result, OK);
+        ASSERT_TRUE(dbManager->saveNavigationData(data));
+    }
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data"), 0);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 0);
+
+    ASSERT_TRUE(dbManager->flushPendingData());
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM gnrmc_data"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix "
+                       "WHERE flight_id = (SELECT id FROM flights WHERE flight_name = 'Flight_batch')"), 3);
+}
+
+// Пакет фиксируется сам, как только набирается maxRecords записей
+TEST_F(TestDataBaseManager, BatchCommitsAtMaxRecords) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_batch"));
+    dbManager->setBatchMode(true, 2, 60000);
+
+    int committedRows = 0;
+    QObject::connect(dbManager, &DatabaseManager::batchCommitted, [&](int rows, double) {
+        committedRows += rows;
+    });
+
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00")));
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data"), 0);
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00")));
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data"), 2);
+    EXPECT_EQ(committedRows, 2);
+    // Вторая эпоха еще открыта — ее закроет следующее время или flush
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 1);
+}
+
+// Новый полет: накопленный пакет записывается в предыдущий
+TEST_F(TestDataBaseManager, NewFlightFlushesPreviousBatch) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_a"));
+    dbManager->setBatchMode(true, 100, 60000);
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00")));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00")));
+
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_b"));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052716.00")));
+    ASSERT_TRUE(dbManager->flushPendingData());
+
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_a'"), 2);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_b'"), 1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                       "WHERE l.flight_name = 'Flight_a'"), 2);
+}
+
+// Старая база проходит всю цепочку миграций 0 -> 5 с сохранением данных,
+// повторное открытие миграции не повторяет
+TEST_F(TestDataBaseManager, MigratesLegacyDatabaseToCurrentSchema) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath("legacy.db");
+    ASSERT_TRUE(createLegacyDatabase(path));
+
+    ASSERT_TRUE(openDatabase(path));
+    EXPECT_EQ(dbManager->schemaVersion(), 5);
+    // Рейс, известный только по navigation_data, тоже попадает в flights
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM flights"), 2);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_id IS NULL"), 0);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data n JOIN flights f ON f.id = n.flight_id "
+                       "WHERE f.flight_name = n.flight_name"), 3);
+    // Эпохи строятся только из строк с RMC
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 2);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                       "WHERE l.flight_name = 'Old_1' AND f.date = '2024-12-06' AND f.sources = 1"), 2);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name = 'idx_gnrmc_nav'"), 1);
+
+    closeDatabase();
+    ASSERT_TRUE(openDatabase(path));
+    EXPECT_EQ(dbManager->schemaVersion(), 5);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 2);
+}
+
+// База новее программы не трогается
+TEST_F(TestDataBaseManager, RejectsNewerSchema) {
+    ASSERT_TRUE(openDatabase());
+    QSqlQuery query;
+    ASSERT_TRUE(query.exec("PRAGMA user_version = 99"));
+    EXPECT_FALSE(dbManager->migrateSchema());
+    EXPECT_EQ(dbManager->schemaVersion(), 99);
+}
+
+// Фильтр, сортировка и validOnly по столбцам — как WHERE/ORDER BY в SQLite
+TEST(FlightColumnsTest, SelectFiltersAndSorts) {
+    FlightColumns columns;
+    columns.append(makeFix(1, QTime(5, 27, 14), 3.0, true));
+    columns.append(makeFix(2, QTime(5, 27, 15), 1.0, false));
+    columns.append(makeFix(3, QTime(5, 27, 16), 2.0, true));
+
+    EXPECT_EQ(columns.select("", "", "speed", false, false), (std::vector<int>{1, 2, 0}));
+    EXPECT_EQ(columns.select("", "", "speed", true, true), (std::vector<int>{0, 2}));
+    EXPECT_EQ(columns.select("", "", "id", true, false), (std::vector<int>{2, 1, 0}));
+    EXPECT_EQ(columns.select("Speed", "2", "id", false, false), (std::vector<int>{2}));
+    EXPECT_EQ(columns.select("Time", "05:27:15.000", "id", false, false), (std::vector<int>{1}));
+    EXPECT_EQ(columns.select("Date", "2024-12-06", "id", false, true), (std::vector<int>{0, 2}));
+    // Неизвестное поле фильтра не отбрасывает строки
+    EXPECT_EQ(columns.select("Unknown", "1", "unknown", false, false), (std::vector<int>{0, 1, 2}));
+}
+
+// Эпоха без даты (только GGA, до первого RMC/ZDA) сохраняет время суток
+TEST(FlightColumnsTest, DatelessEpochKeepsTime) {
+    NavigationFix fix = makeFix(1, QTime(5, 27, 14, 500), 0.0, true);
+    fix.date = QDate();
+
+    FlightColumns columns;
+    columns.append(fix);
+    ASSERT_EQ(columns.size(), 1);
+    EXPECT_EQ(columns.date[0], FlightColumns::NoDate);
+
+    const NavigationFix restored = columns.fix(0);
+    EXPECT_FALSE(restored.date.isValid());
+    EXPECT_EQ(restored.time, QTime(5, 27, 14, 500));
+    EXPECT_EQ(columns.select("Time", "05:27:14.500", "id", false, false), (std::vector<int>{0}));
+    EXPECT_TRUE(columns.select("Date", "2024-12-06", "id", false, false).empty());
+}
+
+// Вытесняется давно не использованный полет; find() делает полет свежим
+TEST(FlightCacheTest, EvictsLeastRecentlyUsed) {
+    const std::shared_ptr<const FlightColumns> a = makeColumns(100);
+    const std::shared_ptr<const FlightColumns> b = makeColumns(100);
+    const std::shared_ptr<const FlightColumns> c = makeColumns(100);
+
+    FlightCache cache(a->memoryBytes() * 2 + a->memoryBytes() / 2);
+    cache.insert("a", a);
+    cache.insert("b", b);
+    EXPECT_EQ(cache.find("a"), a);
+
+    cache.insert("c", c);
+    EXPECT_EQ(cache.find("b"), nullptr);
+    EXPECT_EQ(cache.find("a"), a);
+    EXPECT_EQ(cache.find("c"), c);
+    EXPECT_EQ(cache.memoryBytes(), a->memoryBytes() + c->memoryBytes());
+
+    // Уменьшение лимита вытесняет сразу
+    cache.setMaxBytes(c->memoryBytes());
+    EXPECT_EQ(cache.find("a"), nullptr);
+    EXPECT_EQ(cache.find("c"), c);
+}
+
+TEST(FlightCacheTest, InvalidateAndReplace) {
+    FlightCache cache;
+    cache.insert("a", makeColumns(10));
+    const std::shared_ptr<const FlightColumns> longer = makeColumns(20);
+    cache.insert("a", longer);
+    EXPECT_EQ(cache.find("a"), longer);
+    EXPECT_EQ(cache.memoryBytes(), longer->memoryBytes());
+
+    cache.invalidate("a");
+    EXPECT_EQ(cache.find("a"), nullptr);
+    EXPECT_EQ(cache.memoryBytes(), 0u);
+}
+
+// Кэш полета догружает новые эпохи и сбрасывается при удалении полета
+TEST_F(TestDataBaseManager, FlightColumnsFollowWrites) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_cache"));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00")));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00")));
+
+    std::shared_ptr<const FlightColumns> columns = dbManager->flightColumns("Flight_cache");
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->size(), 1);
+    EXPECT_EQ(dbManager->flightColumns("Flight_cache"), columns);
+
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052716.00")));
+    columns = dbManager->flightColumns("Flight_cache");
+    ASSERT_NE(columns, nullptr);
+    ASSERT_EQ(columns->size(), 2);
+    EXPECT_EQ(columns->fix(1).time, QTime(5, 27, 15));
+
+    ASSERT_TRUE(dbManager->deleteFlight("Flight_cache"));
+    columns = dbManager->flightColumns("Flight_cache");
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->size(), 0);
+}
+
+// У каждого приемника свой полет и своя сборка эпох: одинаковые секунды
+// от разных приемников не закрывают чужую эпоху, closeSource записывает последнюю
+TEST_F(TestDataBaseManager, SourcesWriteOwnFlightsAndEpochs) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_base"));
+    ASSERT_TRUE(dbManager->setSourceFlight(1, "udp:10.0.0.1:5000", "Flight_rx1"));
+    ASSERT_TRUE(dbManager->setSourceFlight(2, "udp:10.0.0.2:5000", "Flight_rx2"));
+
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00", 1)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00", 2)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00", 1)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00", 2)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052716.00", 1)));
+
+    const QString fixes = "SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                          "WHERE l.flight_name = '%1' AND f.source_name = '%2'";
+    EXPECT_EQ(queryInt(fixes.arg("Flight_rx1", "udp:10.0.0.1:5000")), 2);
+    EXPECT_EQ(queryInt(fixes.arg("Flight_rx2", "udp:10.0.0.2:5000")), 1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_rx1' "
+                       "AND source_name = 'udp:10.0.0.1:5000'"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_rx2' "
+                       "AND source_name = 'udp:10.0.0.2:5000'"), 2);
+
+    dbManager->closeSource(1);
+    EXPECT_EQ(queryInt(fixes.arg("Flight_rx1", "udp:10.0.0.1:5000")), 3);
+    EXPECT_EQ(queryInt(fixes.arg("Flight_rx2", "udp:10.0.0.2:5000")), 1);
+    dbManager->closeSource(2);
+    EXPECT_EQ(queryInt(fixes.arg("Flight_rx2", "udp:10.0.0.2:5000")), 2);
+
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_base'"), 0);
+}
+
+// Источник без своего полета пишет в полет по умолчанию со своей меткой,
+// единственный поток (sourceId 0) — без метки
+TEST_F(TestDataBaseManager, SourceWithoutFlightUsesDefault) {
+    ASSERT_TRUE(openDatabase());
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_base"));
+    ASSERT_TRUE(dbManager->setSourceFlight(3, "serial:ttyUSB0"));
+
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00", 3)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052715.00", 3)));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00")));
+    dbManager->closeSource(3);
+    ASSERT_TRUE(dbManager->flushPendingData());
+
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                       "WHERE l.flight_name = 'Flight_base' AND f.source_name = 'serial:ttyUSB0'"), 2);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix WHERE source_name IS NULL"), 1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE source_name IS NULL"), 1);
+}
+
+// Миграция 4 -> 5: столбцы source_name появляются, старые строки — единственный поток
+TEST_F(TestDataBaseManager, MigrationAddsSourceName) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath("legacy.db");
+    ASSERT_TRUE(createLegacyDatabase(path));
+
+    ASSERT_TRUE(openDatabase(path));
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM pragma_table_info('navigation_data') WHERE name = 'source_name'"), 1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM pragma_table_info('navigation_fix') WHERE name = 'source_name'"), 1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE source_name IS NULL"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix WHERE source_name IS NULL"), 2);
+
+    // Миграция не мешает писать новые строки с меткой источника
+    ASSERT_TRUE(dbManager->setSourceFlight(1, "udp:10.0.0.1:5000", "Old_1"));
+    ASSERT_TRUE(dbManager->saveNavigationData(rmc("052714.00", 1)));
+    dbManager->closeSource(1);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                       "WHERE l.flight_name = 'Old_1' AND f.source_name = 'udp:10.0.0.1:5000'"), 1);
+}
+
+// С фоновым писателем контекст источника применяется до возврата из
+// setSourceFlight: первые записи сразу после открытия источника не уходят
+// в полет по умолчанию
+TEST_F(TestDataBaseManager, BackgroundWriterAppliesSourceFlightBeforeFirstRecords) {
+    // Писатель открывает свое соединение — базе нужен файл
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(openDatabase(dir.filePath("writer.db")));
+    ASSERT_TRUE(dbManager->insertNewFlight("Flight_base"));
+    ASSERT_TRUE(dbManager->startBackgroundWriter(1024, DatabaseWriter::Block, QString()));
+
+    ASSERT_TRUE(dbManager->setSourceFlight(1, "replay:a.bin", "Flight_rx1"));
+    for (const char *time : {"052714.00", "052715.00", "052716.00"}) {
+        ASSERT_TRUE(dbManager->saveNavigationData(rmc(time, 1)));
+    }
+    dbManager->closeSource(1);
+    dbManager->stopBackgroundWriter();
+
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name = 'Flight_rx1' "
+                       "AND source_name = 'replay:a.bin'"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_data WHERE flight_name <> 'Flight_rx1' "
+                       "OR source_name IS NULL"), 0);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix f JOIN flights l ON l.id = f.flight_id "
+                       "WHERE l.flight_name = 'Flight_rx1' AND f.source_name = 'replay:a.bin'"), 3);
+    EXPECT_EQ(queryInt("SELECT COUNT(*) FROM navigation_fix"), 3);
+}
@@ -4,11 +4,24 @@
 #include <gtest/gtest.h>
 #include <QDir>
 #include "databasemanager.h"
+#include "parsernmea.h"
 
+// Тесты базы в памяти (":memory:"): каждый тест открывает свою базу
+// через openDatabase(), TearDown закрывает ее и снимает соединение
 class TestDataBaseManager : public ::testing::Test {
 protected:
-    DatabaseManager *dbManager;
+    void SetUp() override;
+    void TearDown() override;
 
+    bool openDatabase(const QString &dbName = ":memory:");
+    void closeDatabase();
+    // Первый столбец первой строки запроса; -1 — запрос не выполнен
+    int queryInt(const QString &sql);
+    // RMC с временем UTC hhmmss.ss от приемника sourceId
+    NavigationData rmc(const char *time, quint16 sourceId = 0);
+
+    DatabaseManager *dbManager = nullptr;
+    ParserNMEA parser;
 };
 
 #endif // TESTDATABASMANAGER_H
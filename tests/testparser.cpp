@@ -1,4 +1,293 @@
 #include "testparser.h"
+#include "captureformat.h"
+#include "epochassembler.h"
+#include "nmeaframer.h"
+
+#include <cmath>
+#include <cstdio>
+
+// Разбор строки прямо из байтового буфера, без QString
+TEST_F(ParserNMEATest, ParsesRawByteLine) {
+    const QByteArray line = "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*16";
+    NavigationData navData = parser.parseData(line.constData(), line.size());
+    EXPECT_EQ(navData.result, OK);
+    EXPECT_EQ(navData.type, GNRMC);
+
+    const GNRMCData *rmc = navData.as<GNRMCData>();
+    ASSERT_NE(rmc, nullptr);
+    EXPECT_TRUE(rmc->isValid);
+    EXPECT_NEAR(rmc->latitude, 56.415191, 1e-6);
+}
+
+// Поля указывают в исходный буфер, пустые поля сохраняются
+TEST(NmeaFieldsTest, TokenizesInPlace) {
+    const char line[] = "GNRMC,052714.00,A,,N";
+    NmeaFields fields;
+    ASSERT_TRUE(fields.tokenize(line, line + sizeof(line) - 1));
+    ASSERT_EQ(fields.size(), 5);
+    EXPECT_EQ(fields[1].data, line + 6);
+    EXPECT_TRUE(fields[3].isEmpty());
+    EXPECT_DOUBLE_EQ(fields[1].toDouble(), 52714.0);
+}
+
+// Декодеры фиксированного формата совпадают с разбором через toDouble()/toInt()
+TEST(NmeaFieldsTest, FixedFormatDecodersMatchGenericPath) {
+    char buf[32];
+    for (int deg = 0; deg < 180; deg += 13) {
+        for (int minutes = 0; minutes < 60; minutes += 7) {
+            for (int fraction = 0; fraction < 100000; fraction += 997) {
+                const int len = std::snprintf(buf, sizeof(buf), "%03d%02d.%05d", deg, minutes, fraction);
+                const NmeaField field{buf, len};
+
+                const double value = field.toDouble();
+                const double whole = static_cast<int>(value / 100);
+                const double expected = -(whole + (value - whole * 100) / 60.0);
+
+                double degrees = 0.0;
+                int32_t microdegrees = 0;
+                ASSERT_TRUE(field.toCoordinate('W', degrees));
+                ASSERT_TRUE(field.toCoordinateE6('W', microdegrees));
+                EXPECT_EQ(degrees, expected) << buf;
+                EXPECT_LE(std::abs(microdegrees - expected * 1e6), 0.5 + 1e-6) << buf;
+            }
+        }
+    }
+
+    for (int second = 0; second < 86400; second += 61) {
+        const int len = std::snprintf(buf, sizeof(buf), "%02d%02d%02d.%02d",
+                                      second / 3600, second / 60 % 60, second % 60, second % 100);
+        const NmeaField field{buf, len};
+        int32_t msecs = 0;
+        ASSERT_TRUE(field.toTimeMs(msecs));
+        EXPECT_EQ(msecs, second * 1000 + (second % 100) * 10) << buf;
+    }
+
+    int day = 0, month = 0, year = 0;
+    EXPECT_TRUE(NmeaField{"061224", 6}.toDate(day, month, year));
+    EXPECT_EQ(QDate(year, month, day), QDate(2024, 12, 6));
+    EXPECT_FALSE(NmeaField{"321224", 6}.toDate(day, month, year));
+
+    double degrees = 0.0;
+    EXPECT_FALSE(NmeaField{"5675.000", 8}.toCoordinate('N', degrees));
+    int32_t msecs = 0;
+    EXPECT_FALSE(NmeaField{"246000", 6}.toTimeMs(msecs));
+}
+
+// Разметка буфера: мусор пропускается, неполный хвост остается вызывающему
+TEST_F(ParserNMEATest, ScansFramesInOnePass) {
+    const QByteArray buffer = "garbage\r\n"
+                              "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*16\r\n"
+                              "xx$GNVTG,,T,,M,0.120,N,0.222,K,A*3D\r\n"
+                              "$GNGGA,052714.00,56";
+    std::vector<NmeaFrame> frames;
+    const int consumed = scanNmeaFrames(buffer.constData(), buffer.size(), frames);
+
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(consumed, buffer.indexOf("$GNGGA"));
+    EXPECT_EQ(frames[0].offset, 9);
+    EXPECT_EQ(frames[0].length, 68);
+    EXPECT_TRUE(frames[0].valid);
+    EXPECT_EQ(frames[1].offset, buffer.indexOf("$GNVTG"));
+    EXPECT_FALSE(frames[1].valid); // Сумма должна быть 3C
+
+    EXPECT_EQ(parser.parseFrame(buffer.constData(), frames[0]).result, OK);
+    EXPECT_EQ(parser.parseFrame(buffer.constData(), frames[1]).result, ERROR);
+    EXPECT_EQ(parser.lastError(), ParseError::BadChecksum);
+
+    // Разбор на любой длине совпадает с побайтовым XOR
+    for (int length = 0; length < buffer.size(); ++length) {
+        uint8_t expected = 0;
+        for (int i = 0; i < length; ++i) {
+            expected ^= static_cast<uint8_t>(buffer[i]);
+        }
+        EXPECT_EQ(nmeaChecksum(buffer.constData(), buffer.constData() + length), expected) << length;
+    }
+}
+
+// Предложения, разрезанные на любом байте, собираются целиком, мусор считается
+TEST(NmeaFramerTest, StitchesAcrossChunkBoundaries) {
+    const QByteArray stream = "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*16\r\n"
+                              "noise\r\n"
+                              "$GNVTG,,T,,M,0.120,N,0.222,K,A*3C\r\n";
+
+    for (int chunk = 1; chunk <= stream.size(); ++chunk) {
+        NmeaFramer framer;
+        QList<QByteArray> sentences;
+        auto collect = [&](const char *buffer, const NmeaFrame &frame) {
+            if (frame.valid) {
+                sentences.append(QByteArray(buffer + frame.offset, frame.length));
+            }
+        };
+        for (int pos = 0; pos < stream.size(); pos += chunk) {
+            framer.feed(stream.constData() + pos, qMin(chunk, stream.size() - pos), collect);
+        }
+
+        ASSERT_EQ(sentences.size(), 2) << chunk;
+        EXPECT_TRUE(sentences[0].startsWith("$GNRMC"));
+        EXPECT_TRUE(sentences[1].endsWith("*3C"));
+        EXPECT_EQ(framer.stats().bytesDiscarded, 5u) << chunk;
+        EXPECT_EQ(framer.pendingBytes(), 0);
+    }
+
+    // Строка без конца не растет дальше хвоста фиксированного размера
+    NmeaFramer framer;
+    const QByteArray junk = "$" + QByteArray(NmeaFramer::CarryCapacity * 2, 'x');
+    framer.feed(junk.constData(), junk.size(), [](const char *, const NmeaFrame &) {});
+    EXPECT_EQ(framer.pendingBytes(), 0);
+    EXPECT_EQ(framer.stats().overflows, 1u);
+    EXPECT_EQ(framer.stats().bytesDiscarded, static_cast<uint64_t>(junk.size()));
+}
+
+// Заголовки записи приема: метки, источник и граница датаграммы переживают
+// кодирование, обрезанный заголовок не принимается за испорченный
+TEST(CaptureFormatTest, EncodesChunkHeaders) {
+    char file[CaptureFileHeaderSize];
+    writeCaptureFileHeader(file, 1733462834000LL);
+    int64_t start = 0;
+    ASSERT_TRUE(readCaptureFileHeader(file, CaptureFileHeaderSize, &start));
+    EXPECT_EQ(start, 1733462834000LL);
+    EXPECT_FALSE(readCaptureFileHeader("$GNRMC,052714.00,A", 18));
+
+    const CaptureChunkHeader cases[] = {
+        {0, 0, false, 1},
+        {100000, 1, true, 70},
+        {600000000ULL, 0xFFFF, false, CaptureChunkMaxLength},
+    };
+    for (const CaptureChunkHeader &expected : cases) {
+        char encoded[CaptureChunkHeaderMaxSize];
+        const int size = encodeCaptureChunkHeader(encoded, expected);
+        ASSERT_LE(size, CaptureChunkHeaderMaxSize);
+
+        CaptureChunkHeader decoded;
+        ASSERT_EQ(decodeCaptureChunkHeader(encoded, size, decoded), size);
+        EXPECT_EQ(decoded.deltaUs, expected.deltaUs);
+        EXPECT_EQ(decoded.sourceId, expected.sourceId);
+        EXPECT_EQ(decoded.endOfMessage, expected.endOfMessage);
+        EXPECT_EQ(decoded.length, expected.length);
+
+        for (int partial = 0; partial < size; ++partial) {
+            EXPECT_EQ(decodeCaptureChunkHeader(encoded, partial, decoded), 0) << partial;
+        }
+    }
+
+    // Типичная порция NMEA: 100 мс, источник 1, датаграмма 70 байт
+    char encoded[CaptureChunkHeaderMaxSize];
+    EXPECT_EQ(encodeCaptureChunkHeader(encoded, cases[1]), 5);
+
+    CaptureChunkHeader tooLong = cases[2];
+    tooLong.length = CaptureChunkMaxLength + 1;
+    CaptureChunkHeader decoded;
+    EXPECT_EQ(decodeCaptureChunkHeader(encoded, encodeCaptureChunkHeader(encoded, tooLong), decoded), -1);
+}
+
+// Тип предложения не зависит от источника: GPS, Galileo и совмещенное решение
+TEST_F(ParserNMEATest, DecodesTalkerSeparately) {
+    const QByteArray rmc = "$GPRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*08";
+    NavigationData navData = parser.parseData(rmc);
+    EXPECT_EQ(navData.result, OK);
+    EXPECT_EQ(navData.type, GNRMC);
+    EXPECT_EQ(navData.talker, Talker::GP);
+
+    const QByteArray gsv = "$GAGSV,1,1,02,05,45,120,38,09,12,300,21*6C";
+    navData = parser.parseData(gsv);
+    EXPECT_EQ(navData.result, OK);
+    EXPECT_EQ(navData.type, GLGSV);
+    EXPECT_EQ(navData.talker, Talker::GA);
+
+    const QByteArray proprietary = "$PUBX,00,052714.00*34";
+    EXPECT_EQ(parser.parseData(proprietary).result, ERROR);
+}
+
+// Отказы без исключений: код причины, счетчики и текст только по запросу
+TEST_F(ParserNMEATest, CountsErrorsByReason) {
+    parser.resetCounters();
+
+    const QByteArray badChecksum = "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*17";
+    EXPECT_EQ(parser.parseData(badChecksum).result, ERROR);
+    EXPECT_EQ(parser.lastError(), ParseError::BadChecksum);
+
+    const QByteArray badFixQuality = "$GNGGA,052714.00,5624.91149,N,06153.42199,E,9,12,0.78,271.4,M,-10.8,M,,*60";
+    NavigationData navData = parser.parseData(badFixQuality);
+    EXPECT_EQ(navData.result, ERROR);
+    EXPECT_EQ(navData.as<GNGGAData>(), nullptr);
+    EXPECT_EQ(parser.lastError(), ParseError::OutOfRange);
+    EXPECT_TRUE(parser.lastErrorMessage().contains("FixQuality"));
+
+    EXPECT_EQ(parser.errorCount(ParseError::BadChecksum), 1u);
+    EXPECT_EQ(parser.errorCount(ParseError::OutOfRange), 1u);
+    EXPECT_EQ(parser.totalErrors(), 2u);
+    EXPECT_EQ(parser.parsedCount(), 0u);
+}
+
+// RMC, GGA и VTG одной секунды собираются в одну запись, новое время закрывает эпоху
+TEST_F(ParserNMEATest, AssemblesOneFixPerEpoch) {
+    const QByteArray lines[] = {
+        "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*16",
+        "$GNGGA,052714.00,5624.91149,N,06153.42199,E,1,12,0.78,271.4,M,-10.8,M,,*68",
+        "$GNVTG,,T,,M,0.120,N,0.222,K,A*3C",
+        "$GNRMC,052715.00,A,5624.91150,N,06153.42200,E,0.110,,061224,,,A,V*1F"
+    };
+
+    EpochAssembler epochs;
+    NavigationFix fix;
+    int completed = 0;
+    for (const QByteArray &line : lines) {
+        if (epochs.add(parser.parseData(line.constData(), line.size()), fix)) {
+            ++completed;
+        }
+    }
+
+    ASSERT_EQ(completed, 1);
+    EXPECT_EQ(fix.time, QTime(5, 27, 14));
+    EXPECT_EQ(fix.date, QDate(2024, 12, 6));
+    EXPECT_TRUE(fix.isValid);
+    EXPECT_NEAR(fix.altitude, 271.4, 1e-3);
+    EXPECT_EQ(fix.satellitesCount, 12);
+    EXPECT_EQ(fix.sources, NavigationFix::FromRMC | NavigationFix::FromGGA | NavigationFix::FromVTG);
+    EXPECT_TRUE(epochs.hasPending());
+}
+
+// Части GSV всех систем собираются в один обзор неба эпохи
+TEST_F(ParserNMEATest, AssemblesSkyViewPerEpoch) {
+    const QByteArray lines[] = {
+        "$GNRMC,052714.00,A,5624.91149,N,06153.42199,E,0.120,,061224,,,A,V*16",
+        "$GPGSV,2,1,05,02,45,120,38,05,12,300,21,07,60,045,44,09,05,010,*7F",
+        "$GPGSV,2,2,05,13,30,200,33*4F",
+        "$GLGSV,1,1,02,65,50,090,40,66,20,270,28*61",
+        "$GPGSV,2,2,05,13,30,200,33*4F", // Без первой части — отбрасывается
+        "$GNRMC,052715.00,A,5624.91150,N,06153.42200,E,0.110,,061224,,,A,V*1F"
+    };
+
+    EpochAssembler epochs;
+    NavigationFix fix;
+    int completed = 0;
+    for (const QByteArray &line : lines) {
+        if (epochs.add(parser.parseData(line.constData(), line.size()), fix)) {
+            ++completed;
+        }
+    }
+
+    ASSERT_EQ(completed, 1);
+    const SkyView &sky = epochs.completedSkyView();
+    ASSERT_EQ(sky.count, 7);
+    EXPECT_EQ(sky.satellites[0].prn, 2);
+    EXPECT_EQ(sky.satellites[0].talker, Talker::GP);
+    EXPECT_EQ(sky.satellites[3].snr, 0);
+    EXPECT_EQ(sky.satellites[5].prn, 65);
+    EXPECT_EQ(sky.satellites[5].talker, Talker::GL);
+    EXPECT_EQ(sky.satellites[6].azimuth, 270);
+    EXPECT_EQ(epochs.skyStats().sequences, 2u);
+    EXPECT_EQ(epochs.skyStats().dropped, 1u);
+
+    const QByteArray blob = sky.toBlob();
+    EXPECT_EQ(blob.size(), 7 * SkyView::RecordSize);
+    SkyView restored;
+    ASSERT_TRUE(restored.fromBlob(blob));
+    ASSERT_EQ(restored.count, 7);
+    EXPECT_EQ(restored.satellites[2].elevation, 60);
+    EXPECT_EQ(restored.satellites[2].snr, 44);
+    EXPECT_EQ(restored.satellites[6].talker, Talker::GL);
+}
 
 //// Тест для данных в двух строках
 //TEST_F(ParserNMEATest, DataInTwoLines) {
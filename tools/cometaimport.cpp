@@ -0,0 +1,161 @@
+// cometaimport.cpp
+// cometa-import: пакетный импорт логов NMEA в базу полетов без интерфейса.
+// Каждый файл становится отдельным полетом с именем файла. SQLite допускает
+// одного писателя, поэтому файлы записываются по очереди, а куски каждого
+// файла разбираются параллельно во всех потоках пула (LogImporter).
+// Запуск: cometa-import [-d база] [-j потоков] [--profile fast-ingest] [--log файл] лог...
+#include "databasemanager.h"
+#include "logimporter.h"
+#include "logger.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThreadPool>
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+namespace {
+struct Totals {
+    int files = 0;
+    int failed = 0;
+    qint64 bytes = 0;
+    qint64 lines = 0;
+    qint64 saved = 0;
+    qint64 errors = 0;
+};
+
+void printFile(const QString &flight, const LogImporter::Stats &stats, double seconds)
+{
+    std::printf("%s: %d lines, %d saved, %d errors, %.2f s, %.1f MB/s, %.0f lines/s\n",
+                qPrintable(flight), stats.lines, stats.saved, stats.errors, seconds,
+                stats.bytesTotal / (1024.0 * 1024.0) / seconds, stats.lines / seconds);
+    if (stats.hasPosition) {
+        std::printf("  lat %.6f .. %.6f  lon %.6f .. %.6f  alt %.1f .. %.1f m\n",
+                    stats.minLatitude, stats.maxLatitude,
+                    stats.minLongitude, stats.maxLongitude,
+                    stats.minAltitude, stats.maxAltitude);
+    } else {
+        std::printf("  no position fixes\n");
+    }
+    for (int i = 1; i < static_cast<int>(ParseError::Count); ++i) {
+        if (stats.errorsByReason[i] > 0) {
+            std::printf("  %s: %d\n", parseErrorName(static_cast<ParseError>(i)), stats.errorsByReason[i]);
+        }
+    }
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cometa-import");
+
+    QCommandLineParser options;
+    options.setApplicationDescription("Import NMEA logs into the Cometa flight database, one flight per file.");
+    options.addHelpOption();
+    options.addPositionalArgument("logs", "NMEA log files", "log...");
+    const QCommandLineOption databaseOption({"d", "database"}, "SQLite database file.", "path",
+                                            "database/mydatabase.db");
+    const QCommandLineOption jobsOption({"j", "jobs"}, "Parser threads (default: all cores).", "n");
+    const QCommandLineOption profileOption("profile", "Storage profile: safe, fast-ingest or read-optimized.",
+                                           "name", "fast-ingest");
+    const QCommandLineOption logOption("log", "Write the import log to a file.", "path");
+    options.addOptions({databaseOption, jobsOption, profileOption, logOption});
+    options.process(app);
+
+    const QStringList files = options.positionalArguments();
+    if (files.isEmpty()) {
+        options.showHelp(1);
+    }
+    if (options.isSet(jobsOption)) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, options.value(jobsOption).toInt()));
+    }
+
+    std::unique_ptr<Logger> logger;
+    if (options.isSet(logOption)) {
+        logger.reset(new Logger(options.value(logOption)));
+        logger->setMinLevel(Logger::Info);
+    }
+
+    Totals totals;
+    QElapsedTimer total;
+    total.start();
+    {
+        DatabaseManager db(options.value(databaseOption));
+        if (!QSqlDatabase::database(QLatin1String(QSqlDatabase::defaultConnection), false).isOpen()) {
+            std::fprintf(stderr, "cannot open %s\n", qPrintable(options.value(databaseOption)));
+            return 1;
+        }
+        if (logger) {
+            db.setLogger(logger.get());
+        }
+        db.setStorageProfile(storageProfileFromString(options.value(profileOption)));
+        db.setBatchMode(true, 5000, 1000);
+        db.startBackgroundWriter(65536, DatabaseWriter::Block, QString());
+
+        LogImporter importer(&db);
+        if (logger) {
+            importer.setLogger(logger.get());
+        }
+
+        int next = 0;
+        QString flight;
+        QElapsedTimer timer;
+        std::function<void()> startNext;
+
+        QObject::connect(&importer, &LogImporter::errorOccurred, [&](const QString &error) {
+            std::fprintf(stderr, "%s: %s\n", qPrintable(flight), qPrintable(error));
+        });
+        QObject::connect(&importer, &LogImporter::finished, &app, [&]() {
+            // Полет считается импортированным, когда его записи в базе
+            db.flushPendingData();
+            const LogImporter::Stats &stats = importer.stats();
+            printFile(flight, stats, qMax(timer.nsecsElapsed() / 1e9, 1e-9));
+            totals.bytes += stats.bytesTotal;
+            totals.lines += stats.lines;
+            totals.saved += stats.saved;
+            totals.errors += stats.errors;
+            ++totals.files;
+            startNext();
+        });
+
+        startNext = [&]() {
+            while (next < files.size()) {
+                const QString path = files[next++];
+                flight = QFileInfo(path).completeBaseName();
+                if (!db.insertNewFlight(flight)) {
+                    std::fprintf(stderr, "%s: cannot create flight (already imported?)\n", qPrintable(path));
+                    ++totals.failed;
+                    continue;
+                }
+                timer.start();
+                if (importer.start(path)) {
+                    return;
+                }
+                ++totals.failed;
+            }
+            app.quit();
+        };
+
+        QMetaObject::invokeMethod(&app, startNext, Qt::QueuedConnection);
+        app.exec();
+
+        db.stopBackgroundWriter();
+        db.flushPendingData();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+
+    const double seconds = qMax(total.nsecsElapsed() / 1e9, 1e-9);
+    std::printf("\n%d files imported, %d failed, threads %d: %lld lines, %lld saved, %lld errors "
+                "in %.2f s (%.1f MB/s, %.0f lines/s)\n",
+                totals.files, totals.failed, QThreadPool::globalInstance()->maxThreadCount(),
+                static_cast<long long>(totals.lines), static_cast<long long>(totals.saved),
+                static_cast<long long>(totals.errors), seconds,
+                totals.bytes / (1024.0 * 1024.0) / seconds, totals.lines / seconds);
+    return totals.failed > 0 ? 2 : 0;
+}
@@ -0,0 +1,231 @@
+// cometaingest.cpp
+// cometa-ingest: прием с нескольких приемников сразу без интерфейса — для
+// стендов, где пишутся 4–8 приемников. Все источники идут через один
+// IngestWorker: у каждого свой разметчик, парсер и (с --flight-per-source)
+// свой полет, записи пишет один фоновый писатель БД. Сырой поток всех
+// источников пишется в одну запись с метками времени (--capture-dir).
+// Источники:
+//   serial:ПОРТ            последовательный порт (115200 8N1)
+//   udp:АДРЕС:ПОРТ         приемник по Ethernet
+//   replay:ФАЙЛ[@СКОРОСТЬ] запись приема .bin; 1 — исходный темп, 0 — максимальный
+// Работает до Ctrl+C, до --duration или до конца всех записей, если
+// других источников нет.
+// Запуск: cometa-ingest [-d база] [--flight-per-source] [--capture-dir каталог]
+//                       [--duration с] [--stats с] [--log файл] источник...
+#include "databasemanager.h"
+#include "ingestworker.h"
+#include "logger.h"
+#include "rawcapturerecorder.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QTimer>
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+
+namespace {
+std::atomic<bool> g_stop{false};
+
+void requestStop(int)
+{
+    g_stop.store(true);
+}
+
+// 0 — источник не открыт, errorMessage — причина
+int openSource(IngestWorker &ingest, const QString &spec, QString *errorMessage)
+{
+    const int colon = spec.indexOf(':');
+    const QString kind = spec.left(colon);
+    const QString target = colon < 0 ? QString() : spec.mid(colon + 1);
+    if (target.isEmpty()) {
+        *errorMessage = "expected serial:PORT, udp:HOST:PORT or replay:FILE[@SPEED]";
+        return 0;
+    }
+
+    if (kind == "serial") {
+        return ingest.openSerial(target, errorMessage);
+    }
+    if (kind == "udp") {
+        const int portSeparator = target.lastIndexOf(':');
+        bool ok = false;
+        const quint16 port = target.mid(portSeparator + 1).toUShort(&ok);
+        if (portSeparator <= 0 || !ok) {
+            *errorMessage = "expected udp:HOST:PORT";
+            return 0;
+        }
+        return ingest.openUdp(target.left(portSeparator), port, errorMessage);
+    }
+    if (kind == "replay") {
+        const int at = target.lastIndexOf('@');
+        double speed = 1.0;
+        if (at > 0) {
+            bool ok = false;
+            speed = target.mid(at + 1).toDouble(&ok);
+            if (!ok || speed < 0.0) {
+                *errorMessage = "replay speed must be a number >= 0";
+                return 0;
+            }
+        }
+        return ingest.openReplay(at > 0 ? target.left(at) : target, speed, errorMessage);
+    }
+
+    *errorMessage = "unknown source kind " + kind;
+    return 0;
+}
+
+void printStats(const QVector<IngestWorker::SourceStats> &sources)
+{
+    for (const IngestWorker::SourceStats &stats : sources) {
+        std::printf("[%d] %-24s %10llu sentences %8llu invalid %10.0f B/s %8.0f sent/s "
+                    "lat avg %7.1f max %8.1f us %s\n",
+                    stats.id, qPrintable(stats.name),
+                    static_cast<unsigned long long>(stats.sentences),
+                    static_cast<unsigned long long>(stats.invalid),
+                    stats.bytesPerSecond, stats.sentencesPerSecond,
+                    stats.avgLatencyUs, stats.maxLatencyUs,
+                    qPrintable(stats.linkState));
+    }
+    std::fflush(stdout);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cometa-ingest");
+
+    QCommandLineParser options;
+    options.setApplicationDescription("Log several receivers at once into the Cometa flight database.");
+    options.addHelpOption();
+    options.addPositionalArgument("sources", "serial:PORT, udp:HOST:PORT or replay:FILE[@SPEED]", "source...");
+    const QCommandLineOption databaseOption({"d", "database"}, "SQLite database file.", "path",
+                                            "database/mydatabase.db");
+    const QCommandLineOption flightPerSourceOption("flight-per-source", "Give every source its own flight.");
+    const QCommandLineOption captureOption("capture-dir", "Record the raw stream with receive timestamps.", "dir");
+    const QCommandLineOption durationOption("duration", "Stop after this many seconds.", "s");
+    const QCommandLineOption statsOption("stats", "Print per-source statistics every s seconds.", "s", "5");
+    const QCommandLineOption logOption("log", "Write the ingest log to a file.", "path");
+    options.addOptions({databaseOption, flightPerSourceOption, captureOption, durationOption, statsOption,
+                        logOption});
+    options.process(app);
+
+    const QStringList sources = options.positionalArguments();
+    if (sources.isEmpty()) {
+        options.showHelp(1);
+    }
+
+    std::unique_ptr<Logger> logger;
+    if (options.isSet(logOption)) {
+        logger.reset(new Logger(options.value(logOption)));
+        logger->setMinLevel(Logger::Info);
+    }
+
+    int exitCode = 0;
+    {
+        DatabaseManager db(options.value(databaseOption));
+        if (!QSqlDatabase::database(QLatin1String(QSqlDatabase::defaultConnection), false).isOpen()) {
+            std::fprintf(stderr, "cannot open %s\n", qPrintable(options.value(databaseOption)));
+            return 1;
+        }
+        if (logger) {
+            db.setLogger(logger.get());
+        }
+        db.setBatchMode(true, 500, 250);
+        if (!db.insertNewFlight()) {
+            std::fprintf(stderr, "cannot create a flight\n");
+            return 1;
+        }
+        const QString flight = db.currentFlight();
+        db.startBackgroundWriter(8192, DatabaseWriter::Block, QString());
+
+        // Запись потока открывается до источников: первые байты попадают в нее
+        RawCaptureRecorder capture;
+        if (logger) {
+            capture.setLogger(logger.get());
+        }
+        if (options.isSet(captureOption)) {
+            const QString path = QDir(options.value(captureOption)).filePath(flight + ".bin");
+            if (!capture.open(path)) {
+                std::fprintf(stderr, "cannot open capture %s\n", qPrintable(path));
+                exitCode = 1;
+            }
+        }
+
+        IngestWorker ingest;
+        if (logger) {
+            ingest.setLogger(logger.get());
+        }
+        ingest.setStorage(&db, capture.isOpen() ? &capture : nullptr);
+        ingest.setFlightPerSource(options.isSet(flightPerSourceOption));
+
+        int replays = 0;
+        int replaysFinished = 0;
+        bool liveSources = false;
+        QObject::connect(&ingest, &IngestWorker::errorOccurred, &app, [](const QString &error) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+        });
+        QObject::connect(&ingest, &IngestWorker::sourceStateChanged, &app,
+                         [](const QString &source, const QString &state) {
+            std::printf("%s: %s\n", qPrintable(source), qPrintable(state));
+        });
+        QObject::connect(&ingest, &IngestWorker::replayFinished, &app, [&](int, const QString &source) {
+            std::printf("%s: replay finished\n", qPrintable(source));
+            if (++replaysFinished == replays && !liveSources) {
+                app.quit();
+            }
+        });
+
+        for (int i = 0; exitCode == 0 && i < sources.size(); ++i) {
+            QString error;
+            if (openSource(ingest, sources[i], &error) == 0) {
+                std::fprintf(stderr, "%s: %s\n", qPrintable(sources[i]), qPrintable(error));
+                exitCode = 1;
+            } else if (sources[i].startsWith("replay:")) {
+                ++replays;
+            } else {
+                liveSources = true;
+            }
+        }
+
+        if (exitCode == 0) {
+            std::printf("flight %s, %d sources\n", qPrintable(flight), sources.size());
+            std::signal(SIGINT, requestStop);
+            std::signal(SIGTERM, requestStop);
+
+            // Сигнал только ставит флаг — выход из цикла событий здесь
+            QTimer stopPoll;
+            QObject::connect(&stopPoll, &QTimer::timeout, &app, [&]() {
+                if (g_stop.load()) {
+                    app.quit();
+                }
+            });
+            stopPoll.start(200);
+
+            QTimer statsTimer;
+            QObject::connect(&statsTimer, &QTimer::timeout, &app, [&]() {
+                printStats(ingest.sourceStats());
+            });
+            statsTimer.start(qMax(1, options.value(statsOption).toInt()) * 1000);
+
+            if (options.isSet(durationOption)) {
+                QTimer::singleShot(qMax(1, options.value(durationOption).toInt()) * 1000, &app,
+                                   &QCoreApplication::quit);
+            }
+            app.exec();
+        }
+
+        // Порядок остановки: прием, затем запись потока и писатель БД
+        ingest.closeAll();
+        capture.close();
+        db.stopBackgroundWriter();
+        db.flushPendingData();
+        printStats(ingest.sourceStats());
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+    return exitCode;
+}
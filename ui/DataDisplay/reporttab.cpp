@@ -21,8 +21,8 @@ ReportTab::ReportTab(DatabaseManager *dbManager,Logger *logger, QWidget *parent)
     mapDensity(1), showMarkers(true), mapProvider("osm"),m_logger(logger)
 {
     m_logger->log(Logger::Info, "Инициализация ReportTab...");
-    qRegisterMetaType<NavigationData>("NavigationData");
-    qRegisterMetaType<QList<NavigationData>>("QList<NavigationData>");
+    qRegisterMetaType<NavigationFix>("NavigationFix");
+    qRegisterMetaType<QList<NavigationFix>>("QList<NavigationFix>");
     aiAnalyzer = new AIAnalyzer(this); // Добавить эту строку
     setupUI();
 
@@ -342,20 +342,19 @@ void ReportTab::onAddBlock() {
 }
 
 void ReportTab::generateAITextBlock(QTextCursor &cursor) {
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()) return;
 
     // Сериализация данных в JSON
     QJsonArray jsonData;
-    foreach(const auto &item, data) {
-        auto d = item.deserialize();
+    foreach(const auto &d, data) {
         jsonData.append(QJsonObject{
-            {"time", d.gnzda.time.toString("hh:mm:ss")},
-            {"latitude", d.gnrmc.latitude},
-            {"longitude", d.gnrmc.longitude},
-            {"speed", d.gnrmc.speed},
-            {"altitude", d.gngga.altitude},
-            {"isValid", d.gnrmc.isValid}
+            {"time", d.time.toString("hh:mm:ss")},
+            {"latitude", d.latitude},
+            {"longitude", d.longitude},
+            {"speed", d.speed},
+            {"altitude", d.altitude},
+            {"isValid", d.isValid}
         });
     }
 
@@ -364,7 +363,7 @@ void ReportTab::generateAITextBlock(QTextCursor &cursor) {
 
 void ReportTab::generateMapBlock(QTextCursor &cursor) {
     m_logger->log(Logger::Debug, "Начало генерации блока карты");
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()){
         m_logger->log(Logger::Warning, "Пустые данные для генерации карты");
         return;
@@ -381,16 +380,15 @@ void ReportTab::generateMapBlock(QTextCursor &cursor) {
         }
         // Подготавливаем данные для QML
         QVariantList coords;
-        for(const auto &item : data) {
-            auto d = item.deserialize();
-            if(d.gnrmc.isValid &&
-                !qFuzzyIsNull(d.gnrmc.latitude) &&
-                !qFuzzyIsNull(d.gnrmc.longitude)) {
+        for(const auto &d : data) {
+            if(d.isValid &&
+                !qFuzzyIsNull(d.latitude) &&
+                !qFuzzyIsNull(d.longitude)) {
                 coords.append(QVariantMap{
-                    {"latitude", d.gnrmc.latitude},
-                    {"longitude", d.gnrmc.longitude},
-                    {"speed", d.gnrmc.speed},
-                    {"course", d.gnrmc.course}
+                    {"latitude", d.latitude},
+                    {"longitude", d.longitude},
+                    {"speed", d.speed},
+                    {"course", d.course}
                 });
             }
         }
@@ -482,7 +480,7 @@ void ReportTab::onGenerateReport() {
 
 void ReportTab::generateReport() {
     QTextCursor cursor = reportTextEdit->textCursor();
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()){
         m_logger->log(Logger::Warning, "Пустые данные для генерации отчета");
         return;
@@ -695,7 +693,7 @@ QString ReportTab::formatDuration(int seconds) {
 }
 
 std::tuple<double, double, double, double, double, int, double, double, double, double>
-ReportTab::calculateFlightMetrics(const QList<NavigationData>& data) {
+ReportTab::calculateFlightMetrics(const QList<NavigationFix>& data) {
     double minAlt = std::numeric_limits<double>::max();
     double maxAlt = std::numeric_limits<double>::lowest();
     double minLat = std::numeric_limits<double>::max();
@@ -707,37 +705,36 @@ ReportTab::calculateFlightMetrics(const QList<NavigationData>& data) {
     double courseSum = 0;
     QDateTime startTime, endTime;
 
-    for(const auto& item : data) {
-        auto d = item.deserialize();
-        QDateTime dt(d.gnzda.date, d.gnzda.time);
+    for(const auto& d : data) {
+        QDateTime dt(d.date, d.time);
 
         if(dt.isValid()) {
             if(!startTime.isValid() || dt < startTime) startTime = dt;
             if(!endTime.isValid() || dt > endTime) endTime = dt;
         }
 
-        if(d.gngga.altitude > 0) {
-            minAlt = qMin(minAlt, static_cast<double>(d.gngga.altitude));
-            maxAlt = qMax(maxAlt, static_cast<double>(d.gngga.altitude));
+        if(d.altitude > 0) {
+            minAlt = qMin(minAlt, static_cast<double>(d.altitude));
+            maxAlt = qMax(maxAlt, static_cast<double>(d.altitude));
         }
 
-        if(d.gnrmc.speed > 0) {
-            speedSum += d.gnrmc.speed;
-            maxSpeed = qMax(maxSpeed, d.gnrmc.speed);
+        if(d.speed > 0) {
+            speedSum += d.speed;
+            maxSpeed = qMax(maxSpeed, d.speed);
         }
 
-        if(d.gnrmc.latitude != 0) {
-            minLat = qMin(minLat, d.gnrmc.latitude);
-            maxLat = qMax(maxLat, d.gnrmc.latitude);
+        if(d.latitude != 0) {
+            minLat = qMin(minLat, d.latitude);
+            maxLat = qMax(maxLat, d.latitude);
         }
 
-        if(d.gnrmc.longitude != 0) {
-            minLon = qMin(minLon, d.gnrmc.longitude);
-            maxLon = qMax(maxLon, d.gnrmc.longitude);
+        if(d.longitude != 0) {
+            minLon = qMin(minLon, d.longitude);
+            maxLon = qMax(maxLon, d.longitude);
         }
 
-        if(d.gnrmc.course >= 0) {
-            courseSum += d.gnrmc.course;
+        if(d.course >= 0) {
+            courseSum += d.course;
         }
     }
 
@@ -774,18 +771,18 @@ QString ReportTab::generateLegendHtml() const {
     return items.join("");
 }
 
-double ReportTab::calculateDistance(const QList<NavigationData>& data) {
+double ReportTab::calculateDistance(const QList<NavigationFix>& data) {
     if(data.size() < 2) return 0.0;
 
-    auto first = data.first().deserialize();
-    auto last = data.last().deserialize();
+    const NavigationFix &first = data.first();
+    const NavigationFix &last = data.last();
 
     // Простая формула расчета расстояния
     const double R = 6371.0; // Радиус Земли в км
-    double lat1 = qDegreesToRadians(first.gnrmc.latitude);
-    double lon1 = qDegreesToRadians(first.gnrmc.longitude);
-    double lat2 = qDegreesToRadians(last.gnrmc.latitude);
-    double lon2 = qDegreesToRadians(last.gnrmc.longitude);
+    double lat1 = qDegreesToRadians(first.latitude);
+    double lon1 = qDegreesToRadians(first.longitude);
+    double lat2 = qDegreesToRadians(last.latitude);
+    double lon2 = qDegreesToRadians(last.longitude);
 
     double dlat = lat2 - lat1;
     double dlon = lon2 - lon1;
@@ -848,7 +845,7 @@ QString ReportTab::getLogoBase64() {
 }
 
 void ReportTab::generateTableBlock(QTextCursor &cursor) {
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()){
         m_logger->log(Logger::Warning, "Пустые данные для генерации таблицы");
         return;
@@ -888,22 +885,21 @@ void ReportTab::generateTableBlock(QTextCursor &cursor) {
         html += "</tr>";
 
         // Данные
-        foreach(const auto &item, data) {
-            auto deserialized = item.deserialize();
-            QDateTime dt(deserialized.gnzda.date, deserialized.gnzda.time);
+        foreach(const auto &fix, data) {
+            QDateTime dt(fix.date, fix.time);
 
             html += "<tr>";
             foreach(const QString &col, selectedColumns) {
                 QString value;
-                if(col == "ID") value = QString::number(deserialized.id);
+                if(col == "ID") value = QString::number(fix.id);
                 else if(col == "Время (UTC)") value = dt.toString("HH:mm:ss");
                 else if(col == "Дата") value = dt.toString("dd.MM.yyyy");
-                else if(col == "Широта (°)") value = QString::number(deserialized.gnrmc.latitude, 'f', 6);
-                else if(col == "Долгота (°)") value = QString::number(deserialized.gnrmc.longitude, 'f', 6);
-                else if(col == "Высота (м)") value = QString::number(deserialized.gngga.altitude, 'f', 1);
-                else if(col == "Скорость (м/с)") value = QString::number(deserialized.gnrmc.speed, 'f', 1);
-                else if(col == "Курс (°)") value = QString::number(deserialized.gnrmc.course, 'f', 1);
-                else if(col == "Действителен") value = deserialized.gnrmc.isValid ? "Да" : "Нет";
+                else if(col == "Широта (°)") value = QString::number(fix.latitude, 'f', 6);
+                else if(col == "Долгота (°)") value = QString::number(fix.longitude, 'f', 6);
+                else if(col == "Высота (м)") value = QString::number(fix.altitude, 'f', 1);
+                else if(col == "Скорость (м/с)") value = QString::number(fix.speed, 'f', 1);
+                else if(col == "Курс (°)") value = QString::number(fix.course, 'f', 1);
+                else if(col == "Действителен") value = fix.isValid ? "Да" : "Нет";
 
                 html += QString("<td style='padding: 6px; border: 1px solid #ddd;'>%1</td>").arg(value);
             }
@@ -929,7 +925,7 @@ void ReportTab::generateTableBlock(QTextCursor &cursor) {
 }
 
 void ReportTab::generateChartBlock(QTextCursor &cursor) {
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()){
         m_logger->log(Logger::Warning, "Пустые данные для генерации графика");
         return;
@@ -942,17 +938,16 @@ void ReportTab::generateChartBlock(QTextCursor &cursor) {
     QVector<QDateTime> timestamps;
     QMap<QString, QVector<double>> values;
 
-    for (const NavigationData &navData : data) {
-        auto d = navData.deserialize();
-        QDateTime dt(d.gnzda.date, d.gnzda.time);
+    for (const NavigationFix &d : data) {
+        QDateTime dt(d.date, d.time);
         if (!dt.isValid()) continue;
 
         timestamps.append(dt);
-        values["Широта"].append(d.gnrmc.latitude);
-        values["Долгота"].append(d.gnrmc.longitude);
-        values["Высота"].append(d.gngga.altitude);
-        values["Скорость"].append(d.gnrmc.speed);
-        values["Курс"].append(d.gnrmc.course);
+        values["Широта"].append(d.latitude);
+        values["Долгота"].append(d.longitude);
+        values["Высота"].append(d.altitude);
+        values["Скорость"].append(d.speed);
+        values["Курс"].append(d.course);
     }
 
     if (timestamps.isEmpty()) {
@@ -1123,7 +1118,7 @@ void ReportTab::generateChartBlock(QTextCursor &cursor) {
 }
 
 void ReportTab::generatePieChart(QTextCursor &cursor) {
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()) return;
 
     QtCharts::QPieSeries *series = new QtCharts::QPieSeries();
@@ -1131,7 +1126,7 @@ void ReportTab::generatePieChart(QTextCursor &cursor) {
     // Пример для круговой диаграммы: распределение по статусам валидности
     int validCount = 0, invalidCount = 0;
     foreach(const auto &item, data) {
-        if(item.deserialize().gnrmc.isValid) validCount++;
+        if(item.isValid) validCount++;
         else invalidCount++;
     }
 
@@ -1207,7 +1202,7 @@ void ReportTab::selectChartColor() {
     }
 }
 
-QList<NavigationData> ReportTab::getFilteredData() {
+QList<NavigationFix> ReportTab::getFilteredData() {
     QString filterField = filterComboBox->currentText();
     QString filterValue = filterLineEdit->text();
     QString sortField = sortComboBox->currentText();
@@ -1222,7 +1217,7 @@ QList<NavigationData> ReportTab::getFilteredData() {
         );
 }
 
-void ReportTab::setup3DChart(QtDataVisualization::Q3DScatter *chart, const QList<NavigationData> &data) {    
+void ReportTab::setup3DChart(QtDataVisualization::Q3DScatter *chart, const QList<NavigationFix> &data) {    
     // Настройка фона и темы
     chart->activeTheme()->setType(QtDataVisualization::Q3DTheme::ThemeQt);
     chart->activeTheme()->setBackgroundEnabled(false);
@@ -1241,14 +1236,13 @@ void ReportTab::setup3DChart(QtDataVisualization::Q3DScatter *chart, const QList
     // Заполнение данных
     QtDataVisualization::QScatterDataArray *dataArray = new QtDataVisualization::QScatterDataArray();
     int counter = 0;
-    foreach (const NavigationData &item, data) {
+    foreach (const NavigationFix &fix, data) {
         if (counter++ % scatterDensity != 0) continue;
-        auto deserialized = item.deserialize();
-        if (deserialized.gnrmc.isValid) {
+        if (fix.isValid) {
             dataArray->append(QtDataVisualization::QScatterDataItem(
-                QVector3D(deserialized.gnrmc.longitude,
-                          deserialized.gngga.altitude,
-                          deserialized.gnrmc.latitude)));
+                QVector3D(fix.longitude,
+                          fix.altitude,
+                          fix.latitude)));
         }
     }
 
@@ -1269,7 +1263,7 @@ QPixmap ReportTab::render3DChartToPixmap(QtDataVisualization::Q3DScatter *chart)
 }
 
 void ReportTab::generate3DChartBlock(QTextCursor &cursor) {
-    QList<NavigationData> data = getFilteredData();
+    QList<NavigationFix> data = getFilteredData();
     if(data.isEmpty()){
         m_logger->log(Logger::Warning, "Пустые данные для генерации графика");
         return;
@@ -130,7 +130,7 @@ private:
     void setupUI();
     void generateReport();
     void generateReportHeader();
-    QList<NavigationData> getFilteredData();
+    QList<NavigationFix> getFilteredData();
     QString getLogoBase64();
     QPixmap renderMapToPixmap();
 
@@ -150,15 +150,15 @@ private:
     void generatePieChart(QTextCursor &cursor);
     QString formatDuration(int seconds);
     void selectChartColor();
-    void setupChart(QtCharts::QChart *chart, const QList<NavigationData> &data);
+    void setupChart(QtCharts::QChart *chart, const QList<NavigationFix> &data);
     QPixmap renderChartToPixmap(QtCharts::QChart *chart);
     void insertPixmapToDocument(const QPixmap &pixmap, QTextCursor &cursor);
-    void setup3DChart(QtDataVisualization::Q3DScatter *chart, const QList<NavigationData> &data);
+    void setup3DChart(QtDataVisualization::Q3DScatter *chart, const QList<NavigationFix> &data);
     QPixmap render3DChartToPixmap(QtDataVisualization::Q3DScatter *chart);
     // Новые методы для аналитики
     QString generateLegendHtml() const;
-    std::tuple<double, double, double, double, double, int, double, double, double, double> calculateFlightMetrics(const QList<NavigationData>& data);
-    double calculateDistance(const QList<NavigationData>& data);
+    std::tuple<double, double, double, double, double, int, double, double, double, double> calculateFlightMetrics(const QList<NavigationFix>& data);
+    double calculateDistance(const QList<NavigationFix>& data);
 };
 
 #endif // REPORTTAB_H
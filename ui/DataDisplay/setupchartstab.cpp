@@ -257,7 +257,7 @@ void setupChartsTab::applyFilter() {
     sortOrder = (sortOrder == "По возрастанию") ? "ASC" : "DESC";
 
     // Получаем отфильтрованные данные
-    QList<NavigationData> Data = dbManager->getNavigationDataFilter(filterField, filterValue, sortField, sortOrder, flightName);
+    QList<NavigationFix> Data = dbManager->getNavigationDataFilter(filterField, filterValue, sortField, sortOrder, flightName);
     m_logger->log(Logger::Info, QString("получено %1 записей").arg(Data.size()));
     // Обновляем график с новыми данными
     updateCharts(Data);
@@ -398,7 +398,7 @@ void setupChartsTab::setupCustomPlot(const QString &title, const QString &xTitle
         QPieSeries *series = new QPieSeries();
         int validCount = 0, invalidCount = 0;
 
-        for (const auto &data : gnrmc) {
+        for (const auto &data : fixes) {
             data.isValid ? validCount++ : invalidCount++;
         }
 
@@ -513,7 +513,7 @@ void setupChartsTab::setupAxes(QAbstractSeries *series, const QVector<double> &x
     }
 }
 
-void setupChartsTab::updateCharts(const QList<NavigationData> &navigationDataList) {
+void setupChartsTab::updateCharts(const QList<NavigationFix> &navigationDataList) {
     m_logger->log(Logger::Info, "Обновление графиков...");
 
     if (navigationDataList.isEmpty()) {
@@ -524,38 +524,23 @@ void setupChartsTab::updateCharts(const QList<NavigationData> &navigationDataLis
     m_logger->log(Logger::Info, QString("Получено данных для обновления графиков: %1").arg(navigationDataList.size()));
     try{
     QVector<double> latitudeData, longitudeData, altitudeData, timeData, speedData, courseData;
+    fixes.clear();
 
     for (int i = 0; i < navigationDataList.count(); i++) {
         if (i % density == 0) { // Используем плотность для выборки данных
-            NavigationData data = navigationDataList[i];
-
-            GNRMCData gnrm;
-            GNGGAData gngga;
-            GNZDAData gnzda;
-
-            QDataStream stream(&data.data, QIODevice::ReadOnly);
-            stream >> data.id
-                     >> data.timestamp
-                     >> gnzda.date
-                     >> gnzda.time
-                     >> gnrm.isValid
-                     >> gngga.altitude
-                     >> gnrm.latitude
-                     >> gnrm.longitude
-                     >> gnrm.speed
-                     >> gnrm.course;
+            const NavigationFix &fix = navigationDataList[i];
 
             // Проверяем валидность данных
-            if (gnrm.isValid && gngga.altitude > 0) {
-                QDateTime dateTime(gnzda.date, gnzda.time);
+            if (fix.isValid && fix.altitude > 0) {
+                QDateTime dateTime(fix.date, fix.time);
                 timeData.append(dateTime.toMSecsSinceEpoch());
-                latitudeData.append(gnrm.latitude);
-                longitudeData.append(gnrm.longitude);
-                altitudeData.append(gngga.altitude);
-                speedData.append(gnrm.speed);
-                courseData.append(gnrm.course);
+                latitudeData.append(fix.latitude);
+                longitudeData.append(fix.longitude);
+                altitudeData.append(fix.altitude);
+                speedData.append(fix.speed);
+                courseData.append(fix.course);
             }
-            gnrmc.append(gnrm);
+            fixes.append(fix);
         }
     }
 
@@ -16,7 +16,7 @@ class setupChartsTab : public QWidget {
 
 public:
     explicit setupChartsTab(DatabaseManager *db,Logger *logger,QWidget *parent = nullptr); // Конструктор с указателем на родительский класс
-    void updateCharts(const QList<NavigationData> &navigationDataList);
+    void updateCharts(const QList<NavigationFix> &navigationDataList);
     QCustomPlot *getChartPlot() const; // Метод для получения указателя на график
     void resetFilters();
 
@@ -64,7 +64,7 @@ private:
 
     int density;
 
-    QList<GNRMCData> gnrmc;
+    QList<NavigationFix> fixes;
 
     QChart *chart;
     QChartView *chartView;
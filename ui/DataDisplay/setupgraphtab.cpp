@@ -286,14 +286,14 @@ void setupGraphTab::applyFilter() {
     sortOrder = (sortOrder == "По возрастанию") ? "ASC" : "DESC"; // Преобразуем в ASC или DESC
 
     // Получаем отфильтрованные данные
-    QList<NavigationData> filteredData = dbManager->getNavigationDataFilterValid(filterField, filterValue, sortField, sortOrder, flightName);
+    QList<NavigationFix> filteredData = dbManager->getNavigationDataFilterValid(filterField, filterValue, sortField, sortOrder, flightName);
     m_logger->log(Logger::Info,
                   QString("Получено %1 записей для 3d графика").arg(filteredData.size()));
     // Обновляем график с новыми данными
     updateScatterGraph(filteredData);
 }
 
-void setupGraphTab::updateScatterGraph(QList<NavigationData> navigationDataList) {
+void setupGraphTab::updateScatterGraph(const QList<NavigationFix> &navigationDataList) {
     m_logger->log(Logger::Debug, "Обновление 3D графика...");
 
     auto *dataProxy = new QtDataVisualization::QScatterDataProxy();
@@ -311,49 +311,29 @@ void setupGraphTab::updateScatterGraph(QList<NavigationData> navigationDataList)
     int invalidPoints = 0;
     for (int i = 0; i < navigationDataList.count(); i++) {
         if (i % density == 0) { // Используем плотность для выборки данных
-            NavigationData data = navigationDataList[i];
-            GNRMCData gnrmc;
-            GNGGAData gngga;
-            GNZDAData gnzda;
-            QDataStream stream(data.data);
-
-            // Попробуем извлечь данные
-            try {
-                stream >> data.id
-                    >> data.timestamp
-                    >> gnzda.date
-                    >> gnzda.time
-                    >> gnrmc.isValid
-                    >> gngga.altitude
-                    >> gnrmc.latitude
-                    >> gnrmc.longitude
-                    >> gnrmc.speed
-                    >> gnrmc.course;
-                // Проверяем валидность данных
-                if (gnrmc.isValid) {
-                    // Проверяем валидность высоты
-                    if (gngga.altitude > 0) {
-                        maxLongitude = std::max(maxLongitude, static_cast<float>(gnrmc.longitude));
-                        minLongitude = std::min(minLongitude, static_cast<float>(gnrmc.longitude));
-                        minLatitude = std::min(minLatitude, static_cast<float>(gnrmc.latitude));
-                        maxLatitude = std::max(maxLatitude, static_cast<float>(gnrmc.latitude));
-                        minAltitude = std::min(minAltitude, static_cast<float>(gngga.altitude));
-                        maxAltitude = std::max(maxAltitude, static_cast<float>(gngga.altitude));
-
-                        // Добавляем точки в массив (долгота, широта, высота)
-                        dataArray->append(QtDataVisualization::QScatterDataItem(QVector3D(gnrmc.longitude,
-                                                                                          gngga.altitude,
-                                                                                          gnrmc.latitude
-                                                                                          )));
-                                            validPoints++;
-                    }else {
-                        invalidPoints++;
-                    }
-                }}catch (const std::exception &e) {
-                        m_logger->log(Logger::Warning,
-                                      QString("Ошибка обработки записи %1: %2").arg(i).arg(e.what()));
+            const NavigationFix &fix = navigationDataList[i];
+
+            // Проверяем валидность данных
+            if (fix.isValid) {
+                // Проверяем валидность высоты
+                if (fix.altitude > 0) {
+                    maxLongitude = std::max(maxLongitude, static_cast<float>(fix.longitude));
+                    minLongitude = std::min(minLongitude, static_cast<float>(fix.longitude));
+                    minLatitude = std::min(minLatitude, static_cast<float>(fix.latitude));
+                    maxLatitude = std::max(maxLatitude, static_cast<float>(fix.latitude));
+                    minAltitude = std::min(minAltitude, fix.altitude);
+                    maxAltitude = std::max(maxAltitude, fix.altitude);
+
+                    // Добавляем точки в массив (долгота, широта, высота)
+                    dataArray->append(QtDataVisualization::QScatterDataItem(QVector3D(fix.longitude,
+                                                                                      fix.altitude,
+                                                                                      fix.latitude
+                                                                                      )));
+                    validPoints++;
+                } else {
                     invalidPoints++;
                 }
+            }
         }
     }
 
@@ -23,7 +23,7 @@ public:
     setupGraphTab(DatabaseManager *db,Logger *logger,QWidget *parent = nullptr);
 
     void saveGraphsToFile();
-    void updateScatterGraph(QList<NavigationData> navigationDataList);
+    void updateScatterGraph(const QList<NavigationFix> &navigationDataList);
     void resetFilters();
 
 private slots:
@@ -145,20 +145,19 @@ void setupTableTab::applyFilter() {
     sortOrder = (sortOrder == "По возрастанию") ? "ASC" : "DESC"; // Преобразуем в ASC или DESC
 
     // Получаем отфильтрованные данные
-    QList<NavigationData> filteredData = dbManager->getNavigationDataFilter(filterField, filterValue, sortField, sortOrder, flightName);
+    QList<NavigationFix> filteredData = dbManager->getNavigationDataFilter(filterField, filterValue, sortField, sortOrder, flightName);
 
     // Обновляем таблицу с новыми данными
     updateDataTable(filteredData);
 }
 
-void setupTableTab::updateDataTable(const QList<NavigationData> &navigationDataList) {
+void setupTableTab::updateDataTable(const QList<NavigationFix> &navigationDataList) {
     m_logger->log(Logger::Debug,
                   QString("Обновление таблицы данными (%1 записей)").arg(navigationDataList.size()));
     try{
     dataTable->setRowCount(navigationDataList.size());
     for (int row = 0; row < navigationDataList.size(); ++row) {
-        NavigationData data = navigationDataList.at(row);
-        populateRow(row, data);
+        populateRow(row, navigationDataList.at(row));
     }}catch(const std::exception& e) {
             m_logger->log(Logger::Error,
                           QString("Ошибка при обновлении данных таблицы: %1").arg(e.what()));
@@ -227,25 +226,18 @@ void setupTableTab::populateRowCustom(int row, NavigationDataTable &data) {
     dataTable->setItem(row, column, new QTableWidgetItem(data.timestamp.toString("yyyy-MM-dd hh:mm:ss"))); // Timestamp
 }
 
-void setupTableTab::populateRow(int row, NavigationData &data) {
-    GNRMCData gnrmc;
-    GNZDAData gnzda;
-    GNGGAData gngga;
-    QDataStream stream(data.data);
-    stream >> data.id >> data.timestamp >> gnzda.date >> gnzda.time >> gnrmc.isValid >> gngga.altitude
-                      >> gnrmc.latitude >> gnrmc.longitude >> gnrmc.speed >> gnrmc.course;
-
+void setupTableTab::populateRow(int row, const NavigationFix &fix) {
     dataTable->setItem(row, 0, new QTableWidgetItem(QString::number(row + 1))); // Индекс строки
-    dataTable->setItem(row, 1, new QTableWidgetItem(QString::number(data.id))); // ID
-    dataTable->setItem(row, 10, new QTableWidgetItem(data.timestamp.toString("yyyy-MM-dd hh:mm:ss"))); // Время парсинга
-    dataTable->setItem(row, 4, new QTableWidgetItem(QString::number(gnrmc.latitude))); // Широта
-    dataTable->setItem(row, 5, new QTableWidgetItem(QString::number(gnrmc.longitude))); // Долгота
-    dataTable->setItem(row, 7, new QTableWidgetItem(QString::number(gnrmc.speed))); // Скорость
-    dataTable->setItem(row, 8, new QTableWidgetItem(QString::number(gnrmc.course))); // Курс
-    dataTable->setItem(row, 9, new QTableWidgetItem(gnrmc.isValid ? "Да" : "Нет")); // Валидность
-    dataTable->setItem(row, 2, new QTableWidgetItem(gnzda.time.toString("hh:mm:ss"))); // Время GNZDA
-    dataTable->setItem(row, 3, new QTableWidgetItem(gnzda.date.toString("yyyy-MM-dd"))); // Дата GNZDA
-    dataTable->setItem(row, 6, new QTableWidgetItem(QString::number(gngga.altitude))); // Высота
+    dataTable->setItem(row, 1, new QTableWidgetItem(QString::number(fix.id))); // ID
+    dataTable->setItem(row, 10, new QTableWidgetItem(fix.timestamp.toString("yyyy-MM-dd hh:mm:ss"))); // Время приема
+    dataTable->setItem(row, 4, new QTableWidgetItem(QString::number(fix.latitude))); // Широта
+    dataTable->setItem(row, 5, new QTableWidgetItem(QString::number(fix.longitude))); // Долгота
+    dataTable->setItem(row, 7, new QTableWidgetItem(QString::number(fix.speed))); // Скорость
+    dataTable->setItem(row, 8, new QTableWidgetItem(QString::number(fix.course))); // Курс
+    dataTable->setItem(row, 9, new QTableWidgetItem(fix.isValid ? "Да" : "Нет")); // Валидность
+    dataTable->setItem(row, 2, new QTableWidgetItem(fix.time.toString("hh:mm:ss"))); // Время UTC эпохи
+    dataTable->setItem(row, 3, new QTableWidgetItem(fix.date.toString("yyyy-MM-dd"))); // Дата UTC эпохи
+    dataTable->setItem(row, 6, new QTableWidgetItem(QString::number(fix.altitude))); // Высота
 }
 
 void setupTableTab::configureTable() {
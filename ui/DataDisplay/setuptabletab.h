@@ -25,7 +25,7 @@ class setupTableTab  : public QWidget
     Q_OBJECT
 public:
     setupTableTab(DatabaseManager *db,Logger *logger,QWidget *parent = nullptr);
-    void updateDataTable(const QList<NavigationData> &navigationDataList);
+    void updateDataTable(const QList<NavigationFix> &navigationDataList);
     void updateDataTableCustom(const QList<NavigationDataTable> &navigationDataList);
     void saveData(); // Метод для сохранения данных в файл
     void resetFilters();
@@ -47,7 +47,7 @@ private:
     void saveDataAsJSON(); // Метод для сохранения данных в JSON
     void saveDataAsXML(); // Метод для сохранения данных в XML
     void loadFlightData(const QString &flightName);
-    void populateRow(int row, NavigationData &data);
+    void populateRow(int row, const NavigationFix &fix);
     void populateRowCustom(int row, NavigationDataTable &data);
 
     void loadTableSelection();
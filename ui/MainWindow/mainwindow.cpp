@@ -5,6 +5,8 @@
 #include <QPushButton>
 #include <QGroupBox>
 #include <QFormLayout>
+#include <QSettings>
+#include <QCoreApplication>
 #include <datadisplaywindow.h>
 
 MainWindow::MainWindow(QString dbPath,QWidget *parent)
@@ -16,6 +18,7 @@ MainWindow::MainWindow(QString dbPath,QWidget *parent)
  {
 
     setupLogging();
+    applyStorageSettings();
     setupUI();
     styleLogDisplay();
 
@@ -25,6 +28,14 @@ MainWindow::MainWindow(QString dbPath,QWidget *parent)
             this, &MainWindow::appendFormattedData);
     connect(connectionManager, &ConnectionManager::connectionStatusChanged,
             this, &MainWindow::onConnectionStatusChanged);
+
+    // Окно не удаляется при выходе — дописываем очередь записи здесь
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        // Сначала поток приема: он пишет в очередь фонового писателя
+        connectionManager->disconnect();
+        dbManager->stopBackgroundWriter();
+        dbManager->flushPendingData();
+    });
     m_logger->log(Logger::Info, "Программа запущена");
 }
 
@@ -34,12 +45,61 @@ void MainWindow::appendFormattedData(const QString &data) {
 
 void MainWindow::setupLogging()
 {
+    // Уровень журнала: debug, info, warning, error или critical
+    QSettings settings("Cometa", "Cometa");
+    m_logger->setMinLevel(Logger::levelFromString(settings.value("logLevel", "info").toString()));
+
     connect(m_logger, &Logger::logMessage, this, &MainWindow::appendLogMessage);
 
     dataManager->setLogger(m_logger);
     dbManager->setLogger(m_logger);
     parser->setLogger(m_logger);
     connectionManager->setLogger(m_logger);
+    connectionManager->setDataManager(dataManager);
+}
+
+void MainWindow::applyStorageSettings()
+{
+    QSettings settings("Cometa", "Cometa");
+
+    // Профиль SQLite: safe, fast-ingest или read-optimized. По умолчанию safe —
+    // прежняя надежность записи; fast-ingest (WAL, synchronous=NORMAL) включается явно
+    dbManager->setStorageProfile(storageProfileFromString(
+        settings.value("storageProfile", "safe").toString()));
+
+    // Пакетная запись в БД: одна транзакция на N записей или T мс
+    bool batchWrites = settings.value("batchWrites", true).toBool();
+    int batchMaxRecords = settings.value("batchMaxRecords", 500).toInt();
+    int batchMaxLatencyMs = settings.value("batchMaxLatencyMs", 250).toInt();
+
+    dbManager->setBatchMode(batchWrites, batchMaxRecords, batchMaxLatencyMs);
+
+    // Кэш полетов для вкладок просмотра, МБ
+    int flightCacheMb = settings.value("flightCacheMB", 256).toInt();
+    dbManager->setFlightCacheLimit(static_cast<size_t>(qMax(1, flightCacheMb)) * 1024 * 1024);
+
+    // Фоновый поток записи: прием не ждет fsync
+    if (settings.value("backgroundWriter", true).toBool()) {
+        int queueCapacity = settings.value("writerQueueCapacity", 8192).toInt();
+        DatabaseWriter::OverflowPolicy policy = DatabaseWriter::policyFromString(
+            settings.value("writerOverflowPolicy", "block").toString());
+        QString spillPath = settings.value("writerSpillPath",
+                                           QDir::currentPath() + "/logs/spill.nmea").toString();
+
+        dbManager->startBackgroundWriter(queueCapacity, policy, spillPath);
+    }
+
+    // Каждый приемник пишет в свой полет (испытания с несколькими приемниками)
+    connectionManager->setFlightPerSource(settings.value("flightPerSource", false).toBool());
+
+    // Запись сырого потока: сброс на диск по объему или времени, fsync — none, flush или close,
+    // метки времени порций для воспроизведения в исходном темпе
+    dataManager->setCaptureOptions(settings.value("captureFlushKB", 256).toInt() * 1024,
+                                   settings.value("captureFlushIntervalMs", 500).toInt(),
+                                   settings.value("captureMaxBufferMB", 16).toInt() * 1024 * 1024,
+                                   RawCaptureRecorder::syncPolicyFromString(
+                                       settings.value("captureSync", "close").toString()),
+                                   settings.value("captureTimestamps", true).toBool());
 }
 
 void MainWindow::appendLogMessage(const QString &message)
@@ -79,32 +139,35 @@ void MainWindow::styleLogDisplay()
 }
 
 void MainWindow::onConnectButtonClicked() {
-    static bool isConnected = false;
-
     try {
-        if (!isConnected) {
+        if (!connectionManager->isConnected()) {
             QString connectionType = connectionTypeComboBox->currentText();
-            if (connectionType == "TTL") {
-                QString selectedPort = serialPortComboBox->currentText();
-                connectionManager->connectToTTL(selectedPort);
-            } else if (connectionType == "Ethernet") {
-                QString ipAddress = ipAddressLineEdit->text();
+            QString ipAddress;
+            quint16 port = 0;
+            if (connectionType == "Ethernet") {
+                ipAddress = ipAddressLineEdit->text();
                 QString portString = portLineEdit->text();
                 bool ok;
-                quint16 port = portString.toUShort(&ok);
+                port = portString.toUShort(&ok);
                 if (ipAddress.isEmpty() || !ok) {
                     throw std::runtime_error("Пожалуйста, введите корректный IP-адрес и порт.");
                 }
-                connectionManager->connectToEthernet(ipAddress, port);
-            } else {
+            } else if (connectionType != "TTL") {
                 throw std::runtime_error("Пожалуйста, выберите действительный тип соединения.");
             }
-            isConnected = true;
+
+            // Первые байты источника уже принадлежат новому полету
+            startSession();
+            const bool connected = connectionType == "TTL"
+                ? connectionManager->connectToTTL(serialPortComboBox->currentText())
+                : connectionManager->connectToEthernet(ipAddress, port);
+            if (!connected) {
+                abortSession();
+                return;
+            }
             connectButton->setText("Disconnect");
         } else {
             connectionManager->disconnect();
-            isConnected = false;
-            connectButton->setText("Connect");
         }
         m_logger->log(Logger::Info, "Connection established successfully");
     } catch (const std::exception &e) {
@@ -199,6 +262,10 @@ void MainWindow::openSettings() {
 }
 
 void MainWindow::onDatabasePathChanged(const QString &dbPath) {
+    // Поток приема пишет в текущую базу через ее фоновый писатель —
+    // останавливаем прием до закрытия
+    connectionManager->disconnect();
+
     // Закрываем текущую базу данных, если она открыта
     dbManager->close();
 
@@ -208,6 +275,8 @@ void MainWindow::onDatabasePathChanged(const QString &dbPath) {
 
     // Инициализируем базу данных
     dbManager->initializeDatabase();
+    applyStorageSettings();
+    connectionManager->setDatabaseManager(dbManager);
 }
 
 void MainWindow::updateInputFields() {
@@ -254,9 +323,29 @@ void MainWindow::onSelectFileButtonClicked() {
     }
 }
 
+void MainWindow::startSession() {
+    // Без нового полета записи идут в текущий, а поток в файл не пишется
+    m_sessionFlight.clear();
+    if (dbManager->insertNewFlight()) {
+        m_sessionFlight = dbManager->currentFlight();
+        dataManager->saveFile(m_sessionFlight);
+    }
+}
+
+void MainWindow::abortSession() {
+    // Источник не открылся — пустой полет не нужен
+    dataManager->closeFile();
+    if (!m_sessionFlight.isEmpty()) {
+        dbManager->deleteFlight(m_sessionFlight);
+    }
+    m_sessionFlight.clear();
+}
+
 void MainWindow::onConnectionStatusChanged(bool connected) {
-    if (connected){
-        dbManager->insertNewFlight();
-        dataManager->saveFile(dbManager->getLastFlight());
+    // Полет и запись потока открывает startSession до источника
+    if (!connected) {
+        dataManager->closeFile();
+        m_sessionFlight.clear();
+        connectButton->setText("Connect");
     }
 }
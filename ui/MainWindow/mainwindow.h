@@ -43,14 +43,19 @@ private slots:
 private:
     Logger *m_logger;
     void setupLogging();
+    void applyStorageSettings();
     void styleLogDisplay();
     void setupUI();
     void updateInputFields();
+    // Полет и запись потока сессии приема; открываются до источника
+    void startSession();
+    void abortSession();
 
     ConnectionManager *connectionManager;
     DatabaseManager *dbManager;
     DataManager *dataManager;
     ParserNMEA *parser;
+    QString m_sessionFlight;
 
     QComboBox *connectionTypeComboBox;
     QComboBox *serialPortComboBox;